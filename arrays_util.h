@@ -12,17 +12,418 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <math.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifndef ARRAYS_NO_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/**
+ * SIMD support. Kernels are compiled with per-function target attributes, so no -m flags
+ * are needed; define ARRAYS_NO_SIMD to build only the scalar functions.
+ */
+#if !defined(ARRAYS_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ARRAYS_X86_SIMD 1
+#include <immintrin.h>
+#define ARRAYS_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define ARRAYS_TARGET_AVX2 __attribute__((target("avx2")))
+#define ARRAYS_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+#if !defined(ARRAYS_NO_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#define ARRAYS_NEON_SIMD 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * Compiler portability. GCC and Clang use their __atomic builtins; other C11 compilers use
+ * <stdatomic.h>, for which the shared counters are declared ARRAYS_ATOMIC(type). Without
+ * either only an ARRAYS_NO_THREADS build is possible, and the operations become plain ones.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define ARRAYS_THREAD_LOCAL __thread
+#define ARRAYS_ATOMIC(type) type
+#define ARRAYS_RELAXED __ATOMIC_RELAXED
+#define ARRAYS_ACQUIRE __ATOMIC_ACQUIRE
+#define ARRAYS_RELEASE __ATOMIC_RELEASE
+#define ARRAYS_ACQ_REL __ATOMIC_ACQ_REL
+#define ARRAYS_SEQ_CST __ATOMIC_SEQ_CST
+#define ARRAYS_ATOMIC_LOAD(p, order) __atomic_load_n(p, order)
+#define ARRAYS_ATOMIC_STORE(p, v, order) __atomic_store_n(p, v, order)
+#define ARRAYS_ATOMIC_ADD(p, v, order) ((void)__atomic_add_fetch(p, v, order))
+#define ARRAYS_ATOMIC_SUB(p, v, order) ((void)__atomic_sub_fetch(p, v, order))
+#define ARRAYS_ATOMIC_SUB_FETCH(p, v, order) __atomic_sub_fetch(p, v, order)
+#define ARRAYS_ATOMIC_CAS(p, expected, desired, success, failure) __atomic_compare_exchange_n(p, expected, desired, true, success, failure)
+#elif !defined(__cplusplus) && defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define ARRAYS_THREAD_LOCAL _Thread_local
+#define ARRAYS_ATOMIC(type) _Atomic(type)
+#define ARRAYS_RELAXED memory_order_relaxed
+#define ARRAYS_ACQUIRE memory_order_acquire
+#define ARRAYS_RELEASE memory_order_release
+#define ARRAYS_ACQ_REL memory_order_acq_rel
+#define ARRAYS_SEQ_CST memory_order_seq_cst
+#define ARRAYS_ATOMIC_LOAD(p, order) atomic_load_explicit(p, order)
+#define ARRAYS_ATOMIC_STORE(p, v, order) atomic_store_explicit(p, v, order)
+#define ARRAYS_ATOMIC_ADD(p, v, order) ((void)atomic_fetch_add_explicit(p, v, order))
+#define ARRAYS_ATOMIC_SUB(p, v, order) ((void)atomic_fetch_sub_explicit(p, v, order))
+#define ARRAYS_ATOMIC_SUB_FETCH(p, v, order) (atomic_fetch_sub_explicit(p, v, order) - (v))
+#define ARRAYS_ATOMIC_CAS(p, expected, desired, success, failure) atomic_compare_exchange_weak_explicit(p, expected, desired, success, failure)
+#elif defined(ARRAYS_NO_THREADS)
+#define ARRAYS_THREAD_LOCAL
+#define ARRAYS_ATOMIC(type) type
+#define ARRAYS_RELAXED 0
+#define ARRAYS_ACQUIRE 0
+#define ARRAYS_RELEASE 0
+#define ARRAYS_ACQ_REL 0
+#define ARRAYS_SEQ_CST 0
+#define ARRAYS_ATOMIC_LOAD(p, order) (*(p))
+#define ARRAYS_ATOMIC_STORE(p, v, order) ((void)(*(p) = (v)))
+#define ARRAYS_ATOMIC_ADD(p, v, order) ((void)(*(p) += (v)))
+#define ARRAYS_ATOMIC_SUB(p, v, order) ((void)(*(p) -= (v)))
+#define ARRAYS_ATOMIC_SUB_FETCH(p, v, order) (*(p) -= (v))
+#define ARRAYS_ATOMIC_CAS(p, expected, desired, success, failure) (*(p) == *(expected) ? (*(p) = (desired), true) : (*(expected) = *(p), false))
+#else
+#error "arrays_util.h: the thread pool needs GCC/Clang atomics or C11 <stdatomic.h>; define ARRAYS_NO_THREADS to build without it"
+#endif
+
+/**
+ * Bit scans and prefetching: compiler builtins on GCC and Clang, portable loops elsewhere.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define ARRAYS_CTZ(x) __builtin_ctz(x)
+#define ARRAYS_FFS(x) __builtin_ffs(x)
+#define ARRAYS_CLZLL(x) __builtin_clzll(x)
+#define ARRAYS_PREFETCH(p) __builtin_prefetch(p)
+#else
+static inline int arraysCtz(unsigned int x) {
+    int n = 0;
+    while (!(x & 1u)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+}
+
+static inline int arraysFfs(int x) {
+    return x == 0 ? 0 : arraysCtz((unsigned int)x) + 1;
+}
+
+static inline int arraysClzll(unsigned long long x) {
+    int n = 0;
+    while (!(x & (1ull << 63))) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+}
+
+#define ARRAYS_CTZ(x) arraysCtz(x)
+#define ARRAYS_FFS(x) arraysFfs(x)
+#define ARRAYS_CLZLL(x) arraysClzll(x)
+#define ARRAYS_PREFETCH(p) ((void)(p))
+#endif
+
+typedef enum {
+    SUCCESS,
+    FAILURE,
+}status_code;
+
+/**
+ * @brief Instruction set levels the kernels are specialized for.
+ */
+typedef enum {
+    ISA_SCALAR,
+    ISA_SSE42,
+    ISA_AVX2,
+    ISA_AVX512,
+    ISA_NEON,
+}isa_level;
+
+/**
+ * @struct array_allocator
+ * @brief Memory hook used by every function that returns newly allocated memory.
+ *
+ * alloc receives the context and a size in bytes and returns memory aligned for any type, or
+ * NULL. release receives the context and a pointer returned by alloc (never NULL).
+ */
+typedef struct {
+    void* (*alloc)(void* context, size_t size);
+    void (*release)(void* context, void* ptr);
+    void* context;
+}array_allocator;
+
+/**
+ * @struct search_index
+ * @brief A static search index over a sorted int array, stored in Eytzinger (BFS) order.
+ *
+ * Keys are laid out like an implicit binary heap: the children of node k are 2k and 2k+1.
+ * The first levels of the tree share a handful of cache lines, and the 16 descendants
+ * four levels below any node are contiguous, so a lookup can prefetch the cache line it
+ * will need four steps later. Built by buildSearchIndex(), released by freeSearchIndex()
+ * through the allocator that was installed when it was built.
+ */
+typedef struct {
+    int* keys;
+    int* positions;
+    int n;
+    void* storage;
+    array_allocator allocator;
+}search_index;
+
+/**
+ * @struct array_arena
+ * @brief Bump-pointer arena: allocations are carved from large blocks and are all released
+ * together by arenaReset() or arenaDestroy(). Not thread-safe.
+ */
+typedef struct array_arena_block array_arena_block;
+
+typedef struct {
+    array_arena_block* head;
+    size_t blockSize;
+}array_arena;
+
+/**
+ * @struct array_pool
+ * @brief Size-class pool: power-of-two classes from 16 bytes to ARRAYS_POOL_MAX_CLASS bytes
+ * are served from per-class free lists refilled from slabs; larger requests go to malloc but
+ * are still tracked. Individual blocks can be released, and poolReset() releases everything
+ * at once. Not thread-safe.
+ */
+typedef struct {
+    void* freeLists[13];
+    void* slabs;
+    void** large;
+    size_t largeCount;
+    size_t largeCapacity;
+}array_pool;
+
+/**
+ * @struct array_hash_state
+ * @brief State of a streaming wide-lane hash (hashStateInit/hashStateUpdate/hashStateFinal).
+ */
+typedef struct {
+    uint64_t acc[8];
+    int buffer[16];
+    size_t buffered;
+    size_t stripes;
+    size_t length;
+}array_hash_state;
+
+/**
+ * @struct array_top_k
+ * @brief State of a streaming top-k selection (topKInit/topKUpdate/topKResult) over a caller buffer.
+ */
+typedef struct {
+    int* heap;
+    int capacity;
+    int size;
+    bool largest;
+}array_top_k;
+
+/**
+ * @struct array_view
+ * @brief A lazy view of an int array. Element i is data[stride * p], where p is i (or
+ * length - 1 - i when reversed) plus offset, modulo period. Making, slicing, reversing and
+ * rotating a view touch no elements (see arrayView()).
+ */
+typedef struct {
+    const int* data;
+    int length;
+    int stride;
+    int offset;
+    int period;
+    bool reversed;
+}array_view;
+
+/**
+ * Largest number of filter and map stages of an array_pipeline.
+ */
+#ifndef ARRAYS_PIPELINE_STAGES
+#define ARRAYS_PIPELINE_STAGES 8
+#endif
+
+/**
+ * @struct array_pipeline
+ * @brief Filter and map stages over a view, run in one blocked pass by pipelineReduce(),
+ * pipelineSum(), pipelineCount() or pipelineCollect(). Exactly one of filter and map is set
+ * in each stage.
+ */
+typedef struct {
+    array_view source;
+    struct {
+        bool (*filter)(int value, void* context);
+        int (*map)(int value, void* context);
+        void* context;
+    } stages[ARRAYS_PIPELINE_STAGES];
+    int count;
+}array_pipeline;
+
+/**
+ * @struct array_handle
+ * @brief An owned, growable array that caches its sorted flag, bounds and hashCode and keeps
+ * them up to date through handleAppend(), handleSet() and handleWrite() (see handleInit()).
+ * The elements can be read through data directly; call handleInvalidate() after writing them
+ * any other way. The storage is released through the allocator that allocated it.
+ */
+typedef struct {
+    int* data;
+    int size;
+    int capacity;
+    int minimum;
+    int maximum;
+    unsigned long long hashCode;
+    bool sorted;
+    bool sortedKnown;
+    bool boundsKnown;
+    bool hashKnown;
+    array_allocator allocator;
+}array_handle;
+
+/**
+ * Alignment, in bytes, of the heap storage of an array_vector.
+ */
+#ifndef ARRAYS_VECTOR_ALIGNMENT
+#define ARRAYS_VECTOR_ALIGNMENT 64
+#endif
+
+/**
+ * @struct array_vector
+ * @brief A growable contiguous int array with amortized O(1) append (see vectorInit()). data
+ * and size can be passed to any Arrays function. A vector made by smallVectorInit() starts in
+ * the inline buffer of its array_small_vector and only moves to the heap when it outgrows it;
+ * such a vector refers to its own buffer and must not be copied by value. The heap storage is
+ * released through the allocator that allocated it.
+ */
+typedef struct {
+    int* data;
+    int size;
+    int capacity;
+    void* storage;
+    int* inlineData;
+    int inlineCapacity;
+    array_allocator allocator;
+}array_vector;
+
+/**
+ * Inline capacity, in ints, of an array_small_vector.
+ */
+#ifndef ARRAYS_SMALL_VECTOR
+#define ARRAYS_SMALL_VECTOR 16
+#endif
+
+/**
+ * @struct array_small_vector
+ * @brief An array_vector with an inline buffer of ARRAYS_SMALL_VECTOR ints, so short arrays
+ * never allocate. Use the vector functions on &small.vector.
+ */
+typedef struct {
+    array_vector vector;
+    int buffer[ARRAYS_SMALL_VECTOR];
+}array_small_vector;
+
+/**
+ * @brief Element types recorded in the header of an array file.
+ */
+typedef enum {
+    ARRAY_ELEMENT_INT32 = 1,
+    ARRAY_ELEMENT_INT64,
+    ARRAY_ELEMENT_UINT32,
+    ARRAY_ELEMENT_FLOAT32,
+    ARRAY_ELEMENT_FLOAT64,
+}array_element_type;
+
+/**
+ * @brief Header flags of an array file.
+ */
+#define ARRAY_FILE_SORTED 1u
+
+/**
+ * @brief How mapArrayFile() maps a file: one access mode, optionally or-ed with one advice hint.
+ */
+typedef enum {
+    ARRAY_MAP_READ = 0,
+    ARRAY_MAP_PRIVATE = 1,
+    ARRAY_MAP_SHARED = 2,
+    ARRAY_ADVISE_SEQUENTIAL = 4,
+    ARRAY_ADVISE_RANDOM = 8,
+    ARRAY_ADVISE_WILLNEED = 16,
+}array_map_mode;
+
+/**
+ * @struct array_file
+ * @brief An array file mapped with mapArrayFile(): its elements and the metadata of its header.
+ */
+typedef struct {
+    int* data;
+    size_t count;
+    bool sorted;
+    unsigned long long hashCode;
+    uint64_t fastHash;
+    void* mapping;
+    size_t mappingSize;
+    int mode;
+    void* stream;
+    array_allocator allocator;
+}array_file;
+
+/**
+ * @struct array_file_writer
+ * @brief Writes an array file incrementally (arrayWriterOpen/arrayWriterAppend/arrayWriterClose).
+ */
+typedef struct {
+    FILE* stream;
+    size_t count;
+    bool sorted;
+    int last;
+    unsigned long long hashCode;
+    array_hash_state hash;
+}array_file_writer;
+
+/**
+ * Latency histogram buckets of array_call_stats: bucket b counts calls that took fewer than
+ * 2^b ticks, and the last bucket also counts everything slower.
+ */
+#ifndef ARRAYS_INSTRUMENT_BUCKETS
+#define ARRAYS_INSTRUMENT_BUCKETS 32
+#endif
+
+/**
+ * @struct array_call_stats
+ * @brief Call counters of one Arrays slot, summed over all threads (see useInstrumentedFunctions()).
+ */
+typedef struct {
+    const char* name;
+    uint64_t calls;
+    uint64_t elements;
+    uint64_t ticks;
+    uint64_t histogram[ARRAYS_INSTRUMENT_BUCKETS];
+}array_call_stats;
 
 /**
  * @brief Returns a copy of a specified range of an array.
  */
 int* copyOfRange(const int* arr, int start, int end);
 
+/**
+ * @brief Copies a specified range of an array into a caller-provided buffer.
+ */
+int copyOfRangeInto(const int* arr, int start, int end, int* dest, int capacity);
+
 /**
  * @brief Rotates an array to the right by a specified number of positions.
  */
 int* rotate(int* arr, int n, int k);
 
+/**
+ * @brief Rotates an array to the left by a specified number of positions.
+ */
+int* rotateLeft(int* arr, int n, int k);
+
 /**
  * @brief Searches for the first occurrence of a value in the array using linear search.
  */
@@ -33,18 +434,53 @@ int searchLIN(const int* arr, int n, int sr);
  */
 int search(const int* arr, int n, int sr);
 
+/**
+ * @brief Counts the occurrences of a value in the array without printing them.
+ */
+int countOccurrences(const int* arr, int n, int sr);
+
+/**
+ * @brief Stores the indices of all occurrences of a value in a caller-provided buffer.
+ */
+int searchAll(const int* arr, int n, int sr, int* indices, int capacity);
+
 /**
  * @brief Searches for the first occurrence of a value in the sorted array using binary search.
  */
 int searchBIN(const int* arr, int n, int sr);
 
+/**
+ * @brief Searches a sorted array for many keys at once, overlapping their memory latency.
+ */
+void searchBINBatch(const int* arr, int n, const int* keys, int m, int* out);
+
+/**
+ * @brief Builds a cache-friendly (Eytzinger order) search index from a sorted array.
+ */
+search_index* buildSearchIndex(const int* sorted, int n);
+
+/**
+ * @brief Releases a search index.
+ */
+void freeSearchIndex(search_index* index);
+
+/**
+ * @brief Returns the first position whose value is not less than the key, using a search index.
+ */
+int indexLowerBound(const search_index* index, int sr);
+
+/**
+ * @brief Returns the position of the first occurrence of a value, using a search index.
+ */
+int indexFind(const search_index* index, int sr);
+
 /**
  * @brief Reverses the elements of an array in-place.
  */
 int* reverse(int* arr, int n);
 
 /**
- * @brief Counts the occurrences of the maximum value in the array.
+ * @brief Counts the occurrences of the maximum value in the array (see modeOf for the most frequent value).
  */
 int MAX_count(const int* arr, int n);
 
@@ -58,25 +494,206 @@ int getminOf(const int* arr, int n);
  */
 int getmaxOf(const int* arr, int n);
 
+/**
+ * @brief Finds the minimum and the maximum value in the array in a single pass.
+ */
+void getMinMaxOf(const int* arr, int n, int* minimum, int* maximum);
+
 /**
  * @brief Converts an integer array to a string representation.
  */
 char* convertToString(const int* arr, int n);
 
+/**
+ * @brief Returns the exact length of the string representation of an array.
+ */
+size_t stringLength(const int* arr, int n);
+
+/**
+ * @brief Writes the string representation of an array into a caller-provided buffer.
+ */
+size_t toStringInto(const int* arr, int n, char* buffer, size_t capacity);
+
+/**
+ * @brief Writes the string representation of an array to a stream without allocating.
+ */
+status_code writeTo(const int* arr, int n, FILE* stream);
+
 /**
  * @brief Sorts an array using the dual-pivot QuickSort algorithm.
  */
 void dualPivotQuickSort(int* arr, int low, int high);
 
+/**
+ * @brief Sorts an array, merging the ascending and descending runs it already contains.
+ */
+void adaptiveSort(int* arr, int low, int high);
+
+/**
+ * @brief Sorts an array using an LSD radix sort with 8-bit digits.
+ */
+status_code radixSort(int* arr, int low, int high, int* scratch);
+
+/**
+ * @brief Places the k-th smallest element at arr[k] with smaller elements before it (introselect).
+ */
+int selectNth(int* arr, int n, int k);
+
+/**
+ * @brief Moves the k smallest elements, sorted, to the front of the array.
+ */
+void partialSort(int* arr, int n, int k);
+
+/**
+ * @brief Streaming top-k selection with a bounded heap: initialization, update and result.
+ */
+status_code topKInit(array_top_k* state, int* heap, int k, bool largest);
+void topKUpdate(array_top_k* state, const int* arr, size_t n);
+int topKResult(const array_top_k* state, int* dest);
+
+/**
+ * @brief Sorting by index: the sorting permutation, a stable sort with a payload column, and a gather.
+ */
+status_code argsort(const int* arr, int n, int* indices);
+status_code stableSort(int* arr, int n, int* payload);
+void applyPermutation(const int* src, const int* indices, int n, int* dest);
+
+/**
+ * @brief Frequency analysis: the most frequent value, the number of distinct values, and a bucketed histogram.
+ */
+int modeOf(const int* arr, int n, int* count);
+int countDistinct(const int* arr, int n);
+int histogram(const int* arr, int n, int low, int high, int buckets, int* counts);
+
+/**
+ * @brief Lazy views (slice, reverse, rotate without copying) and fused filter/map/reduce pipelines over them.
+ */
+array_view arrayView(const int* arr, int n);
+array_view stridedView(const int* arr, int n, int stride);
+status_code viewRange(const array_view* v, int start, int end, array_view* out);
+array_view viewReverse(const array_view* v);
+status_code viewRotate(const array_view* v, int k, array_view* out);
+int viewGet(const array_view* v, int i);
+long long viewSum(const array_view* v);
+int viewCopy(const array_view* v, int* dest);
+void pipelineInit(array_pipeline* p, const array_view* source);
+status_code pipelineFilter(array_pipeline* p, bool (*keep)(int value, void* context), void* context);
+status_code pipelineMap(array_pipeline* p, int (*map)(int value, void* context), void* context);
+long long pipelineReduce(const array_pipeline* p, long long initial, long long (*reduce)(long long acc, int value, void* context), void* context);
+long long pipelineSum(const array_pipeline* p);
+int pipelineCount(const array_pipeline* p);
+int pipelineCollect(const array_pipeline* p, int* dest, int capacity);
+
+/**
+ * @brief Managed handles: an owned array that caches its sorted flag, bounds and hashCode across writes.
+ */
+status_code handleInit(array_handle* h, const int* arr, int n);
+void handleFree(array_handle* h);
+status_code handleAppend(array_handle* h, int value);
+status_code handleSet(array_handle* h, int i, int value);
+status_code handleWrite(array_handle* h, int at, const int* src, int count);
+void handleInvalidate(array_handle* h);
+bool handleIsSorted(array_handle* h);
+int handleMin(array_handle* h);
+int handleMax(array_handle* h);
+unsigned long long handleHashCode(array_handle* h);
+void handleSort(array_handle* h);
+int handleSearch(array_handle* h, int value);
+
+/**
+ * @brief Dynamic arrays: a growable aligned vector, and a variant that starts in an inline buffer.
+ */
+void vectorInit(array_vector* v);
+void smallVectorInit(array_small_vector* small);
+status_code vectorReserve(array_vector* v, int capacity);
+status_code vectorShrink(array_vector* v);
+status_code vectorAppend(array_vector* v, int value);
+status_code vectorAppendN(array_vector* v, const int* src, int n);
+status_code vectorResize(array_vector* v, int n);
+void vectorClear(array_vector* v);
+void vectorFree(array_vector* v);
+array_view vectorView(const array_vector* v);
+
+/**
+ * @brief Sorts an array on several threads using a shared work-stealing pool.
+ */
+void parallelSort(int* arr, int low, int high, int threads);
+
+/**
+ * @brief Stops the threads of the shared pool used by the parallel functions.
+ */
+void shutdownThreads();
+
+/**
+ * @brief Sets the smallest range the parallel functions hand to one thread.
+ */
+void setParallelGrain(size_t grain);
+
+/**
+ * @brief Parallel reductions and transforms over the shared pool.
+ */
+long long parallelSum(const int* arr, size_t n, int threads);
+long long parallelPrefixSum(const int* arr, size_t n, long long* dest, int threads);
+void parallelMinMax(const int* arr, size_t n, int* minimum, int* maximum, int threads);
+size_t parallelCount(const int* arr, size_t n, int sr, int threads);
+size_t parallelHistogram(const int* arr, size_t n, int low, int high, int buckets, size_t* counts, int threads);
+uint64_t parallelHash(const int* arr, size_t n, uint64_t seed, int threads);
+int* parallelReverse(int* arr, size_t n, int threads);
+int* parallelCopy(int* dest, const int* src, size_t n, int threads);
+
+/**
+ * @brief Array files: zero-copy mapping, whole-array and incremental writing.
+ */
+status_code mapArrayFile(const char* path, array_file* file, int mode);
+status_code syncArrayFile(array_file* file);
+void unmapArrayFile(array_file* file);
+status_code writeArrayFile(const char* path, const int* arr, size_t n);
+status_code arrayWriterOpen(array_file_writer* writer, const char* path);
+status_code arrayWriterAppend(array_file_writer* writer, const int* arr, size_t n);
+status_code arrayWriterClose(array_file_writer* writer);
+
+/**
+ * @brief Sorts an array file larger than memory into a new array file.
+ */
+status_code externalSort(const char* input, const char* output, size_t memory);
+
 /**
  * @brief Compare one array with another array digit by digit.
 */
 bool compareTwoArray(int* arr1, int size1, int* arr2, int size2);
 
+/**
+ * @brief Return the first index at which two arrays differ.
+*/
+int firstMismatch(const int* arr1, int size1, const int* arr2, int size2);
+
+/**
+ * @brief Compare two arrays lexicographically (three-way).
+*/
+int compareArrays(const int* arr1, int size1, const int* arr2, int size2);
+
+/**
+ * @brief Linear-time operations on two sorted arrays, written into a caller-provided buffer.
+ */
+int mergeSorted(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity);
+int unionSorted(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity);
+int intersectSorted(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity);
+int differenceSorted(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity);
+
 /**
  * @brief Calculate the sum of all the elements of an array.
 */
-int sumAllElements(int* arr, int n);
+long long sumAllElements(int* arr, int n);
+
+/**
+ * @brief Scans and windows: inclusive, exclusive and segmented prefix sums, and sliding-window sum, minimum and maximum.
+ */
+long long prefixSum(const int* arr, int n, long long* dest);
+long long exclusivePrefixSum(const int* arr, int n, long long* dest);
+void segmentedPrefixSum(const int* arr, const bool* heads, int n, long long* dest);
+int windowSum(const int* arr, int n, int w, long long* dest);
+int windowMin(const int* arr, int n, int w, int* dest);
+int windowMax(const int* arr, int n, int w, int* dest);
 
 /**
  * @brief Check whether the array is Sorted in increasing order or not.
@@ -88,6 +705,16 @@ bool checkForSort(int* arr, int n);
 */
 int* concatenateTwoArrays(int* arr1, int size1, int* arr2, int size2);
 
+/**
+ * @brief Concatenate two arrays into a caller-provided buffer.
+*/
+int concatInto(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity);
+
+/**
+ * @brief Concatenate any number of arrays into a caller-provided buffer.
+*/
+int concatN(const int* const* arrays, const int* sizes, int count, int* dest, int capacity);
+
 /**
  * @brief Return the index of first Occurrence of the element.
 */
@@ -98,10 +725,39 @@ int firstIndexOf(int* arr, int n, int element);
 */
 unsigned long long getHashCodeOf(int* arr, int n);
 
-typedef enum {
-    SUCCESS,
-    FAILURE,
-}status_code;
+/**
+ * @brief Wide-lane hash: streaming initialization, update and finalization, and a one-shot form.
+ */
+void hashStateInit(array_hash_state* state, uint64_t seed);
+void hashStateUpdate(array_hash_state* state, const int* arr, size_t n);
+uint64_t hashStateFinal(const array_hash_state* state);
+uint64_t fastHashOf(const int* arr, size_t n, uint64_t seed);
+
+/**
+ * @brief Counterparts of the functions above for arrays of any size: size_t sizes, ptrdiff_t indices.
+ */
+int* copyOfRange64(const int* arr, ptrdiff_t start, ptrdiff_t end);
+size_t copyOfRangeInto64(const int* arr, ptrdiff_t start, ptrdiff_t end, int* dest, size_t capacity);
+int* rotate64(int* arr, size_t n, ptrdiff_t k);
+int* rotateLeft64(int* arr, size_t n, ptrdiff_t k);
+ptrdiff_t searchLIN64(const int* arr, size_t n, int sr);
+size_t countOccurrences64(const int* arr, size_t n, int sr);
+size_t searchAll64(const int* arr, size_t n, int sr, ptrdiff_t* indices, size_t capacity);
+ptrdiff_t searchBIN64(const int* arr, size_t n, int sr);
+int* reverse64(int* arr, size_t n);
+int getmaxOf64(const int* arr, size_t n);
+int getminOf64(const int* arr, size_t n);
+void getMinMaxOf64(const int* arr, size_t n, int* minimum, int* maximum);
+size_t MAX_count64(const int* arr, size_t n);
+void sort64(int* arr, ptrdiff_t low, ptrdiff_t high);
+status_code radixSort64(int* arr, ptrdiff_t low, ptrdiff_t high, int* scratch);
+bool compareTwoArray64(const int* arr1, size_t size1, const int* arr2, size_t size2);
+ptrdiff_t firstMismatch64(const int* arr1, size_t size1, const int* arr2, size_t size2);
+int compareArrays64(const int* arr1, size_t size1, const int* arr2, size_t size2);
+int64_t sumAllElements64(const int* arr, size_t n);
+bool checkForSort64(const int* arr, size_t n);
+int* concatenateTwoArrays64(const int* arr1, size_t size1, const int* arr2, size_t size2);
+unsigned long long getHashCodeOf64(const int* arr, size_t n);
 
 /**
  * @struct Array_Functions
@@ -109,56 +765,550 @@ typedef enum {
  */
 typedef struct {
     int* (*copyOfRange)(const int*, int, int);
+    int (*copyOfRangeInto)(const int*, int, int, int*, int);
+    void (*setAllocator)(const array_allocator* allocator);
+    void (*release)(void* ptr);
     int* (*rotate)(int*, int, int);
+    int* (*rotateLeft)(int*, int, int);
     int (*searchLIN)(const int*, int, int);
     int (*search)(const int*, int, int);
+    int (*count)(const int*, int, int);
+    int (*searchAll)(const int*, int, int, int*, int);
     int (*searchBIN)(const int*, int, int);
+    void (*searchBINBatch)(const int* arr, int n, const int* keys, int m, int* out);
+    search_index* (*buildIndex)(const int* sorted, int n);
+    void (*freeIndex)(search_index* index);
+    int (*lowerBound)(const search_index* index, int sr);
+    int (*find)(const search_index* index, int sr);
     int* (*reverse)(int*, int);
     int (*maxValue)(const int*, int);
     int (*minValue)(const int*, int);
+    void (*minMax)(const int*, int, int*, int*);
     int (*getMaxOccurrence)(const int*, int);
+    int (*mode)(const int* arr, int n, int* count);
+    int (*countDistinct)(const int* arr, int n);
+    int (*histogram)(const int* arr, int n, int low, int high, int buckets, int* counts);
+    array_view (*view)(const int* arr, int n);
+    array_view (*stridedView)(const int* arr, int n, int stride);
+    status_code (*viewRange)(const array_view* v, int start, int end, array_view* out);
+    array_view (*viewReverse)(const array_view* v);
+    status_code (*viewRotate)(const array_view* v, int k, array_view* out);
+    int (*viewGet)(const array_view* v, int i);
+    long long (*viewSum)(const array_view* v);
+    int (*viewCopy)(const array_view* v, int* dest);
+    void (*pipelineInit)(array_pipeline* p, const array_view* source);
+    status_code (*pipelineFilter)(array_pipeline* p, bool (*keep)(int value, void* context), void* context);
+    status_code (*pipelineMap)(array_pipeline* p, int (*map)(int value, void* context), void* context);
+    long long (*pipelineReduce)(const array_pipeline* p, long long initial, long long (*reduce)(long long acc, int value, void* context), void* context);
+    long long (*pipelineSum)(const array_pipeline* p);
+    int (*pipelineCount)(const array_pipeline* p);
+    int (*pipelineCollect)(const array_pipeline* p, int* dest, int capacity);
+    status_code (*handleInit)(array_handle* h, const int* arr, int n);
+    void (*handleFree)(array_handle* h);
+    status_code (*handleAppend)(array_handle* h, int value);
+    status_code (*handleSet)(array_handle* h, int i, int value);
+    status_code (*handleWrite)(array_handle* h, int at, const int* src, int count);
+    void (*handleInvalidate)(array_handle* h);
+    bool (*handleIsSorted)(array_handle* h);
+    int (*handleMin)(array_handle* h);
+    int (*handleMax)(array_handle* h);
+    unsigned long long (*handleHashCode)(array_handle* h);
+    void (*handleSort)(array_handle* h);
+    int (*handleSearch)(array_handle* h, int value);
+    void (*vectorInit)(array_vector* v);
+    void (*smallVectorInit)(array_small_vector* small);
+    status_code (*vectorReserve)(array_vector* v, int capacity);
+    status_code (*vectorShrink)(array_vector* v);
+    status_code (*vectorAppend)(array_vector* v, int value);
+    status_code (*vectorAppendN)(array_vector* v, const int* src, int n);
+    status_code (*vectorResize)(array_vector* v, int n);
+    void (*vectorClear)(array_vector* v);
+    void (*vectorFree)(array_vector* v);
+    array_view (*vectorView)(const array_vector* v);
     char* (*toString)(const int*, int);
+    size_t (*stringLength)(const int*, int);
+    size_t (*toStringInto)(const int*, int, char*, size_t);
+    status_code (*writeTo)(const int*, int, FILE*);
     void (*sort)(int*, int, int);
+    status_code (*radixSort)(int* arr, int low, int high, int* scratch);
+    int (*select)(int* arr, int n, int k);
+    void (*partialSort)(int* arr, int n, int k);
+    status_code (*topKInit)(array_top_k* state, int* heap, int k, bool largest);
+    void (*topKUpdate)(array_top_k* state, const int* arr, size_t n);
+    int (*topKResult)(const array_top_k* state, int* dest);
+    status_code (*argsort)(const int* arr, int n, int* indices);
+    status_code (*stableSort)(int* arr, int n, int* payload);
+    void (*applyPermutation)(const int* src, const int* indices, int n, int* dest);
+    void (*parallelSort)(int* arr, int low, int high, int threads);
+    void (*shutdownThreads)();
+    void (*setParallelGrain)(size_t grain);
+    long long (*parallelSum)(const int* arr, size_t n, int threads);
+    long long (*parallelPrefixSum)(const int* arr, size_t n, long long* dest, int threads);
+    void (*parallelMinMax)(const int* arr, size_t n, int* minimum, int* maximum, int threads);
+    size_t (*parallelCount)(const int* arr, size_t n, int sr, int threads);
+    size_t (*parallelHistogram)(const int* arr, size_t n, int low, int high, int buckets, size_t* counts, int threads);
+    uint64_t (*parallelHash)(const int* arr, size_t n, uint64_t seed, int threads);
+    int* (*parallelReverse)(int* arr, size_t n, int threads);
+    int* (*parallelCopy)(int* dest, const int* src, size_t n, int threads);
+    status_code (*mapFile)(const char* path, array_file* file, int mode);
+    status_code (*syncFile)(array_file* file);
+    void (*unmapFile)(array_file* file);
+    status_code (*writeFile)(const char* path, const int* arr, size_t n);
+    status_code (*externalSort)(const char* input, const char* output, size_t memory);
     bool (*compare)(int* arr1, int size1, int* arr2, int size2);
-    int (*sum) (int* arr, int n);
+    int (*mismatch)(const int* arr1, int size1, const int* arr2, int size2);
+    int (*compareOrder)(const int* arr1, int size1, const int* arr2, int size2);
+    int (*mergeSorted)(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity);
+    int (*unionSorted)(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity);
+    int (*intersectSorted)(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity);
+    int (*differenceSorted)(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity);
+    long long (*sum) (int* arr, int n);
+    long long (*prefixSum)(const int* arr, int n, long long* dest);
+    long long (*exclusivePrefixSum)(const int* arr, int n, long long* dest);
+    void (*segmentedPrefixSum)(const int* arr, const bool* heads, int n, long long* dest);
+    int (*windowSum)(const int* arr, int n, int w, long long* dest);
+    int (*windowMin)(const int* arr, int n, int w, int* dest);
+    int (*windowMax)(const int* arr, int n, int w, int* dest);
     bool (*isSorted)(int* arr, int n);
     int* (*concat)(int* arr1, int size1, int* arr2, int size2);
+    int (*concatInto)(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity);
+    int (*concatN)(const int* const* arrays, const int* sizes, int count, int* dest, int capacity);
     int (*indexOf)(int* arr, int n, int element);
     unsigned long long (*hashCode)(int* arr, int n);
+    void (*hashInit)(array_hash_state* state, uint64_t seed);
+    void (*hashUpdate)(array_hash_state* state, const int* arr, size_t n);
+    uint64_t (*hashFinal)(const array_hash_state* state);
+    uint64_t (*fastHash)(const int* arr, size_t n, uint64_t seed);
+    isa_level (*detectISA)();
+    isa_level (*activeISA)();
 }Array_Functions;
 
 Array_Functions Arrays;
 
+/**
+ * @struct Array_Functions_64
+ * @brief The operations of Array_Functions for arrays of any size, with size_t sizes and
+ * ptrdiff_t indices (-1 when not found).
+ */
+typedef struct {
+    int* (*copyOfRange)(const int*, ptrdiff_t, ptrdiff_t);
+    size_t (*copyOfRangeInto)(const int*, ptrdiff_t, ptrdiff_t, int*, size_t);
+    int* (*rotate)(int*, size_t, ptrdiff_t);
+    int* (*rotateLeft)(int*, size_t, ptrdiff_t);
+    ptrdiff_t (*searchLIN)(const int*, size_t, int);
+    size_t (*count)(const int*, size_t, int);
+    size_t (*searchAll)(const int*, size_t, int, ptrdiff_t*, size_t);
+    ptrdiff_t (*searchBIN)(const int*, size_t, int);
+    int* (*reverse)(int*, size_t);
+    int (*maxValue)(const int*, size_t);
+    int (*minValue)(const int*, size_t);
+    void (*minMax)(const int*, size_t, int*, int*);
+    size_t (*getMaxOccurrence)(const int*, size_t);
+    void (*sort)(int*, ptrdiff_t, ptrdiff_t);
+    status_code (*radixSort)(int* arr, ptrdiff_t low, ptrdiff_t high, int* scratch);
+    bool (*compare)(const int* arr1, size_t size1, const int* arr2, size_t size2);
+    ptrdiff_t (*mismatch)(const int* arr1, size_t size1, const int* arr2, size_t size2);
+    int (*compareOrder)(const int* arr1, size_t size1, const int* arr2, size_t size2);
+    int64_t (*sum)(const int* arr, size_t n);
+    bool (*isSorted)(const int* arr, size_t n);
+    int* (*concat)(const int* arr1, size_t size1, const int* arr2, size_t size2);
+    ptrdiff_t (*indexOf)(const int* arr, size_t n, int element);
+    unsigned long long (*hashCode)(const int* arr, size_t n);
+}Array_Functions_64;
+
+Array_Functions_64 Arrays64;
+
 status_code useArrayFunctions();
 
+/**
+ * @brief Initializes the Arrays structure with the kernels of one instruction set level.
+ */
+status_code useArrayFunctionsFor(isa_level level);
 
+/**
+ * @brief Returns the best instruction set level supported by the running CPU.
+ */
+isa_level detectISA();
 
 /**
- * @brief Initializes the Array_Functions structure with appropriate function pointers.
+ * @brief Returns the instruction set level currently installed in Arrays.
  */
-status_code useArrayFunctions() {
-    Arrays.copyOfRange = copyOfRange;
-    Arrays.getMaxOccurrence = MAX_count;
-    Arrays.toString = convertToString;
-    Arrays.maxValue = getmaxOf;
-    Arrays.minValue = getminOf;
-    Arrays.reverse = reverse;
-    Arrays.rotate = rotate;
-    Arrays.search = search;
-    Arrays.searchBIN = searchBIN;
-    Arrays.searchLIN = searchLIN;
-    Arrays.sort = dualPivotQuickSort;
-    Arrays.compare = compareTwoArray;
-    Arrays.sum = sumAllElements;
-    Arrays.isSorted = checkForSort;
-    Arrays.concat = concatenateTwoArrays;
-    Arrays.indexOf = firstIndexOf;
-    Arrays.hashCode = getHashCodeOf;
-    return SUCCESS;
-}
+isa_level activeISA();
 
 /**
- * 
+ * @brief Returns the printable name of an instruction set level.
+ */
+const char* isaName(isa_level level);
+
+/**
+ * @brief Enables or disables the instrumented Arrays table: call counts, elements and latency histograms.
+ */
+status_code useInstrumentedFunctions(bool enabled);
+
+/**
+ * @brief Copies the counters of every Arrays slot called since the last reset into `stats`.
+ */
+int callStats(array_call_stats* stats, int capacity);
+
+/**
+ * @brief Prints the counters of every Arrays slot called since the last reset.
+ */
+status_code dumpCallStats(FILE* out);
+
+/**
+ * @brief Starts the counters of every slot again from zero.
+ */
+void resetCallStats();
+
+/**
+ * @brief Installs the allocator used by every function that returns newly allocated memory.
+ */
+void useArrayAllocator(const array_allocator* allocator);
+
+/**
+ * @brief Releases memory returned by an allocating function through the installed allocator.
+ */
+void arraysRelease(void* ptr);
+
+/**
+ * @brief Arena allocator: initialization, allocation, bulk reset and destruction.
+ */
+void arenaInit(array_arena* arena, size_t blockSize);
+void* arenaAlloc(void* context, size_t size);
+void arenaReset(array_arena* arena);
+void arenaDestroy(array_arena* arena);
+array_allocator arenaAllocator(array_arena* arena);
+
+/**
+ * @brief Size-class pool allocator: initialization, allocation, release, bulk reset and destruction.
+ */
+void poolInit(array_pool* pool);
+void* poolAlloc(void* context, size_t size);
+void poolRelease(void* context, void* ptr);
+void poolReset(array_pool* pool);
+void poolDestroy(array_pool* pool);
+array_allocator poolAllocator(array_pool* pool);
+
+
+
+/**
+ * Allocator hook.
+ *
+ * Every function that returns newly allocated memory (copyOfRange, concat, toString,
+ * buildIndex, ...) obtains it through the allocator installed with useArrayAllocator().
+ * Such memory must be released with Arrays.release(), which is plain free() for the
+ * default allocator. Scratch buffers that never leave a function still use malloc.
+ */
+static void* defaultAlloc(void* context, size_t size) {
+    (void)context;
+    return malloc(size);
+}
+
+static void defaultRelease(void* context, void* ptr) {
+    (void)context;
+    free(ptr);
+}
+
+static array_allocator arraysAllocator = {defaultAlloc, defaultRelease, NULL};
+
+/**
+ * @brief Installs the allocator used by every allocating function.
+ * @param allocator The allocator to copy, or NULL to restore malloc/free.
+ */
+void useArrayAllocator(const array_allocator* allocator) {
+    if (allocator == NULL || allocator->alloc == NULL || allocator->release == NULL) {
+        arraysAllocator.alloc = defaultAlloc;
+        arraysAllocator.release = defaultRelease;
+        arraysAllocator.context = NULL;
+    } else {
+        arraysAllocator = *allocator;
+    }
+}
+
+/**
+ * @brief Allocates memory through the installed allocator.
+ */
+static void* arraysAlloc(size_t size) {
+    return arraysAllocator.alloc(arraysAllocator.context, size);
+}
+
+/**
+ * @brief Releases memory returned by any allocating function. NULL is ignored.
+ */
+void arraysRelease(void* ptr) {
+    if (ptr != NULL)
+        arraysAllocator.release(arraysAllocator.context, ptr);
+}
+
+/**
+ * @brief Allocates storage for an object that owns it. The first allocation records the
+ * installed allocator in `owner`; later ones, and ownedRelease(), go through the recorded one,
+ * so installing another allocator meanwhile does not mix them up.
+ */
+static void* ownedAlloc(array_allocator* owner, size_t size) {
+    if (owner->alloc == NULL)
+        *owner = arraysAllocator;
+    return owner->alloc(owner->context, size);
+}
+
+/**
+ * @brief Releases storage obtained with ownedAlloc(). NULL is ignored.
+ */
+static void ownedRelease(const array_allocator* owner, void* ptr) {
+    if (ptr != NULL)
+        owner->release(owner->context, ptr);
+}
+
+struct array_arena_block {
+    array_arena_block* next;
+    size_t size;
+    size_t used;
+    size_t padding;
+};
+
+/**
+ * @brief Prepares an empty arena whose blocks hold at least blockSize bytes (0 picks 64 KiB).
+ */
+void arenaInit(array_arena* arena, size_t blockSize) {
+    arena->head = NULL;
+    arena->blockSize = blockSize ? blockSize : 65536;
+}
+
+/**
+ * @brief Allocates from an arena; used as the alloc callback of arenaAllocator().
+ */
+void* arenaAlloc(void* context, size_t size) {
+    array_arena* arena = (array_arena*)context;
+    size = (size + 15) & ~(size_t)15;
+    array_arena_block* block = arena->head;
+    if (block == NULL || block->size - block->used < size) {
+        size_t capacity = size > arena->blockSize ? size : arena->blockSize;
+        block = (array_arena_block*)malloc(sizeof(array_arena_block) + capacity);
+        if (block == NULL)
+            return NULL;
+        block->size = capacity;
+        block->used = 0;
+        block->next = arena->head;
+        arena->head = block;
+    }
+    void* ptr = (char*)(block + 1) + block->used;
+    block->used += size;
+    return ptr;
+}
+
+static void arenaRelease(void* context, void* ptr) {
+    (void)context;
+    (void)ptr;
+}
+
+/**
+ * @brief Releases every allocation of the arena at once. The most recent block is kept for reuse.
+ */
+void arenaReset(array_arena* arena) {
+    array_arena_block* block = arena->head;
+    if (block == NULL)
+        return;
+    array_arena_block* next = block->next;
+    while (next != NULL) {
+        array_arena_block* after = next->next;
+        free(next);
+        next = after;
+    }
+    block->next = NULL;
+    block->used = 0;
+}
+
+/**
+ * @brief Releases every allocation and every block of the arena. Handles, vectors and indexes
+ * that allocated from it must be freed first.
+ */
+void arenaDestroy(array_arena* arena) {
+    while (arena->head != NULL) {
+        array_arena_block* next = arena->head->next;
+        free(arena->head);
+        arena->head = next;
+    }
+}
+
+/**
+ * @brief Returns an allocator that carves memory from the arena; release is a no-op.
+ */
+array_allocator arenaAllocator(array_arena* arena) {
+    array_allocator allocator;
+    allocator.alloc = arenaAlloc;
+    allocator.release = arenaRelease;
+    allocator.context = arena;
+    return allocator;
+}
+
+/**
+ * Size-class pool. Each block starts with a 16-byte header: its class, and for requests
+ * above ARRAYS_POOL_MAX_CLASS its slot in the pool's list of large allocations.
+ */
+#define ARRAYS_POOL_MIN_SHIFT 4
+#define ARRAYS_POOL_MAX_CLASS 65536
+#define ARRAYS_POOL_SLAB 262144
+#define ARRAYS_POOL_LARGE ((size_t)-1)
+
+struct array_pool_header {
+    size_t sizeClass;
+    size_t slot;
+};
+
+/**
+ * @brief Prepares an empty pool.
+ */
+void poolInit(array_pool* pool) {
+    memset(pool, 0, sizeof(*pool));
+}
+
+/**
+ * @brief Allocates from a pool; used as the alloc callback of poolAllocator().
+ */
+void* poolAlloc(void* context, size_t size) {
+    array_pool* pool = (array_pool*)context;
+    struct array_pool_header* header;
+    size_t total = size + sizeof(struct array_pool_header);
+
+    if (total > ARRAYS_POOL_MAX_CLASS) {
+        if (pool->largeCount == pool->largeCapacity) {
+            size_t capacity = pool->largeCapacity ? pool->largeCapacity * 2 : 16;
+            void** large = (void**)realloc(pool->large, capacity * sizeof(void*));
+            if (large == NULL)
+                return NULL;
+            pool->large = large;
+            pool->largeCapacity = capacity;
+        }
+        header = (struct array_pool_header*)malloc(total);
+        if (header == NULL)
+            return NULL;
+        header->sizeClass = ARRAYS_POOL_LARGE;
+        header->slot = pool->largeCount;
+        pool->large[pool->largeCount++] = header;
+        return header + 1;
+    }
+
+    size_t sizeClass = 0;
+    while (((size_t)1 << (sizeClass + ARRAYS_POOL_MIN_SHIFT)) < total) {
+        sizeClass++;
+    }
+    size_t blockSize = (size_t)1 << (sizeClass + ARRAYS_POOL_MIN_SHIFT);
+    if (pool->freeLists[sizeClass] == NULL) {
+        char* slab = (char*)malloc(ARRAYS_POOL_SLAB);
+        if (slab == NULL)
+            return NULL;
+        *(void**)slab = pool->slabs;
+        pool->slabs = slab;
+        for (size_t offset = 16; offset + blockSize <= ARRAYS_POOL_SLAB; offset += blockSize) {
+            *(void**)(slab + offset) = pool->freeLists[sizeClass];
+            pool->freeLists[sizeClass] = slab + offset;
+        }
+    }
+    header = (struct array_pool_header*)pool->freeLists[sizeClass];
+    pool->freeLists[sizeClass] = *(void**)header;
+    header->sizeClass = sizeClass;
+    return header + 1;
+}
+
+/**
+ * @brief Returns a block to its pool; used as the release callback of poolAllocator().
+ */
+void poolRelease(void* context, void* ptr) {
+    array_pool* pool = (array_pool*)context;
+    struct array_pool_header* header = (struct array_pool_header*)ptr - 1;
+    if (header->sizeClass == ARRAYS_POOL_LARGE) {
+        struct array_pool_header* moved = (struct array_pool_header*)pool->large[--pool->largeCount];
+        moved->slot = header->slot;
+        pool->large[header->slot] = moved;
+        free(header);
+        return;
+    }
+    size_t sizeClass = header->sizeClass;
+    *(void**)header = pool->freeLists[sizeClass];
+    pool->freeLists[sizeClass] = header;
+}
+
+/**
+ * @brief Releases every allocation of the pool at once, including large ones.
+ */
+void poolReset(array_pool* pool) {
+    while (pool->slabs != NULL) {
+        void* next = *(void**)pool->slabs;
+        free(pool->slabs);
+        pool->slabs = next;
+    }
+    for (size_t i = 0; i < pool->largeCount; ++i) {
+        free(pool->large[i]);
+    }
+    pool->largeCount = 0;
+    memset(pool->freeLists, 0, sizeof(pool->freeLists));
+}
+
+/**
+ * @brief Releases every allocation and all bookkeeping of the pool. Handles, vectors and
+ * indexes that allocated from it must be freed first.
+ */
+void poolDestroy(array_pool* pool) {
+    poolReset(pool);
+    free(pool->large);
+    pool->large = NULL;
+    pool->largeCapacity = 0;
+}
+
+/**
+ * @brief Returns an allocator backed by the pool.
+ */
+array_allocator poolAllocator(array_pool* pool) {
+    array_allocator allocator;
+    allocator.alloc = poolAlloc;
+    allocator.release = poolRelease;
+    allocator.context = pool;
+    return allocator;
+}
+
+/**
+ * Copies of at least this many ints bypass the cache with non-temporal stores on x86, so a
+ * large destination does not evict the working set. Define before including this header to override.
+ */
+#ifndef ARRAYS_STREAMING_THRESHOLD
+#define ARRAYS_STREAMING_THRESHOLD (1 << 20)
+#endif
+
+/**
+ * Function: copyInts
+ * ------------------
+ * Copies n ints between non-overlapping buffers. Small copies use memcpy; copies of at least
+ * ARRAYS_STREAMING_THRESHOLD ints use SSE2 non-temporal stores once the destination is
+ * 16-byte aligned.
+ */
+static void copyInts(int* dest, const int* src, size_t n) {
+#if defined(ARRAYS_X86_SIMD) && defined(__SSE2__)
+    if (n >= ARRAYS_STREAMING_THRESHOLD) {
+        size_t head = ((16 - ((size_t)dest & 15)) & 15) / sizeof(int);
+        if (((size_t)dest & 3) == 0) {
+            memcpy(dest, src, head * sizeof(int));
+            size_t i = head;
+            for (; i + 16 <= n; i += 16) {
+                __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+                __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 4));
+                __m128i c = _mm_loadu_si128((const __m128i*)(src + i + 8));
+                __m128i d = _mm_loadu_si128((const __m128i*)(src + i + 12));
+                _mm_stream_si128((__m128i*)(dest + i), a);
+                _mm_stream_si128((__m128i*)(dest + i + 4), b);
+                _mm_stream_si128((__m128i*)(dest + i + 8), c);
+                _mm_stream_si128((__m128i*)(dest + i + 12), d);
+            }
+            _mm_sfence();
+            memcpy(dest + i, src + i, (n - i) * sizeof(int));
+            return;
+        }
+    }
+#endif
+    memcpy(dest, src, n * sizeof(int));
+}
+
+/**
+ * 
  * Function: copyOfRange
  * ---------------------
  * Creates a copy of a specified range of an array.
@@ -166,47 +1316,117 @@ status_code useArrayFunctions() {
  * Parameters:
  * - arr: The original array.
  * - start: The starting index of the range.
- * - end: The ending index of the range.
+ * - end: The ending index of the range (exclusive).
  *
  * Returns:
- * A new array containing the specified range of elements.
- * NOTE: The array returned must be freed explicitly by the user.
+ * A new array containing the specified range of elements, or NULL if end < start or memory
+ * could not be allocated.
+ * NOTE: The array returned must be released explicitly by the user (Arrays.release).
  */
 inline int* copyOfRange(const int* arr, int start, int end) {
-    int *ret_arr = (int*)malloc(end - start);
-    for (int i = 0, j = start; i < end - start; ++i, ++j) {
-        ret_arr[i] = arr[j];
-    }
+    if (end < start)
+        return NULL;
+    size_t count = (size_t)(end - start);
+    int *ret_arr = (int*)arraysAlloc((count ? count : 1) * sizeof(int));
+    if (ret_arr == NULL)
+        return NULL;
+    copyInts(ret_arr, arr + start, count);
     return ret_arr;
 }
 
+/**
+ * Function: copyOfRangeInto
+ * -------------------------
+ * Copies a specified range of an array into a caller-provided buffer, without allocating.
+ *
+ * Parameters:
+ * - arr: The original array.
+ * - start: The starting index of the range.
+ * - end: The ending index of the range (exclusive).
+ * - dest: The destination buffer. Must not overlap the range.
+ * - capacity: The number of ints dest can hold; at most this many are copied.
+ *
+ * Returns:
+ * The number of elements written.
+ */
+inline int copyOfRangeInto(const int* arr, int start, int end, int* dest, int capacity) {
+    if (end <= start || capacity <= 0)
+        return 0;
+    int count = end - start < capacity ? end - start : capacity;
+    copyInts(dest, arr + start, (size_t)count);
+    return count;
+}
+
+/**
+ * Largest rotation side, in ints, that rotate() moves through a stack buffer instead of
+ * reversing. Define before including this header to override.
+ */
+#ifndef ARRAYS_ROTATE_BUFFER
+#define ARRAYS_ROTATE_BUFFER 256
+#endif
+
 /**
  * Function: rotate
  * ----------------
- * Rotates an array to the right by a specified number of positions.
+ * Rotates an array to the right by a specified number of positions, in O(n) time.
+ *
+ * When the shorter side of the rotation fits in ARRAYS_ROTATE_BUFFER ints it is parked in a
+ * stack buffer while the rest of the array moves with a single memmove; otherwise the array
+ * is rotated in place by three reversals.
  *
  * Parameters:
  * - arr: The array to be rotated.
  * - n: The size of the array.
- * - k: The number of positions to rotate the array.
+ * - k: The number of positions to rotate the array. Negative values rotate to the left.
  *
  * Returns:
- * The rotated array.
- * 
- * NOTE: The array returned must be freed explicitly by the user.
+ * The rotated array (arr itself; the rotation is done in place).
  */
 inline int* rotate(int* arr, int n, int k) {
+    if (n <= 1)
+        return arr;
     k = k % n;
-    for (int i = 0; i < k; ++i) {
-        int temp = arr[0];
-        for (int j = 0; j < n - 1; ++j) {
-            arr[j] = arr[j + 1];
-        }
-        arr[n - 1] = temp;
+    if (k < 0)
+        k += n;
+    if (k == 0)
+        return arr;
+
+    int buffer[ARRAYS_ROTATE_BUFFER];
+    if (k <= ARRAYS_ROTATE_BUFFER) {
+        memcpy(buffer, arr + n - k, (size_t)k * sizeof(int));
+        memmove(arr + k, arr, (size_t)(n - k) * sizeof(int));
+        memcpy(arr, buffer, (size_t)k * sizeof(int));
+    } else if (n - k <= ARRAYS_ROTATE_BUFFER) {
+        memcpy(buffer, arr, (size_t)(n - k) * sizeof(int));
+        memmove(arr, arr + n - k, (size_t)k * sizeof(int));
+        memcpy(arr + k, buffer, (size_t)(n - k) * sizeof(int));
+    } else {
+        reverse(arr, n);
+        reverse(arr, k);
+        reverse(arr + k, n - k);
     }
     return arr;
 }
 
+/**
+ * Function: rotateLeft
+ * --------------------
+ * Rotates an array to the left by a specified number of positions, in O(n) time.
+ *
+ * Parameters:
+ * - arr: The array to be rotated.
+ * - n: The size of the array.
+ * - k: The number of positions to rotate the array. Negative values rotate to the right.
+ *
+ * Returns:
+ * The rotated array (arr itself; the rotation is done in place).
+ */
+inline int* rotateLeft(int* arr, int n, int k) {
+    if (n <= 1)
+        return arr;
+    return rotate(arr, n, -(k % n));
+}
+
 /**
  * Function: searchLIN
  * -------------------
@@ -221,13 +1441,11 @@ inline int* rotate(int* arr, int n, int k) {
  * The index of the first occurrence of the value, or -1 if not found.
  */
 inline int searchLIN(const int* arr, int n, int sr) {
-    int index = -1;
-    for (int i = 0; i < n && index < 0; ++i) {
-        if (arr[i] == sr) {
-            index = i;
-        }
+    for (int i = 0; i < n; ++i) {
+        if (arr[i] == sr)
+            return i;
     }
-    return index;
+    return -1;
 }
 
 /**
@@ -242,6 +1460,7 @@ inline int searchLIN(const int* arr, int n, int sr) {
  *
  * Returns:
  * The count of occurrences and prints the indices of each occurrence.
+ * Use countOccurrences or searchAll on hot paths; they do not print.
  */
 inline int search(const int* arr, int n, int sr) {
     int count = 0;
@@ -255,156 +1474,600 @@ inline int search(const int* arr, int n, int sr) {
 }
 
 /**
- * Function: searchBIN
- * -------------------
- * Searches for the first occurrence of a value in the sorted array using binary search.
+ * Function: countOccurrences
+ * --------------------------
+ * Counts the occurrences of a value in the array without printing anything.
  *
  * Parameters:
- * - arr: The sorted array to be searched.
+ * - arr: The array to be searched.
  * - n: The size of the array.
  * - sr: The value to search for.
  *
  * Returns:
- * The index of the first occurrence of the value, or -1 if not found.
+ * The number of elements equal to the value.
  */
-inline int searchBIN(const int* arr, int n, int sr) {
-    int start = 0, end = n, mid;
-    int index = -1;
-    while (start < end && index != mid) {
-        mid = (start + end) / 2;
-        if (arr[mid] == sr)
-            index = mid;
-        else if (arr[mid] < sr)
-            start = mid + 1;
-        else
-            end = mid - 1;
+inline int countOccurrences(const int* arr, int n, int sr) {
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        count += (arr[i] == sr);
     }
-    return index;
+    return count;
 }
 
 /**
- * Function: reverse
- * -----------------
- * Reverses the elements of an array in-place.
+ * Function: searchAll
+ * -------------------
+ * Searches for all occurrences of a value in the array and stores their indices, in
+ * ascending order, in a caller-provided buffer.
  *
  * Parameters:
- * - arr: The array to be reversed.
+ * - arr: The array to be searched.
  * - n: The size of the array.
+ * - sr: The value to search for.
+ * - indices: Receives the indices of the first `capacity` occurrences. May be NULL if capacity is 0.
+ * - capacity: The number of ints `indices` can hold.
  *
  * Returns:
- * The reversed array.
- * 
- * NOTE: The array returned must be freed explicitly by the user.
+ * The total number of occurrences, which may exceed `capacity`; only the first `capacity`
+ * indices are stored.
  */
-inline int* reverse(int* arr, int n) {
-    for (int i = 0; i < n / 2; ++i) {
-        int temp = arr[i];
-        arr[i] = arr[n - i - 1];
-        arr[n - i - 1] = temp;
+inline int searchAll(const int* arr, int n, int sr, int* indices, int capacity) {
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        if (arr[i] == sr) {
+            if (count < capacity)
+                indices[count] = i;
+            count++;
+        }
     }
-    return arr;
+    return count;
 }
 
 /**
- * Function: MAX_count
+ * Function: searchBIN
  * -------------------
- * Counts the occurrences of the maximum value in the array.
+ * Searches for the first occurrence of a value in the sorted array using binary search.
  *
  * Parameters:
- * - arr: The array to be processed.
+ * - arr: The sorted array to be searched.
  * - n: The size of the array.
+ * - sr: The value to search for.
  *
  * Returns:
- * The count of occurrences of the maximum value.
+ * The index of the first occurrence of the value, or -1 if not found.
  */
-inline int MAX_count(const int* arr, int n) {
-    int maximum = arr[0];
-    int count = 0;
-    for (int i = 1; i < n; ++i) {
-        if (arr[i] > maximum) {
-            count = 1;
-        } else if (arr[i] == maximum)
-            count++;
+inline int searchBIN(const int* arr, int n, int sr) {
+    int start = 0, end = n;
+    while (start < end) {
+        int mid = start + (end - start) / 2;
+        if (arr[mid] < sr)
+            start = mid + 1;
+        else
+            end = mid;
     }
-    return count;
+    return (start < n && arr[start] == sr) ? start : -1;
 }
 
 /**
- * Function: getminOf
- * -------------------
- * Finds the minimum value in the array.
- *
- * Parameters:
- * - arr: The array to be processed.
- * - n: The size of the array.
+ * Function: fillEytzinger
+ * -----------------------
+ * Writes sorted[next..] into the subtree rooted at node k by an in-order traversal, so the
+ * in-order sequence of the tree is the sorted array.
  *
  * Returns:
- * The minimum value in the array.
+ * The index of the next sorted element to place.
  */
-inline int getminOf(const int* arr, int n) {
-    int minimum = arr[0];
-    for (int i = 1; i < n; ++i) {
-        if (arr[i] < minimum) {
-            minimum = arr[i];
-        }
+static int fillEytzinger(search_index* index, const int* sorted, int next, int k) {
+    if (k <= index->n) {
+        next = fillEytzinger(index, sorted, next, 2 * k);
+        index->keys[k] = sorted[next];
+        index->positions[k] = next;
+        next++;
+        next = fillEytzinger(index, sorted, next, 2 * k + 1);
     }
-    return minimum;
+    return next;
 }
 
 /**
- * Function: getmaxOf
- * -------------------
- * Finds the maximum value in the array.
+ * Function: buildSearchIndex
+ * --------------------------
+ * Builds an Eytzinger-ordered search index from a sorted array. The array itself is not
+ * referenced after the call.
  *
  * Parameters:
- * - arr: The array to be processed.
+ * - sorted: The array, sorted in ascending order.
  * - n: The size of the array.
  *
  * Returns:
- * The maximum value in the array.
+ * The new index, or NULL if memory could not be allocated.
+ * NOTE: The index returned must be released with freeSearchIndex.
  */
-inline int getmaxOf(const int* arr, int n) {
-    int maximum = arr[0];
-    for (int i = 1; i < n; ++i) {
-        if (arr[i] > maximum) {
-            maximum = arr[i];
-        }
+search_index* buildSearchIndex(const int* sorted, int n) {
+    if (n < 0)
+        return NULL;
+    array_allocator allocator = {0};
+    search_index* index = (search_index*)ownedAlloc(&allocator, sizeof(search_index));
+    if (index == NULL)
+        return NULL;
+    index->allocator = allocator;
+    size_t slots = (size_t)n + 1;
+    index->storage = ownedAlloc(&index->allocator, 2 * slots * sizeof(int) + 64);
+    if (index->storage == NULL) {
+        ownedRelease(&allocator, index);
+        return NULL;
     }
-    return maximum;
+    index->keys = (int*)(((size_t)index->storage + 63) & ~(size_t)63);
+    index->positions = index->keys + slots;
+    index->n = n;
+    index->keys[0] = 0;
+    index->positions[0] = n;
+    fillEytzinger(index, sorted, 0, 1);
+    return index;
 }
 
 /**
- * Function: convertToString
+ * Function: freeSearchIndex
+ * -------------------------
+ * Releases an index created by buildSearchIndex. NULL is ignored.
+ */
+void freeSearchIndex(search_index* index) {
+    if (index == NULL)
+        return;
+    array_allocator allocator = index->allocator;
+    ownedRelease(&allocator, index->storage);
+    ownedRelease(&allocator, index);
+}
+
+/**
+ * Function: indexLowerBound
  * -------------------------
- * Converts an integer array to a string representation.
+ * Finds the first position of the original sorted array whose value is not less than the key.
+ * The descent is branchless and prefetches the node four levels ahead.
  *
  * Parameters:
- * - arr: The array to be converted.
+ * - index: An index built by buildSearchIndex.
+ * - sr: The value to search for.
+ *
+ * Returns:
+ * The position in the original array, or n if every element is less than the key.
+ */
+int indexLowerBound(const search_index* index, int sr) {
+    const int* keys = index->keys;
+    int n = index->n;
+    unsigned int k = 1;
+    while (k <= (unsigned int)n) {
+        ARRAYS_PREFETCH(keys + 16 * (size_t)k);
+        k = 2 * k + (keys[k] < sr);
+    }
+    k >>= ARRAYS_FFS(~k);
+    return index->positions[k];
+}
+
+/**
+ * Function: indexFind
+ * -------------------
+ * Searches the index for the first occurrence of a value.
+ *
+ * Parameters:
+ * - index: An index built by buildSearchIndex.
+ * - sr: The value to search for.
+ *
+ * Returns:
+ * The position of the first occurrence in the original array, or -1 if not found.
+ */
+int indexFind(const search_index* index, int sr) {
+    const int* keys = index->keys;
+    int n = index->n;
+    unsigned int k = 1;
+    while (k <= (unsigned int)n) {
+        ARRAYS_PREFETCH(keys + 16 * (size_t)k);
+        k = 2 * k + (keys[k] < sr);
+    }
+    k >>= ARRAYS_FFS(~k);
+    return (k != 0 && keys[k] == sr) ? index->positions[k] : -1;
+}
+
+/**
+ * Number of keys searchBINBatch walks down the array together. Each step issues one
+ * independent load per key, so up to this many cache misses are in flight at once.
+ */
+#ifndef ARRAYS_BATCH_GROUP
+#define ARRAYS_BATCH_GROUP 16
+#endif
+
+/**
+ * Function: gallopLowerBound
+ * --------------------------
+ * Finds the first position in arr[from..n) whose value is not less than the key by
+ * doubling the step from `from` until the key is passed, then binary searching the
+ * last step. Costs O(log d) where d is the distance from `from` to the answer.
+ *
+ * Returns:
+ * A position in [from, n].
+ */
+static int gallopLowerBound(const int* arr, int from, int n, int key) {
+    int low = from;
+    int step = 1;
+    int high = from;
+    while (high < n && arr[high] < key) {
+        low = high + 1;
+        high = from + step;
+        step *= 2;
+    }
+    if (high > n)
+        high = n;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (arr[mid] < key)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/**
+ * Function: searchBINBatch
+ * ------------------------
+ * Searches a sorted array for many keys at once; out[i] follows the searchBIN contract for keys[i].
+ *
+ * Unsorted keys are processed in groups of ARRAYS_BATCH_GROUP. Every key of a group runs the
+ * same branchless lower-bound descent in lock step (the remaining length depends only on n),
+ * and each key's next probe is prefetched while the rest of the group advances, so the memory
+ * latency of the group overlaps. Sorted keys are instead answered by one merge-style walk that gallops
+ * forward from the previous answer.
+ *
+ * Parameters:
+ * - arr: The sorted array to be searched.
+ * - n: The size of the array.
+ * - keys: The values to search for.
+ * - m: The number of keys.
+ * - out: Receives m results: the index of the first occurrence of keys[i], or -1 if not found.
+ */
+void searchBINBatch(const int* arr, int n, const int* keys, int m, int* out) {
+    if (n <= 0) {
+        for (int i = 0; i < m; ++i) {
+            out[i] = -1;
+        }
+        return;
+    }
+
+    if (checkForSort((int*)keys, m)) {
+        int position = 0;
+        for (int i = 0; i < m; ++i) {
+            position = gallopLowerBound(arr, position, n, keys[i]);
+            out[i] = (position < n && arr[position] == keys[i]) ? position : -1;
+        }
+        return;
+    }
+
+    for (int first = 0; first < m; first += ARRAYS_BATCH_GROUP) {
+        int group = m - first < ARRAYS_BATCH_GROUP ? m - first : ARRAYS_BATCH_GROUP;
+        const int* base[ARRAYS_BATCH_GROUP];
+        for (int g = 0; g < group; ++g) {
+            base[g] = arr;
+        }
+        int length = n;
+        while (length > 1) {
+            int half = length / 2;
+            for (int g = 0; g < group; ++g) {
+                const int* probe = base[g];
+                base[g] = (probe[half] < keys[first + g]) ? probe + half : probe;
+                ARRAYS_PREFETCH(base[g] + (length - half) / 2);
+            }
+            length -= half;
+        }
+        for (int g = 0; g < group; ++g) {
+            int key = keys[first + g];
+            int position = (int)(base[g] - arr) + (*base[g] < key);
+            out[first + g] = (position < n && arr[position] == key) ? position : -1;
+        }
+    }
+}
+
+/**
+ * Function: reverse
+ * -----------------
+ * Reverses the elements of an array in-place.
+ *
+ * Parameters:
+ * - arr: The array to be reversed.
  * - n: The size of the array.
  *
  * Returns:
- * A string representation of the array.
+ * The reversed array.
  * 
  * NOTE: The array returned must be freed explicitly by the user.
  */
-inline char* convertToString(const int* arr, int n) {
-    char* ch = (char*)(malloc(2000));
-    ch[0] = '[';
-    ch[1] = '\0';
-    int count;
-    if (n == 0) {
-        count = snprintf(ch, 2000, "%s%s", ch, "NULL");
-        ch[count] = ']';
-        ch[count + 1] = '\0';
-    } 
-    else{
-        for (int i=0; i<n; i= i + 1) {
-            count = snprintf(ch, 2000, "%s%d, ",ch,arr[i]);
+inline int* reverse(int* arr, int n) {
+    for (int i = 0; i < n / 2; ++i) {
+        int temp = arr[i];
+        arr[i] = arr[n - i - 1];
+        arr[n - i - 1] = temp;
+    }
+    return arr;
+}
+
+/**
+ * Function: MAX_count
+ * -------------------
+ * Counts the occurrences of the maximum value in the array.
+ *
+ * Parameters:
+ * - arr: The array to be processed.
+ * - n: The size of the array.
+ *
+ * Returns:
+ * The count of occurrences of the maximum value.
+ */
+inline int MAX_count(const int* arr, int n) {
+    if (n <= 0)
+        return 0;
+    int maximum = arr[0];
+    int count = 1;
+    for (int i = 1; i < n; ++i) {
+        if (arr[i] > maximum) {
+            maximum = arr[i];
+            count = 1;
+        } else if (arr[i] == maximum)
+            count++;
+    }
+    return count;
+}
+
+/**
+ * Function: getminOf
+ * -------------------
+ * Finds the minimum value in the array.
+ *
+ * Parameters:
+ * - arr: The array to be processed.
+ * - n: The size of the array.
+ *
+ * Returns:
+ * The minimum value in the array, or 0 if the array is empty.
+ */
+inline int getminOf(const int* arr, int n) {
+    if (n <= 0)
+        return 0;
+    int minimum = arr[0];
+    for (int i = 1; i < n; ++i) {
+        if (arr[i] < minimum) {
+            minimum = arr[i];
+        }
+    }
+    return minimum;
+}
+
+/**
+ * Function: getmaxOf
+ * -------------------
+ * Finds the maximum value in the array.
+ *
+ * Parameters:
+ * - arr: The array to be processed.
+ * - n: The size of the array.
+ *
+ * Returns:
+ * The maximum value in the array, or 0 if the array is empty.
+ */
+inline int getmaxOf(const int* arr, int n) {
+    if (n <= 0)
+        return 0;
+    int maximum = arr[0];
+    for (int i = 1; i < n; ++i) {
+        if (arr[i] > maximum) {
+            maximum = arr[i];
+        }
+    }
+    return maximum;
+}
+
+/**
+ * Function: getMinMaxOf
+ * ---------------------
+ * Finds the minimum and the maximum value of the array in a single pass.
+ *
+ * Parameters:
+ * - arr: The array to be processed.
+ * - n: The size of the array.
+ * - minimum: Receives the minimum value, or 0 if the array is empty.
+ * - maximum: Receives the maximum value, or 0 if the array is empty.
+ */
+inline void getMinMaxOf(const int* arr, int n, int* minimum, int* maximum) {
+    if (n <= 0) {
+        *minimum = 0;
+        *maximum = 0;
+        return;
+    }
+    int low = arr[0];
+    int high = arr[0];
+    for (int i = 1; i < n; ++i) {
+        if (arr[i] < low)
+            low = arr[i];
+        if (arr[i] > high)
+            high = arr[i];
+    }
+    *minimum = low;
+    *maximum = high;
+}
+
+/**
+ * Two-digit lookup table used by formatInt: entries 2*v and 2*v+1 hold the digits of v (0-99).
+ */
+static const char arraysDigitPairs[201] =
+    "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+    "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+/**
+ * Function: decimalLength
+ * -----------------------
+ * Returns the number of characters formatInt writes for a value, including the minus sign.
+ */
+static size_t decimalLength(int value) {
+    unsigned int v = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    size_t length = value < 0 ? 2 : 1;
+    while (v >= 10) {
+        v /= 10;
+        length++;
+    }
+    return length;
+}
+
+/**
+ * Function: formatInt
+ * -------------------
+ * Writes the decimal form of a value (at most 11 characters, no terminator) two digits at a
+ * time using arraysDigitPairs.
+ *
+ * Returns:
+ * A pointer just past the last character written.
+ */
+static char* formatInt(char* out, int value) {
+    unsigned int v = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    char digits[10];
+    char* p = digits + sizeof(digits);
+    if (value < 0)
+        *out++ = '-';
+    while (v >= 100) {
+        unsigned int pair = (v % 100) * 2;
+        v /= 100;
+        *--p = arraysDigitPairs[pair + 1];
+        *--p = arraysDigitPairs[pair];
+    }
+    if (v >= 10) {
+        *--p = arraysDigitPairs[v * 2 + 1];
+        *--p = arraysDigitPairs[v * 2];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    size_t length = (size_t)(digits + sizeof(digits) - p);
+    memcpy(out, p, length);
+    return out + length;
+}
+
+/**
+ * Function: stringLength
+ * ----------------------
+ * Computes the exact length of the string convertToString produces for an array.
+ *
+ * Parameters:
+ * - arr: The array to be converted.
+ * - n: The size of the array.
+ *
+ * Returns:
+ * The number of characters, not counting the terminating '\0'.
+ */
+inline size_t stringLength(const int* arr, int n) {
+    if (n <= 0)
+        return 6;
+    size_t length = 2 * (size_t)n;
+    for (int i = 0; i < n; ++i) {
+        length += decimalLength(arr[i]);
+    }
+    return length;
+}
+
+/**
+ * Function: toStringInto
+ * ----------------------
+ * Writes the string representation of an array ("[1, 2, 3]", or "[NULL]" when empty) into a
+ * caller-provided buffer, without allocating.
+ *
+ * Parameters:
+ * - arr: The array to be converted.
+ * - n: The size of the array.
+ * - buffer: Receives the string and its terminating '\0'.
+ * - capacity: The size of buffer in bytes.
+ *
+ * Returns:
+ * The length of the string, as stringLength. If capacity is not larger than that, nothing is
+ * written except an empty string (when capacity > 0), so the caller can retry with a larger buffer.
+ */
+inline size_t toStringInto(const int* arr, int n, char* buffer, size_t capacity) {
+    size_t length = stringLength(arr, n);
+    if (capacity <= length) {
+        if (capacity > 0)
+            buffer[0] = '\0';
+        return length;
+    }
+    char* out = buffer;
+    *out++ = '[';
+    if (n <= 0) {
+        memcpy(out, "NULL", 4);
+        out += 4;
+    } else {
+        out = formatInt(out, arr[0]);
+        for (int i = 1; i < n; ++i) {
+            *out++ = ',';
+            *out++ = ' ';
+            out = formatInt(out, arr[i]);
+        }
+    }
+    *out++ = ']';
+    *out = '\0';
+    return length;
+}
+
+/**
+ * Function: writeTo
+ * -----------------
+ * Writes the string representation of an array to a stream through a fixed stack buffer,
+ * without allocating. No newline is appended.
+ *
+ * Parameters:
+ * - arr: The array to be converted.
+ * - n: The size of the array.
+ * - stream: The stream to write to.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the stream reported a write error.
+ */
+inline status_code writeTo(const int* arr, int n, FILE* stream) {
+    char buffer[4096];
+    size_t used = 0;
+    buffer[used++] = '[';
+    if (n <= 0) {
+        memcpy(buffer + used, "NULL", 4);
+        used += 4;
+    }
+    for (int i = 0; i < n; ++i) {
+        if (used + 16 > sizeof(buffer)) {
+            if (fwrite(buffer, 1, used, stream) != used)
+                return FAILURE;
+            used = 0;
         }
-        ch[count-2] = ']';
-        ch[count-1] = '\0';
+        if (i > 0) {
+            buffer[used++] = ',';
+            buffer[used++] = ' ';
+        }
+        used = (size_t)(formatInt(buffer + used, arr[i]) - buffer);
     }
+    buffer[used++] = ']';
+    return fwrite(buffer, 1, used, stream) == used ? SUCCESS : FAILURE;
+}
 
+/**
+ * Function: convertToString
+ * -------------------------
+ * Converts an integer array to a string representation, such as "[1, 2, 3]" ("[NULL]" when
+ * the array is empty). The output is sized exactly up front with stringLength.
+ *
+ * Parameters:
+ * - arr: The array to be converted.
+ * - n: The size of the array.
+ *
+ * Returns:
+ * A string representation of the array, or NULL if memory could not be allocated.
+ * 
+ * NOTE: The array returned must be released explicitly by the user (Arrays.release).
+ */
+inline char* convertToString(const int* arr, int n) {
+    size_t length = stringLength(arr, n);
+    char* ch = (char*)(arraysAlloc(length + 1));
+    if (ch == NULL)
+        return NULL;
+    toStringInto(arr, n, ch, length + 1);
     return ch;
 }
 
@@ -468,174 +2131,7249 @@ void pivotPartition(int* arr, int low, int high, struct record* pivot) {
 
 
 /**
- * Function: dualPivotQuickSort
+ * Tuning knobs for the sort engine. Both may be overridden by defining them
+ * before including this header.
+ *
+ * - ARRAYS_INSERTION_SORT_THRESHOLD: partitions with fewer elements than this
+ *   are finished with insertion sort.
+ * - ARRAYS_SORT_STACK_SIZE: capacity of the explicit range stack. The depth
+ *   guard bounds the number of pending ranges to 2 * (2 * log2(n)) + 3, so 136
+ *   covers every int-indexed array.
+ */
+#ifndef ARRAYS_INSERTION_SORT_THRESHOLD
+#define ARRAYS_INSERTION_SORT_THRESHOLD 32
+#endif
+
+#ifndef ARRAYS_SORT_STACK_SIZE
+#define ARRAYS_SORT_STACK_SIZE 136
+#endif
+
+struct sort_range {
+    int low;
+    int high;
+    int depth;
+};
+
+/**
+ * Function: insertionSortRange
  * ----------------------------
- * This algorithm offers O(nlog(n)) performance on many data sets that cause other quicksorts to degrade
- * to quadratic performance, and is typically faster than traditional (one-pivot) Quicksort implementations.
+ * Sorts arr[low..high] (inclusive) with insertion sort. Used as the base case
+ * of the sort engine, where it beats partitioning on small ranges.
  *
  * Parameters:
  * - arr: The array to be sorted.
- * - low: The starting index of the array or subarray.
- * - high: The ending index of the array or subarray.
+ * - low: The starting index of the range.
+ * - high: The ending index of the range.
  */
-void dualPivotQuickSort(int* arr, int low, int high) {
-    struct record Pivot;
-    Pivot.left = -1;
-    Pivot.right = -1;
-    if (low >= high)
-        return;
-    pivotPartition(arr, low, high, &Pivot);
-    dualPivotQuickSort(arr, low, Pivot.left - 1);
-    dualPivotQuickSort(arr, Pivot.left + 1, Pivot.right - 1);
-    dualPivotQuickSort(arr, Pivot.right + 1, high);
+static void insertionSortRange(int* arr, int low, int high) {
+    for (int i = low + 1; i <= high; ++i) {
+        int value = arr[i];
+        int j = i - 1;
+        while (j >= low && arr[j] > value) {
+            arr[j + 1] = arr[j];
+            j--;
+        }
+        arr[j + 1] = value;
+    }
 }
 
+/**
+ * Function: siftDown
+ * ------------------
+ * Restores the max-heap property for the heap rooted at `root`, where the heap
+ * occupies arr[base..base+size-1].
+ */
+static void siftDown(int* arr, int base, int root, int size) {
+    int value = arr[base + root];
+    for (;;) {
+        int child = 2 * root + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && arr[base + child + 1] > arr[base + child])
+            child++;
+        if (arr[base + child] <= value)
+            break;
+        arr[base + root] = arr[base + child];
+        root = child;
+    }
+    arr[base + root] = value;
+}
 
 /**
- * Function: compareTwoArray
- * Description: This function compares two integer arrays for equality.
+ * Function: heapSortRange
+ * -----------------------
+ * Sorts arr[low..high] (inclusive) with heapsort. The sort engine falls back to
+ * this when partitioning keeps producing unbalanced splits, which caps the
+ * worst case at O(nlog(n)).
+ *
  * Parameters:
- * - arr1: Pointer to the first integer array.
+ * - arr: The array to be sorted.
+ * - low: The starting index of the range.
+ * - high: The ending index of the range.
+ */
+static void heapSortRange(int* arr, int low, int high) {
+    int size = high - low + 1;
+    for (int root = size / 2 - 1; root >= 0; --root) {
+        siftDown(arr, low, root, size);
+    }
+    for (int end = size - 1; end > 0; --end) {
+        swapNumbers(arr, low, low + end);
+        siftDown(arr, low, 0, end);
+    }
+}
+
+/**
+ * Function: choosePivots
+ * ----------------------
+ * Samples five evenly spaced elements of arr[low..high], sorts them in place and
+ * moves the second and fourth into arr[low] and arr[high], where pivotPartition
+ * expects its pivots. Sampling keeps sorted, reversed and organ-pipe inputs
+ * from producing one-sided partitions.
+ *
+ * Parameters:
+ * - arr: The array to be partitioned.
+ * - low: The starting index of the range.
+ * - high: The ending index of the range. Must satisfy high - low >= 7.
+ */
+static void choosePivots(int* arr, int low, int high) {
+    int seventh = (high - low + 1) / 7;
+    int e3 = low + (high - low) / 2;
+    int e2 = e3 - seventh;
+    int e1 = e2 - seventh;
+    int e4 = e3 + seventh;
+    int e5 = e4 + seventh;
+    int e[5] = {e1, e2, e3, e4, e5};
+
+    for (int i = 1; i < 5; ++i) {
+        for (int j = i; j > 0 && arr[e[j - 1]] > arr[e[j]]; --j) {
+            swapNumbers(arr, e[j - 1], e[j]);
+        }
+    }
+    swapNumbers(arr, low, e2);
+    swapNumbers(arr, high, e4);
+}
+
+/**
+ * Function: groupPivotEqualKeys
+ * -----------------------------
+ * Moves elements equal to the left pivot to the front of the middle partition
+ * and elements equal to the right pivot to its back, so only keys strictly
+ * between the pivots are left to sort. This keeps inputs with many duplicates
+ * from re-partitioning the same values over and over.
+ *
+ * Parameters:
+ * - arr: The partitioned array.
+ * - middle: The middle partition; narrowed in place to the unsorted part.
+ * - leftPivot: The value of the left pivot.
+ * - rightPivot: The value of the right pivot.
+ */
+static void groupPivotEqualKeys(int* arr, struct sort_range* middle, int leftPivot, int rightPivot) {
+    int lt = middle->low;
+    int gt = middle->high;
+    int k = lt;
+    while (k <= gt) {
+        if (arr[k] == leftPivot)
+            swapNumbers(arr, k++, lt++);
+        else if (arr[k] == rightPivot)
+            swapNumbers(arr, k, gt--);
+        else
+            k++;
+    }
+    middle->low = lt;
+    middle->high = gt;
+}
+
+/**
+ * Function: introSort
+ * -------------------
+ * The comparison sort engine behind dualPivotQuickSort, built around pivotPartition:
+ * - Pivots are picked from a five element sample (choosePivots).
+ * - Ranges shorter than ARRAYS_INSERTION_SORT_THRESHOLD are finished with insertion sort.
+ * - Once the partition depth exceeds 2 * log2(n) the range is finished with heapsort.
+ * - Pending ranges live on a fixed-size explicit stack, so deep inputs cannot overflow the call stack.
+ *
+ * Parameters:
+ * - arr: The array to be sorted.
+ * - low: The starting index of the array or subarray.
+ * - high: The ending index of the array or subarray.
+ */
+static void introSort(int* arr, int low, int high) {
+    struct sort_range stack[ARRAYS_SORT_STACK_SIZE];
+    int top = 0;
+    if (arr == NULL || low >= high)
+        return;
+
+    int depth = 0;
+    for (int n = high - low + 1; n > 1; n >>= 1) {
+        depth += 2;
+    }
+    stack[top].low = low;
+    stack[top].high = high;
+    stack[top].depth = depth;
+    top++;
+
+    while (top > 0) {
+        struct sort_range range = stack[--top];
+        if (range.high - range.low < ARRAYS_INSERTION_SORT_THRESHOLD) {
+            insertionSortRange(arr, range.low, range.high);
+            continue;
+        }
+        if (range.depth == 0) {
+            heapSortRange(arr, range.low, range.high);
+            continue;
+        }
+
+        struct record Pivot;
+        choosePivots(arr, range.low, range.high);
+        pivotPartition(arr, range.low, range.high, &Pivot);
+
+        struct sort_range parts[3];
+        int count = 0;
+        parts[count].low = range.low;
+        parts[count].high = Pivot.left - 1;
+        count++;
+        parts[count].low = Pivot.right + 1;
+        parts[count].high = range.high;
+        count++;
+        if (arr[Pivot.left] != arr[Pivot.right]) {
+            struct sort_range middle;
+            middle.low = Pivot.left + 1;
+            middle.high = Pivot.right - 1;
+            if ((middle.high - middle.low) > (range.high - range.low) / 7 * 4) {
+                groupPivotEqualKeys(arr, &middle, arr[Pivot.left], arr[Pivot.right]);
+            }
+            parts[count++] = middle;
+        }
+
+        /* Push the largest range first so the smallest is processed next. */
+        for (int i = 1; i < count; ++i) {
+            for (int j = i; j > 0 && parts[j - 1].high - parts[j - 1].low < parts[j].high - parts[j].low; --j) {
+                struct sort_range temp = parts[j];
+                parts[j] = parts[j - 1];
+                parts[j - 1] = temp;
+            }
+        }
+        for (int i = 0; i < count; ++i) {
+            if (parts[i].low < parts[i].high) {
+                parts[i].depth = range.depth - 1;
+                stack[top++] = parts[i];
+            }
+        }
+    }
+}
+
+
+/**
+ * Ranges with at least this many elements are sorted by radixSort inside
+ * dualPivotQuickSort. Below it the comparison engine wins because the four
+ * 256-bucket histograms no longer amortize. Define before including this
+ * header to override.
+ */
+#ifndef ARRAYS_RADIX_SORT_THRESHOLD
+#define ARRAYS_RADIX_SORT_THRESHOLD 1024
+#endif
+
+/**
+ * @brief The radix sort behind radixSort and radixSort64: sorts n ints viewed as unsigned keys,
+ * scattering through scratch (allocated and freed here when NULL).
+ */
+static status_code radixSortKeys(unsigned int* keys, size_t n, unsigned int* scratch) {
+    unsigned int* buffer = scratch;
+    if (buffer == NULL) {
+        buffer = (unsigned int*)malloc(n * sizeof(unsigned int));
+        if (buffer == NULL)
+            return FAILURE;
+    }
+
+    size_t counts[4][256];
+    memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < n; ++i) {
+        unsigned int key = keys[i] ^ 0x80000000u;
+        counts[0][key & 0xFF]++;
+        counts[1][(key >> 8) & 0xFF]++;
+        counts[2][(key >> 16) & 0xFF]++;
+        counts[3][key >> 24]++;
+    }
+
+    unsigned int* from = keys;
+    unsigned int* to = buffer;
+    for (int pass = 0; pass < 4; ++pass) {
+        int shift = pass * 8;
+        size_t* count = counts[pass];
+        if (count[((from[0] ^ 0x80000000u) >> shift) & 0xFF] == n)
+            continue;
+
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit) {
+            size_t c = count[digit];
+            count[digit] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            unsigned int key = from[i];
+            to[count[((key ^ 0x80000000u) >> shift) & 0xFF]++] = key;
+        }
+        unsigned int* temp = from;
+        from = to;
+        to = temp;
+    }
+    if (from != keys) {
+        memcpy(keys, from, n * sizeof(unsigned int));
+    }
+
+    if (scratch == NULL)
+        free(buffer);
+    return SUCCESS;
+}
+
+/**
+ * Function: radixSort
+ * -------------------
+ * Sorts arr[low..high] (inclusive) with a least-significant-digit radix sort using four 8-bit digits.
+ * All four digit histograms are collected in a single pass, and passes whose digit is the same for
+ * every element are skipped. The sign bit is flipped while computing digits so negative values order
+ * before positive ones.
+ *
+ * Parameters:
+ * - arr: The array to be sorted.
+ * - low: The starting index of the array or subarray.
+ * - high: The ending index of the array or subarray.
+ * - scratch: A buffer of at least (high - low + 1) ints used as the scatter target, or NULL to let the
+ *   function allocate (and free) one itself.
+ *
+ * Returns:
+ * SUCCESS once the range is sorted, or FAILURE if no scratch buffer was given and allocating one failed.
+ * The array is left untouched on FAILURE.
+ */
+status_code radixSort(int* arr, int low, int high, int* scratch) {
+    if (arr == NULL || low >= high)
+        return SUCCESS;
+    return radixSortKeys((unsigned int*)(arr + low), (size_t)(high - low) + 1, (unsigned int*)scratch);
+}
+
+/**
+ * Function: dualPivotQuickSort
+ * ----------------------------
+ * This algorithm offers O(nlog(n)) performance on many data sets that cause other quicksorts to degrade
+ * to quadratic performance, and is typically faster than traditional (one-pivot) Quicksort implementations.
+ *
+ * Ranges of at least ARRAYS_RADIX_SORT_THRESHOLD elements are handed to radixSort instead; if its scratch
+ * buffer cannot be allocated the comparison engine (introSort) sorts the range in place.
+ *
+ * Parameters:
+ * - arr: The array to be sorted.
+ * - low: The starting index of the array or subarray.
+ * - high: The ending index of the array or subarray.
+ */
+void dualPivotQuickSort(int* arr, int low, int high) {
+    if (arr == NULL || low >= high)
+        return;
+    if (high - low >= ARRAYS_RADIX_SORT_THRESHOLD && radixSort(arr, low, high, NULL) == SUCCESS)
+        return;
+    introSort(arr, low, high);
+}
+
+/**
+ * Function: selectNth
+ * -------------------
+ * Rearranges the array so that arr[k] holds the value it would have if the array were sorted,
+ * every element before it is not greater and every element after it is not smaller
+ * (nth_element). Introselect: the range holding k is partitioned with choosePivots and
+ * pivotPartition and only that side is kept; small ranges are finished with insertion sort,
+ * and once the depth exceeds 2 * log2(n) the range is heapsorted, which bounds the worst case.
+ *
+ * Parameters:
+ * - arr: The array to be rearranged.
+ * - n: The size of the array.
+ * - k: The 0-based rank to select, for example n / 2 for the median or (n - 1) * 99 / 100 for p99.
+ *
+ * Returns:
+ * The k-th smallest value, or 0 (leaving the array unchanged) if k is not in [0, n).
+ */
+inline int selectNth(int* arr, int n, int k) {
+    if (arr == NULL || k < 0 || k >= n)
+        return 0;
+    int low = 0, high = n - 1;
+    int depth = 0;
+    for (int size = n; size > 1; size >>= 1) {
+        depth += 2;
+    }
+    while (high > low) {
+        if (high - low < ARRAYS_INSERTION_SORT_THRESHOLD) {
+            insertionSortRange(arr, low, high);
+            break;
+        }
+        if (depth-- == 0) {
+            heapSortRange(arr, low, high);
+            break;
+        }
+        struct record Pivot;
+        choosePivots(arr, low, high);
+        pivotPartition(arr, low, high, &Pivot);
+        if (k == Pivot.left || k == Pivot.right)
+            break;
+        if (k < Pivot.left) {
+            high = Pivot.left - 1;
+        } else if (k > Pivot.right) {
+            low = Pivot.right + 1;
+        } else {
+            if (arr[Pivot.left] == arr[Pivot.right])
+                break;
+            struct sort_range middle;
+            middle.low = Pivot.left + 1;
+            middle.high = Pivot.right - 1;
+            if ((middle.high - middle.low) > (high - low) / 7 * 4) {
+                groupPivotEqualKeys(arr, &middle, arr[Pivot.left], arr[Pivot.right]);
+            }
+            if (k < middle.low || k > middle.high)
+                break;
+            low = middle.low;
+            high = middle.high;
+        }
+    }
+    return arr[k];
+}
+
+/**
+ * Function: partialSort
+ * ---------------------
+ * Moves the k smallest elements, in ascending order, to the front of the array, in O(n + k log(k))
+ * instead of a full sort: selectNth places the k-th smallest, then only the front is sorted.
+ * The order of the remaining elements is unspecified.
+ *
+ * Parameters:
+ * - arr: The array to be rearranged.
+ * - n: The size of the array.
+ * - k: The number of smallest elements to sort; n or more sorts the whole array.
+ */
+inline void partialSort(int* arr, int n, int k) {
+    if (arr == NULL || k <= 0 || n <= 1)
+        return;
+    if (k < n)
+        selectNth(arr, n, k - 1);
+    dualPivotQuickSort(arr, 0, (k < n ? k : n) - 1);
+}
+
+/**
+ * @brief Heap key of a top-k value: the value itself when keeping the largest, its bitwise
+ * complement (which reverses the order without overflow) when keeping the smallest, so one
+ * min-heap serves both.
+ */
+static inline int topKKey(const array_top_k* state, int value) {
+    return state->largest ? value : ~value;
+}
+
+/**
+ * @brief Restores the min-heap property of the top-k heap from `root` down.
+ */
+static void topKSiftDown(int* heap, int size, int root) {
+    int value = heap[root];
+    for (;;) {
+        int child = 2 * root + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && heap[child + 1] < heap[child])
+            child++;
+        if (heap[child] >= value)
+            break;
+        heap[root] = heap[child];
+        root = child;
+    }
+    heap[root] = value;
+}
+
+/**
+ * @brief Replaces the root of a full top-k heap with `key` if it is better.
+ */
+static inline void topKOffer(int* heap, int size, int key) {
+    if (key > heap[0]) {
+        heap[0] = key;
+        topKSiftDown(heap, size, 0);
+    }
+}
+
+/**
+ * Function: topKInit
+ * ------------------
+ * Starts a streaming top-k selection into a caller-provided heap buffer.
+ *
+ * Parameters:
+ * - state: The state to initialize.
+ * - heap: A buffer of k ints that holds the current candidates; no memory is allocated.
+ * - k: The number of values to keep.
+ * - largest: true to keep the k largest values, false to keep the k smallest.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if heap is NULL or k is not positive.
+ */
+inline status_code topKInit(array_top_k* state, int* heap, int k, bool largest) {
+    if (state == NULL || heap == NULL || k <= 0)
+        return FAILURE;
+    state->heap = heap;
+    state->capacity = k;
+    state->size = 0;
+    state->largest = largest;
+    return SUCCESS;
+}
+
+/**
+ * Function: topKUpdate
+ * --------------------
+ * Offers a chunk of values to a top-k selection. Once k values are held, each new value is
+ * compared with the root of the bounded heap (the worst value kept) and skipped unless it is
+ * better, so a chunk costs O(n) plus O(log(k)) per replacement. Blocks of 16 values with
+ * nothing better than the root are skipped with one branch.
+ *
+ * Parameters:
+ * - state: A state initialized with topKInit.
+ * - arr: The values to offer.
+ * - n: The number of values.
+ */
+inline void topKUpdate(array_top_k* state, const int* arr, size_t n) {
+    size_t i = 0;
+    int* heap = state->heap;
+    for (; i < n && state->size < state->capacity; ++i) {
+        int at = state->size++;
+        int key = topKKey(state, arr[i]);
+        while (at > 0 && heap[(at - 1) / 2] > key) {
+            heap[at] = heap[(at - 1) / 2];
+            at = (at - 1) / 2;
+        }
+        heap[at] = key;
+    }
+    int flip = state->largest ? 0 : -1;
+    for (; i + 16 <= n; i += 16) {
+        int root = heap[0];
+        int better = 0;
+        for (int t = 0; t < 16; ++t)
+            better |= (arr[i + t] ^ flip) > root;
+        if (!better)
+            continue;
+        for (int t = 0; t < 16; ++t)
+            topKOffer(heap, state->size, arr[i + t] ^ flip);
+    }
+    for (; i < n; ++i)
+        topKOffer(heap, state->size, arr[i] ^ flip);
+}
+
+/**
+ * Function: topKResult
+ * --------------------
+ * Writes the values currently kept, best first: descending for the k largest, ascending for
+ * the k smallest. The state is unchanged and may keep receiving values.
+ *
+ * Parameters:
+ * - state: A state initialized with topKInit.
+ * - dest: Receives up to k values. Must not be the heap buffer.
+ *
+ * Returns:
+ * The number of values written: k, or fewer if fewer values have been offered.
+ */
+inline int topKResult(const array_top_k* state, int* dest) {
+    int size = state->size;
+    copyInts(dest, state->heap, (size_t)size);
+    dualPivotQuickSort(dest, 0, size - 1);
+    reverse(dest, size);
+    for (int i = 0; i < size; ++i)
+        dest[i] = topKKey(state, dest[i]);
+    return size;
+}
+
+
+/**
+ * Thread pool shared by the parallel functions.
+ *
+ * The pool is created on first use and reused by every later call. Each worker owns a
+ * deque of tasks: it pushes and pops at the tail, and idle workers steal from the head
+ * of other workers' deques. Threads outside the pool (the callers of parallel functions)
+ * share deque 0 and help run tasks while they wait for their own group to finish.
+ *
+ * - ARRAYS_NO_THREADS: define to build without pthreads; parallel functions then run sequentially.
+ * - ARRAYS_MAX_THREADS: upper bound on the pool size, including the calling thread.
+ * - ARRAYS_PARALLEL_GRAIN: ranges with fewer elements than this are not split any further
+ *   (the default of setParallelGrain()).
+ */
+#ifndef ARRAYS_MAX_THREADS
+#define ARRAYS_MAX_THREADS 256
+#endif
+
+#ifndef ARRAYS_PARALLEL_GRAIN
+#define ARRAYS_PARALLEL_GRAIN 65536
+#endif
+
+static ARRAYS_ATOMIC(size_t) arraysParallelGrain = ARRAYS_PARALLEL_GRAIN;
+
+struct arrays_task_group {
+    ARRAYS_ATOMIC(long) pending;
+};
+
+struct arrays_task {
+    void (*run)(struct arrays_task* task);
+    struct arrays_task_group* group;
+    void* context;
+    ptrdiff_t low;
+    ptrdiff_t high;
+    int depth;
+};
+
+#ifndef ARRAYS_NO_THREADS
+
+struct arrays_deque {
+    pthread_mutex_t lock;
+    struct arrays_task* tasks;
+    size_t head;
+    size_t count;
+    size_t capacity;
+};
+
+struct arrays_thread_pool {
+    pthread_t threads[ARRAYS_MAX_THREADS];
+    struct arrays_deque queues[ARRAYS_MAX_THREADS];
+    ARRAYS_ATOMIC(int) workers;
+    ARRAYS_ATOMIC(long) queued;
+    ARRAYS_ATOMIC(int) sleeping;
+    ARRAYS_ATOMIC(int) waiting;
+    bool shutdown;
+};
+
+static struct arrays_thread_pool arraysPool;
+static pthread_mutex_t arraysPoolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t arraysPoolWake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t arraysPoolDone = PTHREAD_COND_INITIALIZER;
+static ARRAYS_THREAD_LOCAL int arraysWorkerId = 0;
+
+/**
+ * Function: dequePush
+ * -------------------
+ * Appends a task to the tail of a deque, growing its ring buffer when full.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the ring buffer could not be grown.
+ */
+static status_code dequePush(struct arrays_deque* queue, const struct arrays_task* task) {
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count == queue->capacity) {
+        size_t capacity = queue->capacity ? queue->capacity * 2 : 64;
+        struct arrays_task* tasks = (struct arrays_task*)malloc(capacity * sizeof(struct arrays_task));
+        if (tasks == NULL) {
+            pthread_mutex_unlock(&queue->lock);
+            return FAILURE;
+        }
+        for (size_t i = 0; i < queue->count; ++i) {
+            tasks[i] = queue->tasks[(queue->head + i) % queue->capacity];
+        }
+        free(queue->tasks);
+        queue->tasks = tasks;
+        queue->head = 0;
+        queue->capacity = capacity;
+    }
+    queue->tasks[(queue->head + queue->count) % queue->capacity] = *task;
+    queue->count++;
+    pthread_mutex_unlock(&queue->lock);
+    return SUCCESS;
+}
+
+/**
+ * Function: dequeTake
+ * -------------------
+ * Removes a task from a deque: from the tail when the owner asks (LIFO keeps its working
+ * set in cache), from the head when another thread steals (FIFO hands out the largest,
+ * oldest ranges).
+ *
+ * Returns:
+ * true if a task was written to `task`, false if the deque was empty.
+ */
+static bool dequeTake(struct arrays_deque* queue, struct arrays_task* task, bool steal) {
+    bool found = false;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count > 0) {
+        if (steal) {
+            *task = queue->tasks[queue->head];
+            queue->head = (queue->head + 1) % queue->capacity;
+        } else {
+            *task = queue->tasks[(queue->head + queue->count - 1) % queue->capacity];
+        }
+        queue->count--;
+        found = true;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
+
+/**
+ * Function: poolFindTask
+ * ----------------------
+ * Takes a task from the calling thread's own deque, or steals one from another deque.
+ *
+ * Returns:
+ * true if a task was found.
+ */
+static bool poolFindTask(struct arrays_task* task) {
+    int self = arraysWorkerId;
+    int queues = ARRAYS_ATOMIC_LOAD(&arraysPool.workers, ARRAYS_ACQUIRE) + 1;
+    if (dequeTake(&arraysPool.queues[self], task, false)) {
+        ARRAYS_ATOMIC_SUB(&arraysPool.queued, 1, ARRAYS_SEQ_CST);
+        return true;
+    }
+    for (int i = 1; i < queues; ++i) {
+        if (dequeTake(&arraysPool.queues[(self + i) % queues], task, true)) {
+            ARRAYS_ATOMIC_SUB(&arraysPool.queued, 1, ARRAYS_SEQ_CST);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Function: poolRunTask
+ * ---------------------
+ * Runs a task and marks it finished in its group, waking the threads blocked in poolWait
+ * when it was the group's last task.
+ */
+static void poolRunTask(struct arrays_task* task) {
+    struct arrays_task_group* group = task->group;
+    task->run(task);
+    if (ARRAYS_ATOMIC_SUB_FETCH(&group->pending, 1, ARRAYS_SEQ_CST) == 0 && ARRAYS_ATOMIC_LOAD(&arraysPool.waiting, ARRAYS_SEQ_CST) > 0) {
+        pthread_mutex_lock(&arraysPoolLock);
+        pthread_cond_broadcast(&arraysPoolDone);
+        pthread_mutex_unlock(&arraysPoolLock);
+    }
+}
+
+/**
+ * Function: poolWorker
+ * --------------------
+ * Main loop of a pool thread: run local work, steal when out of it, and sleep on the
+ * pool condition variable when no deque has anything queued.
+ */
+static void* poolWorker(void* arg) {
+    arraysWorkerId = (int)(ptrdiff_t)arg;
+    struct arrays_task task;
+    for (;;) {
+        if (poolFindTask(&task)) {
+            poolRunTask(&task);
+            continue;
+        }
+        pthread_mutex_lock(&arraysPoolLock);
+        ARRAYS_ATOMIC_ADD(&arraysPool.sleeping, 1, ARRAYS_SEQ_CST);
+        while (ARRAYS_ATOMIC_LOAD(&arraysPool.queued, ARRAYS_SEQ_CST) == 0 && !arraysPool.shutdown) {
+            pthread_cond_wait(&arraysPoolWake, &arraysPoolLock);
+        }
+        ARRAYS_ATOMIC_SUB(&arraysPool.sleeping, 1, ARRAYS_SEQ_CST);
+        bool stop = arraysPool.shutdown;
+        pthread_mutex_unlock(&arraysPoolLock);
+        if (stop)
+            return NULL;
+    }
+}
+
+/**
+ * Function: poolEnsureThreads
+ * ---------------------------
+ * Grows the pool so that, together with the calling thread, at least `threads` threads
+ * run tasks. The pool never shrinks short of shutdownThreads().
+ *
+ * Returns:
+ * The number of threads available (pool workers plus the caller).
+ */
+static int poolEnsureThreads(int threads) {
+    if (threads > ARRAYS_MAX_THREADS)
+        threads = ARRAYS_MAX_THREADS;
+    pthread_mutex_lock(&arraysPoolLock);
+    arraysPool.shutdown = false;
+    if (arraysPool.workers == 0) {
+        pthread_mutex_init(&arraysPool.queues[0].lock, NULL);
+    }
+    while (arraysPool.workers + 1 < threads) {
+        int id = arraysPool.workers + 1;
+        pthread_mutex_init(&arraysPool.queues[id].lock, NULL);
+        if (pthread_create(&arraysPool.threads[id], NULL, poolWorker, (void*)(ptrdiff_t)id) != 0) {
+            pthread_mutex_destroy(&arraysPool.queues[id].lock);
+            break;
+        }
+        ARRAYS_ATOMIC_STORE(&arraysPool.workers, id, ARRAYS_RELEASE);
+    }
+    int available = arraysPool.workers + 1;
+    pthread_mutex_unlock(&arraysPoolLock);
+    return available;
+}
+
+/**
+ * Function: poolSubmit
+ * --------------------
+ * Queues a task on the calling thread's deque and wakes a sleeping worker. If the task
+ * cannot be queued it runs immediately on the calling thread.
+ */
+static void poolSubmit(const struct arrays_task* task) {
+    ARRAYS_ATOMIC_ADD(&task->group->pending, 1, ARRAYS_ACQ_REL);
+    if (ARRAYS_ATOMIC_LOAD(&arraysPool.workers, ARRAYS_ACQUIRE) == 0 || dequePush(&arraysPool.queues[arraysWorkerId], task) != SUCCESS) {
+        struct arrays_task local = *task;
+        poolRunTask(&local);
+        return;
+    }
+    ARRAYS_ATOMIC_ADD(&arraysPool.queued, 1, ARRAYS_SEQ_CST);
+    if (ARRAYS_ATOMIC_LOAD(&arraysPool.sleeping, ARRAYS_SEQ_CST) > 0) {
+        pthread_mutex_lock(&arraysPoolLock);
+        pthread_cond_signal(&arraysPoolWake);
+        pthread_mutex_unlock(&arraysPoolLock);
+    }
+    if (ARRAYS_ATOMIC_LOAD(&arraysPool.waiting, ARRAYS_SEQ_CST) > 0) {
+        pthread_mutex_lock(&arraysPoolLock);
+        pthread_cond_signal(&arraysPoolDone);
+        pthread_mutex_unlock(&arraysPoolLock);
+    }
+}
+
+/**
+ * Function: poolWait
+ * ------------------
+ * Blocks until every task of `group` has finished, running queued tasks on the calling
+ * thread in the meantime. When nothing is queued it sleeps on arraysPoolDone, which is
+ * signalled when a task is queued or a group finishes.
+ */
+static void poolWait(struct arrays_task_group* group) {
+    struct arrays_task task;
+    while (ARRAYS_ATOMIC_LOAD(&group->pending, ARRAYS_ACQUIRE) > 0) {
+        if (poolFindTask(&task)) {
+            poolRunTask(&task);
+            continue;
+        }
+        pthread_mutex_lock(&arraysPoolLock);
+        ARRAYS_ATOMIC_ADD(&arraysPool.waiting, 1, ARRAYS_SEQ_CST);
+        while (ARRAYS_ATOMIC_LOAD(&group->pending, ARRAYS_SEQ_CST) > 0 && ARRAYS_ATOMIC_LOAD(&arraysPool.queued, ARRAYS_SEQ_CST) == 0) {
+            pthread_cond_wait(&arraysPoolDone, &arraysPoolLock);
+        }
+        ARRAYS_ATOMIC_SUB(&arraysPool.waiting, 1, ARRAYS_SEQ_CST);
+        pthread_mutex_unlock(&arraysPoolLock);
+    }
+}
+
+/**
+ * Function: shutdownThreads
+ * -------------------------
+ * Stops and joins every pool thread and releases the deques. Parallel functions called
+ * afterwards start a fresh pool. Must not be called while a parallel function is running.
+ */
+void shutdownThreads() {
+    pthread_mutex_lock(&arraysPoolLock);
+    int workers = arraysPool.workers;
+    arraysPool.shutdown = true;
+    pthread_cond_broadcast(&arraysPoolWake);
+    pthread_mutex_unlock(&arraysPoolLock);
+
+    for (int id = 1; id <= workers; ++id) {
+        pthread_join(arraysPool.threads[id], NULL);
+    }
+    for (int id = 0; id <= workers && workers > 0; ++id) {
+        free(arraysPool.queues[id].tasks);
+        arraysPool.queues[id].tasks = NULL;
+        arraysPool.queues[id].head = 0;
+        arraysPool.queues[id].count = 0;
+        arraysPool.queues[id].capacity = 0;
+        pthread_mutex_destroy(&arraysPool.queues[id].lock);
+    }
+    ARRAYS_ATOMIC_STORE(&arraysPool.workers, 0, ARRAYS_RELEASE);
+}
+
+#else
+
+static int poolEnsureThreads(int threads) {
+    (void)threads;
+    return 1;
+}
+
+static void poolSubmit(const struct arrays_task* task) {
+    struct arrays_task local = *task;
+    local.run(&local);
+}
+
+static void poolWait(struct arrays_task_group* group) {
+    (void)group;
+}
+
+void shutdownThreads() {
+}
+
+#endif
+
+/**
+ * @brief Number of threads a parallel function should use: `threads`, or one per online CPU if <= 0.
+ */
+static int resolveThreads(int threads) {
+#ifndef ARRAYS_NO_THREADS
+    if (threads <= 0)
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return threads;
+}
+
+/**
+ * Function: parallelSortTask
+ * --------------------------
+ * Pool task that sorts arr[low..high]. Ranges of at least the parallel grain are
+ * partitioned with pivotPartition and the resulting sub-partitions are queued as new tasks;
+ * smaller ranges, and ranges whose depth budget ran out, are sorted with dualPivotQuickSort.
+ */
+static void parallelSortTask(struct arrays_task* task) {
+    int* arr = (int*)task->context;
+    int low = (int)task->low;
+    int high = (int)task->high;
+    if (high - low < (ptrdiff_t)ARRAYS_ATOMIC_LOAD(&arraysParallelGrain, ARRAYS_RELAXED) || task->depth == 0) {
+        dualPivotQuickSort(arr, low, high);
+        return;
+    }
+
+    struct record Pivot;
+    choosePivots(arr, low, high);
+    pivotPartition(arr, low, high, &Pivot);
+
+    struct arrays_task child = *task;
+    child.depth = task->depth - 1;
+    child.low = low;
+    child.high = Pivot.left - 1;
+    poolSubmit(&child);
+    child.low = Pivot.right + 1;
+    child.high = high;
+    poolSubmit(&child);
+    if (arr[Pivot.left] != arr[Pivot.right]) {
+        struct sort_range middle;
+        middle.low = Pivot.left + 1;
+        middle.high = Pivot.right - 1;
+        if ((middle.high - middle.low) > (high - low) / 7 * 4) {
+            groupPivotEqualKeys(arr, &middle, arr[Pivot.left], arr[Pivot.right]);
+        }
+        child.low = middle.low;
+        child.high = middle.high;
+        poolSubmit(&child);
+    }
+}
+
+/**
+ * Function: parallelSort
+ * ----------------------
+ * Sorts arr[low..high] in ascending order using several threads. The range is split with
+ * pivotPartition; sub-partitions larger than the parallel grain are handed to the shared
+ * work-stealing pool and smaller ones are finished with dualPivotQuickSort. The result is
+ * identical to Arrays.sort.
+ *
+ * Parameters:
+ * - arr: The array to be sorted.
+ * - low: The starting index of the array or subarray.
+ * - high: The ending index of the array or subarray.
+ * - threads: Number of threads to use, including the caller. Values <= 0 use one thread per
+ *   online CPU. The pool keeps the largest size requested so far.
+ */
+void parallelSort(int* arr, int low, int high, int threads) {
+    if (arr == NULL || low >= high)
+        return;
+    threads = resolveThreads(threads);
+    if (threads <= 1 || high - low < (ptrdiff_t)ARRAYS_ATOMIC_LOAD(&arraysParallelGrain, ARRAYS_RELAXED) || poolEnsureThreads(threads) <= 1) {
+        dualPivotQuickSort(arr, low, high);
+        return;
+    }
+
+    struct arrays_task_group group = {0};
+    struct arrays_task task;
+    task.run = parallelSortTask;
+    task.group = &group;
+    task.context = arr;
+    task.low = low;
+    task.high = high;
+    task.depth = 0;
+    for (int n = high - low + 1; n > 1; n >>= 1) {
+        task.depth += 2;
+    }
+    poolSubmit(&task);
+    poolWait(&group);
+}
+
+
+/**
+ * Function: compareTwoArray
+ * Description: This function compares two integer arrays for equality.
+ * Parameters:
+ * - arr1: Pointer to the first integer array.
  * - size1: Size of the first array.
  * - arr2: Pointer to the second integer array.
  * - size2: Size of the second array.
  * Returns:
- * - bool: Returns true if the arrays are equal in size and content; otherwise, returns false.
+ * - bool: Returns true if the arrays are equal in size and content; otherwise, returns false.
+ *
+ * The contents are compared with memcmp, which is vectorized by the C library. Use
+ * Arrays.mismatch to find where two arrays differ and Arrays.compareOrder to order them.
+ */
+inline bool compareTwoArray(int* arr1, int size1, int* arr2, int size2){
+    if (size1!=size2)
+        return false;
+    return size1<=0 || memcmp(arr1, arr2, (size_t)size1*sizeof(int))==0;
+}
+
+
+/**
+ * Ints compared per memcmp call by the portable mismatch scan before it looks at single elements.
+ */
+#define ARRAYS_MISMATCH_BLOCK 64
+
+/**
+ * @brief Result of a mismatch scan given the first differing index of the common prefix (or -1).
+ */
+static inline int mismatchResult(int found, int size1, int size2) {
+    if (found >= 0)
+        return found;
+    return size1 == size2 ? -1 : (size1 < size2 ? size1 : size2);
+}
+
+/**
+ * Function: firstMismatch
+ * -----------------------
+ * Finds the first index at which two arrays differ. Equal blocks are skipped with memcmp, which
+ * runs at memory bandwidth; only the block holding the difference is scanned element by element.
+ *
+ * Parameters:
+ * - arr1: The first array.
+ * - size1: Size of the first array.
+ * - arr2: The second array.
+ * - size2: Size of the second array.
+ *
+ * Returns:
+ * The first index i with arr1[i] != arr2[i]; the length of the shorter array if it is a prefix
+ * of the longer one; -1 if the arrays are equal.
+ */
+inline int firstMismatch(const int* arr1, int size1, const int* arr2, int size2) {
+    int n = size1 < size2 ? size1 : size2;
+    int i = 0;
+    while (i + ARRAYS_MISMATCH_BLOCK <= n && memcmp(arr1 + i, arr2 + i, ARRAYS_MISMATCH_BLOCK * sizeof(int)) == 0)
+        i += ARRAYS_MISMATCH_BLOCK;
+    for (; i < n; ++i) {
+        if (arr1[i] != arr2[i])
+            return i;
+    }
+    return mismatchResult(-1, size1, size2);
+}
+
+/**
+ * Function: compareArrays
+ * -----------------------
+ * Compares two arrays lexicographically, element by element as signed ints; a proper prefix
+ * orders before the longer array.
+ *
+ * Returns:
+ * A negative value, zero or a positive value if arr1 orders before, equal to or after arr2.
+ */
+inline int compareArrays(const int* arr1, int size1, const int* arr2, int size2) {
+    int at = firstMismatch(arr1, size1, arr2, size2);
+    if (at < 0)
+        return 0;
+    if (at == size1 || at == size2)
+        return size1 < size2 ? -1 : 1;
+    return arr1[at] < arr2[at] ? -1 : 1;
+}
+
+/**
+ * Sorted set operations.
+ *
+ * mergeSorted, unionSorted, intersectSorted and differenceSorted combine two sorted arrays in
+ * one linear pass into a caller buffer. When one input is at least ARRAYS_GALLOP_RATIO times
+ * longer than the other, each element of the shorter one is located in the longer one by a
+ * galloping search (exponential steps, then the binary search of searchBIN), and the runs in
+ * between are copied in bulk, so the cost is O(m log(n/m)) comparisons. Intersection and
+ * difference of comparable sizes compare whole blocks of both inputs at a time with the SIMD
+ * kernel installed for the CPU.
+ *
+ * Duplicates follow one rule: an element "occurs" in an array if an equal value is present.
+ * intersectSorted keeps the elements of arr1 that occur in arr2, differenceSorted the elements
+ * of arr1 that do not, and unionSorted all of arr1 plus the elements of arr2 that do not occur
+ * in arr1. For inputs without duplicates these are the usual set operations.
+ */
+#ifndef ARRAYS_GALLOP_RATIO
+#define ARRAYS_GALLOP_RATIO 32
+#endif
+
+/**
+ * @brief Returns the first index in [from, n) whose element is not less than `sr` (or, when
+ * `inclusive`, greater than `sr`), probing from, from + 1, from + 3, from + 7, ... before
+ * the binary search.
+ */
+static inline int gallopBound(const int* arr, int from, int n, int sr, bool inclusive) {
+    int low = from;
+    int high = from;
+    long long step = 1;
+    while (high < n && (arr[high] < sr || (inclusive && arr[high] == sr))) {
+        low = high + 1;
+        high = step < (long long)n - from ? (int)(from + step) : n;
+        step = step * 2 + 1;
+    }
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (arr[mid] < sr || (inclusive && arr[mid] == sr))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/**
+ * @brief Copies up to `count` ints to dest + written without passing `capacity`.
+ * @return The new number of elements written.
+ */
+static inline int appendInts(int* dest, int written, int capacity, const int* src, int count) {
+    if (count > capacity - written)
+        count = capacity - written;
+    if (count > 0) {
+        copyInts(dest + written, src, (size_t)count);
+        written += count;
+    }
+    return written;
+}
+
+/**
+ * @brief Scalar intersection (keep) or difference (!keep) of arr1 against arr2, starting at
+ * arr1[i] and arr2[j] with `written` elements already in dest.
+ */
+static int filterSortedFrom(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity,
+                            bool keep, int i, int j, int written) {
+    for (; i < size1 && written < capacity; ++i) {
+        int value = arr1[i];
+        while (j < size2 && arr2[j] < value)
+            j++;
+        bool found = j < size2 && arr2[j] == value;
+        dest[written] = value;
+        written += (found == keep);
+    }
+    return written;
+}
+
+#if defined(ARRAYS_X86_SIMD) || defined(ARRAYS_NEON_SIMD)
+/**
+ * @brief Finishes a block kernel: the block of `width` elements at arr1[i] has already matched
+ * the elements flagged in `found`; its other elements and the rest of arr1 are checked
+ * against arr2[j..].
+ */
+static int filterSortedFinish(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity,
+                              bool keep, int i, int j, int written, unsigned int found, int width) {
+    if (found != 0) {
+        for (int t = 0; t < width && written < capacity; ++t) {
+            int value = arr1[i + t];
+            while (j < size2 && arr2[j] < value)
+                j++;
+            bool hit = ((found >> t) & 1u) || (j < size2 && arr2[j] == value);
+            dest[written] = value;
+            written += (hit == keep);
+        }
+        i += width;
+    }
+    return filterSortedFrom(arr1, size1, arr2, size2, dest, capacity, keep, i, j, written);
+}
+#endif
+
+static int filterSorted(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity, bool keep) {
+    return filterSortedFrom(arr1, size1, arr2, size2, dest, capacity, keep, 0, 0, 0);
+}
+
+/**
+ * Intersection/difference kernel for inputs of comparable size; useArrayFunctions() installs
+ * the best one for the CPU.
+ */
+static int (*arraysFilterSorted)(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity, bool keep) = filterSorted;
+
+/**
+ * @brief Galloping intersection (keep) or difference (!keep) when one input is much shorter.
+ */
+static int filterSortedGalloping(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity, bool keep) {
+    int written = 0;
+    if (size1 <= size2) {
+        int j = 0;
+        for (int i = 0; i < size1 && written < capacity; ++i) {
+            j = gallopBound(arr2, j, size2, arr1[i], false);
+            bool found = j < size2 && arr2[j] == arr1[i];
+            dest[written] = arr1[i];
+            written += (found == keep);
+        }
+        return written;
+    }
+    int i = 0;
+    for (int j = 0; j < size2 && i < size1 && written < capacity; ++j) {
+        if (j > 0 && arr2[j] == arr2[j - 1])
+            continue;
+        int first = gallopBound(arr1, i, size1, arr2[j], false);
+        int last = gallopBound(arr1, first, size1, arr2[j], true);
+        if (!keep)
+            written = appendInts(dest, written, capacity, arr1 + i, first - i);
+        else
+            written = appendInts(dest, written, capacity, arr1 + first, last - first);
+        i = last;
+    }
+    if (!keep)
+        written = appendInts(dest, written, capacity, arr1 + i, size1 - i);
+    return written;
+}
+
+/**
+ * @brief Reports whether one size is at least ARRAYS_GALLOP_RATIO times the other.
+ */
+static inline bool gallopingPays(int size1, int size2) {
+    return (long long)size1 * ARRAYS_GALLOP_RATIO <= size2 || (long long)size2 * ARRAYS_GALLOP_RATIO <= size1;
+}
+
+/**
+ * Function: mergeSorted
+ * ---------------------
+ * Merges two sorted arrays into one sorted array, keeping every element of both. Equal
+ * elements of arr1 come before those of arr2.
+ *
+ * Parameters:
+ * - arr1: The first sorted array.
+ * - size1: Size of the first array.
+ * - arr2: The second sorted array.
+ * - size2: Size of the second array.
+ * - dest: The destination buffer. Must not overlap either input.
+ * - capacity: The number of ints dest can hold; the result is truncated to it.
+ *
+ * Returns:
+ * The number of elements written.
+ */
+inline int mergeSorted(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity) {
+    size1 = size1 > 0 ? size1 : 0;
+    size2 = size2 > 0 ? size2 : 0;
+    int i = 0, j = 0, written = 0;
+    if (gallopingPays(size1, size2)) {
+        if (size1 <= size2) {
+            for (; i < size1 && written < capacity; ++i) {
+                int next = gallopBound(arr2, j, size2, arr1[i], false);
+                written = appendInts(dest, written, capacity, arr2 + j, next - j);
+                j = next;
+                written = appendInts(dest, written, capacity, arr1 + i, 1);
+            }
+        } else {
+            for (; j < size2 && written < capacity; ++j) {
+                int next = gallopBound(arr1, i, size1, arr2[j], true);
+                written = appendInts(dest, written, capacity, arr1 + i, next - i);
+                i = next;
+                written = appendInts(dest, written, capacity, arr2 + j, 1);
+            }
+        }
+    } else {
+        while (i < size1 && j < size2 && written < capacity) {
+            int x = arr1[i], y = arr2[j];
+            bool second = y < x;
+            dest[written++] = second ? y : x;
+            j += second;
+            i += !second;
+        }
+    }
+    written = appendInts(dest, written, capacity, arr1 + i, size1 - i);
+    return appendInts(dest, written, capacity, arr2 + j, size2 - j);
+}
+
+/**
+ * Function: unionSorted
+ * ---------------------
+ * Writes the sorted union of two sorted arrays: every element of arr1, and the elements of arr2
+ * that do not occur in arr1.
+ *
+ * Parameters:
+ * - arr1, size1, arr2, size2: The sorted inputs.
+ * - dest: The destination buffer. Must not overlap either input.
+ * - capacity: The number of ints dest can hold; the result is truncated to it.
+ *
+ * Returns:
+ * The number of elements written.
+ */
+inline int unionSorted(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity) {
+    size1 = size1 > 0 ? size1 : 0;
+    size2 = size2 > 0 ? size2 : 0;
+    int i = 0, j = 0, written = 0;
+    if (gallopingPays(size1, size2)) {
+        if (size1 <= size2) {
+            for (; i < size1 && written < capacity; ++i) {
+                int next = gallopBound(arr2, j, size2, arr1[i], false);
+                written = appendInts(dest, written, capacity, arr2 + j, next - j);
+                j = gallopBound(arr2, next, size2, arr1[i], true);
+                written = appendInts(dest, written, capacity, arr1 + i, 1);
+            }
+        } else {
+            for (; j < size2 && written < capacity; ++j) {
+                int next = gallopBound(arr1, i, size1, arr2[j], false);
+                written = appendInts(dest, written, capacity, arr1 + i, next - i);
+                i = next;
+                if (i >= size1 || arr1[i] != arr2[j])
+                    written = appendInts(dest, written, capacity, arr2 + j, 1);
+            }
+        }
+    } else {
+        while (i < size1 && j < size2 && written < capacity) {
+            int x = arr1[i], y = arr2[j];
+            if (y < x) {
+                dest[written++] = y;
+                j++;
+                continue;
+            }
+            while (j < size2 && arr2[j] == x)
+                j++;
+            dest[written++] = x;
+            i++;
+        }
+    }
+    written = appendInts(dest, written, capacity, arr1 + i, size1 - i);
+    return appendInts(dest, written, capacity, arr2 + j, size2 - j);
+}
+
+/**
+ * Function: intersectSorted
+ * -------------------------
+ * Writes the elements of sorted arr1 that occur in sorted arr2, in order.
+ *
+ * Parameters:
+ * - arr1, size1, arr2, size2: The sorted inputs.
+ * - dest: The destination buffer. Must not overlap either input.
+ * - capacity: The number of ints dest can hold; the result is truncated to it.
+ *
+ * Returns:
+ * The number of elements written.
+ */
+inline int intersectSorted(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity) {
+    if (size1 <= 0 || size2 <= 0 || capacity <= 0)
+        return 0;
+    if (gallopingPays(size1, size2))
+        return filterSortedGalloping(arr1, size1, arr2, size2, dest, capacity, true);
+    return arraysFilterSorted(arr1, size1, arr2, size2, dest, capacity, true);
+}
+
+/**
+ * Function: differenceSorted
+ * --------------------------
+ * Writes the elements of sorted arr1 that do not occur in sorted arr2, in order.
+ *
+ * Parameters:
+ * - arr1, size1, arr2, size2: The sorted inputs.
+ * - dest: The destination buffer. Must not overlap either input.
+ * - capacity: The number of ints dest can hold; the result is truncated to it.
+ *
+ * Returns:
+ * The number of elements written.
+ */
+inline int differenceSorted(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity) {
+    if (size1 <= 0 || capacity <= 0)
+        return 0;
+    if (size2 <= 0)
+        return appendInts(dest, 0, capacity, arr1, size1);
+    if (gallopingPays(size1, size2))
+        return filterSortedGalloping(arr1, size1, arr2, size2, dest, capacity, false);
+    return arraysFilterSorted(arr1, size1, arr2, size2, dest, capacity, false);
+}
+
+/**
+ * Adaptive sort.
+ *
+ * adaptiveSort, installed as Arrays.sort, first scans the range for runs (TimSort-style):
+ * non-decreasing runs are kept as they are and strictly decreasing runs are reversed in place.
+ * Runs shorter than ARRAYS_MIN_RUN are pooled with their neighbours into gaps, which are sorted
+ * with dualPivotQuickSort, and then all pieces are merged pairwise. Sorted and reversed input
+ * costs one pass, and sorted input with a few unsorted stretches about O(n) plus the cost of
+ * sorting the stretches.
+ *
+ * The scan gives up, and the whole range goes to dualPivotQuickSort, as soon as more than an
+ * eighth of the elements are outside long runs or the range splits into more than
+ * ARRAYS_ADAPTIVE_MAX_RUNS pieces; on random input that happens after a short prefix.
+ * Define ARRAYS_NO_ADAPTIVE_SORT to install dualPivotQuickSort as Arrays.sort instead.
+ */
+#ifndef ARRAYS_MIN_RUN
+#define ARRAYS_MIN_RUN 64
+#endif
+
+#ifndef ARRAYS_ADAPTIVE_MAX_RUNS
+#define ARRAYS_ADAPTIVE_MAX_RUNS 64
+#endif
+
+/**
+ * Function: mergeAdjacentRuns
+ * ---------------------------
+ * Merges the sorted ranges arr[low..mid-1] and arr[mid..high-1]. The prefix of the left run
+ * that is not greater than arr[mid] and the suffix of the right run that is not smaller than
+ * arr[mid-1] are found by galloping and left in place; only the shorter of the remaining two
+ * parts is copied to the buffer, and the merge runs forward or backward accordingly.
+ *
+ * Parameters:
+ * - buffer, capacity: The merge buffer, grown with realloc when needed.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the buffer could not be grown (the ranges are left untouched).
+ */
+static status_code mergeAdjacentRuns(int* arr, int low, int mid, int high, int** buffer, int* capacity) {
+    low = gallopBound(arr, low, mid, arr[mid], true);
+    high = gallopBound(arr, mid, high, arr[mid - 1], false);
+    if (low == mid || high == mid)
+        return SUCCESS;
+    int leftLength = mid - low, rightLength = high - mid;
+    int need = leftLength < rightLength ? leftLength : rightLength;
+    if (need > *capacity) {
+        int* grown = (int*)realloc(*buffer, (size_t)need * sizeof(int));
+        if (grown == NULL)
+            return FAILURE;
+        *buffer = grown;
+        *capacity = need;
+    }
+    int* temp = *buffer;
+    if (leftLength <= rightLength) {
+        copyInts(temp, arr + low, (size_t)leftLength);
+        int a = 0, b = mid, out = low;
+        while (a < leftLength && b < high) {
+            bool right = arr[b] < temp[a];
+            arr[out++] = right ? arr[b] : temp[a];
+            b += right;
+            a += !right;
+        }
+        copyInts(arr + out, temp + a, (size_t)(leftLength - a));
+    } else {
+        copyInts(temp, arr + mid, (size_t)rightLength);
+        int a = mid - 1, b = rightLength - 1, out = high - 1;
+        while (a >= low && b >= 0) {
+            bool left = arr[a] > temp[b];
+            arr[out--] = left ? arr[a] : temp[b];
+            a -= left;
+            b -= !left;
+        }
+        copyInts(arr + low, temp, (size_t)(b + 1));
+    }
+    return SUCCESS;
+}
+
+/**
+ * Function: adaptiveSort
+ * ----------------------
+ * Sorts an array, taking advantage of the ascending and descending runs it already contains;
+ * falls back to dualPivotQuickSort when there are too few of them (see above).
+ *
+ * Parameters:
+ * - arr: The array to be sorted.
+ * - low: The starting index of the array or subarray.
+ * - high: The ending index of the array or subarray.
+ */
+inline void adaptiveSort(int* arr, int low, int high) {
+    if (arr == NULL || low >= high)
+        return;
+    int n = high - low + 1;
+    if (n < 2 * ARRAYS_MIN_RUN) {
+        dualPivotQuickSort(arr, low, high);
+        return;
+    }
+    /* starts[p] is the first index of piece p; gaps (pieces to sort) are flagged. */
+    int starts[ARRAYS_ADAPTIVE_MAX_RUNS + 1];
+    bool gaps[ARRAYS_ADAPTIVE_MAX_RUNS];
+    int pieces = 0, outside = 0;
+    bool inGap = false;
+    for (int i = low; i <= high;) {
+        int j = i;
+        if (j < high && arr[j + 1] < arr[j]) {
+            while (j < high && arr[j + 1] < arr[j])
+                j++;
+            if (j - i + 1 >= ARRAYS_MIN_RUN)
+                reverse(arr + i, j - i + 1);
+        } else {
+            while (j < high && arr[j + 1] >= arr[j])
+                j++;
+        }
+        int length = j - i + 1;
+        if (length >= ARRAYS_MIN_RUN || !inGap) {
+            if (pieces == ARRAYS_ADAPTIVE_MAX_RUNS) {
+                dualPivotQuickSort(arr, low, high);
+                return;
+            }
+            inGap = length < ARRAYS_MIN_RUN;
+            gaps[pieces] = inGap;
+            starts[pieces++] = i;
+        }
+        if (length < ARRAYS_MIN_RUN && (outside += length) > n / 8) {
+            dualPivotQuickSort(arr, low, high);
+            return;
+        }
+        i = j + 1;
+    }
+    starts[pieces] = high + 1;
+    for (int p = 0; p < pieces; ++p) {
+        if (gaps[p])
+            dualPivotQuickSort(arr, starts[p], starts[p + 1] - 1);
+    }
+    int* buffer = NULL;
+    int capacity = 0;
+    while (pieces > 1) {
+        int merged = 0;
+        for (int p = 0; p < pieces; p += 2) {
+            if (p + 1 < pieces && mergeAdjacentRuns(arr, starts[p], starts[p + 1], starts[p + 2], &buffer, &capacity) != SUCCESS) {
+                free(buffer);
+                introSort(arr, low, high);
+                return;
+            }
+            starts[merged++] = starts[p];
+        }
+        starts[merged] = high + 1;
+        pieces = merged;
+    }
+    free(buffer);
+}
+
+/**
+ * Sorting by index.
+ *
+ * argsort and stableSort pack each element with a 32-bit companion (its index, or its payload
+ * value) into one 64-bit word, value in the high half, and sort the words with an LSD radix sort
+ * over the high half only. LSD radix sorting is stable, so equal values keep their input order,
+ * and the companion travels with its value in the same cache line instead of being permuted in
+ * a second pass. applyPermutation gathers a column through the resulting indices.
+ */
+
+/**
+ * @brief Packs a value and its 32-bit companion so that the unsigned order of the high half is
+ * the signed order of the value.
+ */
+static inline uint64_t packPair(int value, int companion) {
+    return ((uint64_t)((unsigned int)value ^ 0x80000000u) << 32) | (unsigned int)companion;
+}
+
+static inline int pairValue(uint64_t pair) {
+    return (int)((unsigned int)(pair >> 32) ^ 0x80000000u);
+}
+
+/**
+ * Function: sortPackedPairs
+ * -------------------------
+ * Stable sort of packed pairs by their high halves: insertion sort for short arrays, otherwise
+ * four 8-bit LSD radix passes (passes where every word has the same digit are skipped).
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the scratch buffer could not be allocated (pairs are unchanged).
+ */
+static status_code sortPackedPairs(uint64_t* pairs, size_t n) {
+    if (n < ARRAYS_INSERTION_SORT_THRESHOLD) {
+        for (size_t i = 1; i < n; ++i) {
+            uint64_t pair = pairs[i];
+            size_t j = i;
+            while (j > 0 && (pairs[j - 1] >> 32) > (pair >> 32)) {
+                pairs[j] = pairs[j - 1];
+                j--;
+            }
+            pairs[j] = pair;
+        }
+        return SUCCESS;
+    }
+    uint64_t* buffer = (uint64_t*)malloc(n * sizeof(uint64_t));
+    if (buffer == NULL)
+        return FAILURE;
+    size_t counts[4][256];
+    memset(counts, 0, sizeof(counts));
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t key = (uint32_t)(pairs[i] >> 32);
+        counts[0][key & 0xFF]++;
+        counts[1][(key >> 8) & 0xFF]++;
+        counts[2][(key >> 16) & 0xFF]++;
+        counts[3][key >> 24]++;
+    }
+    uint64_t* from = pairs;
+    uint64_t* to = buffer;
+    for (int d = 0; d < 4; ++d) {
+        int shift = 32 + 8 * d;
+        size_t* count = counts[d];
+        if (count[(from[0] >> shift) & 0xFF] == n)
+            continue;
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit) {
+            size_t c = count[digit];
+            count[digit] = offset;
+            offset += c;
+        }
+        for (size_t i = 0; i < n; ++i)
+            to[count[(from[i] >> shift) & 0xFF]++] = from[i];
+        uint64_t* temp = from;
+        from = to;
+        to = temp;
+    }
+    if (from != pairs)
+        memcpy(pairs, from, n * sizeof(uint64_t));
+    free(buffer);
+    return SUCCESS;
+}
+
+/**
+ * Function: argsort
+ * -----------------
+ * Computes the permutation that sorts an array, without moving its elements: afterwards
+ * arr[indices[0]] <= arr[indices[1]] <= ... Equal elements appear in increasing index order.
+ *
+ * Parameters:
+ * - arr: The array to be ordered.
+ * - n: The size of the array.
+ * - indices: Receives n indices into arr.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the working memory could not be allocated.
+ */
+inline status_code argsort(const int* arr, int n, int* indices) {
+    if (n <= 0)
+        return SUCCESS;
+    uint64_t* pairs = (uint64_t*)malloc((size_t)n * sizeof(uint64_t));
+    if (pairs == NULL)
+        return FAILURE;
+    for (int i = 0; i < n; ++i)
+        pairs[i] = packPair(arr[i], i);
+    status_code status = sortPackedPairs(pairs, (size_t)n);
+    if (status == SUCCESS) {
+        for (int i = 0; i < n; ++i)
+            indices[i] = (int)(uint32_t)pairs[i];
+    }
+    free(pairs);
+    return status;
+}
+
+/**
+ * Function: stableSort
+ * --------------------
+ * Sorts an array in ascending order, keeping equal elements in their input order, and reorders
+ * an optional parallel column the same way (for example the row ids of a key column).
+ *
+ * Parameters:
+ * - arr: The array to be sorted.
+ * - n: The size of the array.
+ * - payload: A second array of n ints permuted along with arr, or NULL.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the working memory could not be allocated (both arrays are unchanged).
+ */
+inline status_code stableSort(int* arr, int n, int* payload) {
+    if (n <= 1)
+        return SUCCESS;
+    if (payload == NULL) {
+        dualPivotQuickSort(arr, 0, n - 1);
+        return SUCCESS;
+    }
+    uint64_t* pairs = (uint64_t*)malloc((size_t)n * sizeof(uint64_t));
+    if (pairs == NULL)
+        return FAILURE;
+    for (int i = 0; i < n; ++i)
+        pairs[i] = packPair(arr[i], payload[i]);
+    status_code status = sortPackedPairs(pairs, (size_t)n);
+    if (status == SUCCESS) {
+        for (int i = 0; i < n; ++i) {
+            arr[i] = pairValue(pairs[i]);
+            payload[i] = (int)(uint32_t)pairs[i];
+        }
+    }
+    free(pairs);
+    return status;
+}
+
+/**
+ * Function: applyPermutation
+ * --------------------------
+ * Gathers src through a permutation: dest[i] = src[indices[i]], for example to reorder a
+ * parallel column by the result of argsort.
+ *
+ * Parameters:
+ * - src: The array to read.
+ * - indices: n indices into src.
+ * - n: The number of elements to gather.
+ * - dest: Receives n elements. Must not overlap src.
+ */
+inline void applyPermutation(const int* src, const int* indices, int n, int* dest) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int a = src[indices[i]], b = src[indices[i + 1]];
+        int c = src[indices[i + 2]], d = src[indices[i + 3]];
+        dest[i] = a;
+        dest[i + 1] = b;
+        dest[i + 2] = c;
+        dest[i + 3] = d;
+    }
+    for (; i < n; ++i)
+        dest[i] = src[indices[i]];
+}
+
+
+/**
+ * Frequency analysis.
+ *
+ * histogram counts values into equal-width buckets; with one bucket per value it is an exact
+ * counting pass. mode and countDistinct count every value: through a counting array when the
+ * value range is small, through an open-addressing table that starts cache-resident and
+ * doubles at half load otherwise, and by radix-sorting a copy and scanning its runs when the
+ * table would outgrow ARRAYS_FREQUENCY_TABLE_LIMIT slots.
+ */
+
+/**
+ * Value ranges (max - min + 1) up to this size, or up to the number of elements, are counted
+ * with a counting array. Define before including this header to override.
+ */
+#ifndef ARRAYS_COUNTING_RANGE
+#define ARRAYS_COUNTING_RANGE 65536
+#endif
+
+/**
+ * Initial and largest number of slots of the frequency table. Define before including this
+ * header to override; both must be powers of two.
+ */
+#ifndef ARRAYS_FREQUENCY_TABLE
+#define ARRAYS_FREQUENCY_TABLE 4096
+#endif
+#ifndef ARRAYS_FREQUENCY_TABLE_LIMIT
+#define ARRAYS_FREQUENCY_TABLE_LIMIT ((size_t)1 << 22)
+#endif
+
+/**
+ * Histograms with at most this many buckets are counted into four interleaved copies, so
+ * consecutive equal values do not wait on the same counter.
+ */
+#define ARRAYS_HISTOGRAM_COPY_LIMIT 1024
+
+struct histogram_spec {
+    uint32_t low;
+    uint64_t width;
+    uint32_t buckets;
+    int shift;
+    double scale;
+};
+
+/**
+ * @brief Prepares the bucket mapping of [low, high] onto `buckets` equal-width buckets: a shift
+ * when every bucket spans the same power of two, a scaled multiply otherwise.
+ */
+static bool histogramSpec(struct histogram_spec* spec, int low, int high, int buckets) {
+    if (buckets <= 0 || low > high)
+        return false;
+    spec->low = (uint32_t)low;
+    spec->width = (uint64_t)((int64_t)high - low) + 1;
+    spec->buckets = (uint32_t)buckets;
+    spec->scale = (double)buckets / (double)spec->width;
+    spec->shift = -1;
+    if (spec->width % spec->buckets == 0) {
+        uint64_t span = spec->width / spec->buckets;
+        if ((span & (span - 1)) == 0) {
+            spec->shift = 0;
+            while (((uint64_t)1 << spec->shift) < span)
+                spec->shift++;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Bucket of a value, or spec->buckets when it lies outside the range. The scaled
+ * estimate is off by at most one and is corrected with exact integer arithmetic.
+ */
+static inline uint32_t histogramIndex(const struct histogram_spec* spec, int x) {
+    uint32_t d = (uint32_t)x - spec->low;
+    if ((uint64_t)d >= spec->width)
+        return spec->buckets;
+    if (spec->shift >= 0)
+        return (uint32_t)((uint64_t)d >> spec->shift);
+    uint64_t scaled = (uint64_t)d * spec->buckets;
+    uint64_t b = (uint64_t)(d * spec->scale);
+    if (b * spec->width > scaled)
+        b--;
+    else if ((b + 1) * spec->width <= scaled)
+        b++;
+    return (uint32_t)b;
+}
+
+/**
+ * @brief Adds the bucket counts of n (at most UINT32_MAX) elements to counts and returns how
+ * many elements fell inside the range.
+ */
+static size_t histogramScan(const int* arr, size_t n, const struct histogram_spec* spec, uint32_t* counts) {
+    uint32_t buckets = spec->buckets;
+    if (buckets > ARRAYS_HISTOGRAM_COPY_LIMIT || n < 4 * (size_t)buckets) {
+        size_t counted = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t b = histogramIndex(spec, arr[i]);
+            if (b < buckets) {
+                counts[b]++;
+                counted++;
+            }
+        }
+        return counted;
+    }
+
+    uint32_t copies[4][ARRAYS_HISTOGRAM_COPY_LIMIT + 1];
+    memset(copies, 0, sizeof(copies));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        copies[0][histogramIndex(spec, arr[i])]++;
+        copies[1][histogramIndex(spec, arr[i + 1])]++;
+        copies[2][histogramIndex(spec, arr[i + 2])]++;
+        copies[3][histogramIndex(spec, arr[i + 3])]++;
+    }
+    for (; i < n; ++i)
+        copies[0][histogramIndex(spec, arr[i])]++;
+    size_t counted = 0;
+    for (uint32_t b = 0; b < buckets; ++b) {
+        uint32_t c = copies[0][b] + copies[1][b] + copies[2][b] + copies[3][b];
+        counts[b] += c;
+        counted += c;
+    }
+    return counted;
+}
+
+/**
+ * Function: histogram
+ * -------------------
+ * Counts the elements into equal-width buckets over [low, high]: element x goes to bucket
+ * (x - low) * buckets / (high - low + 1), rounded down. With buckets == high - low + 1 every
+ * value gets its own bucket.
+ *
+ * Parameters:
+ * - arr: The array to be processed.
+ * - n: The size of the array.
+ * - low, high: The value range, inclusive. Elements outside it are not counted.
+ * - buckets: The number of buckets.
+ * - counts: Receives `buckets` counts.
+ *
+ * Returns:
+ * The number of elements counted, or -1 if low > high or buckets <= 0.
+ */
+inline int histogram(const int* arr, int n, int low, int high, int buckets, int* counts) {
+    struct histogram_spec spec;
+    if (!histogramSpec(&spec, low, high, buckets))
+        return -1;
+    memset(counts, 0, (size_t)buckets * sizeof(int));
+    if (n <= 0)
+        return 0;
+    return (int)histogramScan(arr, (size_t)n, &spec, (uint32_t*)counts);
+}
+
+struct frequency_summary {
+    int mode;
+    size_t modeCount;
+    size_t distinct;
+};
+
+/**
+ * @brief Summarizes the counts of the consecutive values first, first + 1, ...
+ */
+static void frequencyFromCounts(const uint32_t* counts, size_t range, int first, struct frequency_summary* out) {
+    for (size_t i = 0; i < range; ++i) {
+        if (counts[i] == 0)
+            continue;
+        out->distinct++;
+        if (counts[i] > out->modeCount) {
+            out->modeCount = counts[i];
+            out->mode = (int)((uint32_t)first + (uint32_t)i);
+        }
+    }
+}
+
+struct frequency_slot {
+    int key;
+    uint32_t count;
+};
+
+static inline size_t frequencySlot(int key, int bits) {
+    return (size_t)(((uint32_t)key * 0x9E3779B1u) >> (32 - bits));
+}
+
+/**
+ * @brief Counts the values with the frequency table. Returns false, with nothing summarized,
+ * when the table would outgrow ARRAYS_FREQUENCY_TABLE_LIMIT, when it must grow while most of
+ * the first eighth or more of the elements were distinct (sorting is faster then), or when memory ran out.
+ */
+static bool frequencyFromTable(const int* arr, size_t n, struct frequency_summary* out) {
+    int bits = 4;
+    while (((size_t)1 << bits) < ARRAYS_FREQUENCY_TABLE && ((size_t)1 << bits) < 2 * n)
+        bits++;
+    size_t capacity = (size_t)1 << bits;
+    struct frequency_slot* table = (struct frequency_slot*)calloc(capacity, sizeof(struct frequency_slot));
+    if (table == NULL)
+        return false;
+
+    size_t used = 0;
+    for (size_t i = 0; i < n; ++i) {
+        int x = arr[i];
+        size_t mask = capacity - 1;
+        size_t at = frequencySlot(x, bits);
+        while (table[at].count != 0 && table[at].key != x)
+            at = (at + 1) & mask;
+        if (table[at].count == 0) {
+            if (2 * (used + 1) > capacity) {
+                bool mostlyDistinct = 4 * used > 3 * i && 8 * i >= n;
+                if (2 * capacity > ARRAYS_FREQUENCY_TABLE_LIMIT || mostlyDistinct) {
+                    free(table);
+                    return false;
+                }
+                struct frequency_slot* grown = (struct frequency_slot*)calloc(2 * capacity, sizeof(struct frequency_slot));
+                if (grown == NULL) {
+                    free(table);
+                    return false;
+                }
+                bits++;
+                mask = 2 * capacity - 1;
+                for (size_t j = 0; j < capacity; ++j) {
+                    if (table[j].count == 0)
+                        continue;
+                    size_t to = frequencySlot(table[j].key, bits);
+                    while (grown[to].count != 0)
+                        to = (to + 1) & mask;
+                    grown[to] = table[j];
+                }
+                free(table);
+                table = grown;
+                capacity *= 2;
+                at = frequencySlot(x, bits);
+                while (table[at].count != 0)
+                    at = (at + 1) & mask;
+            }
+            table[at].key = x;
+            used++;
+        }
+        table[at].count++;
+    }
+
+    out->distinct = used;
+    for (size_t j = 0; j < capacity; ++j) {
+        uint32_t c = table[j].count;
+        if (c > out->modeCount || (c != 0 && c == out->modeCount && table[j].key < out->mode)) {
+            out->modeCount = c;
+            out->mode = table[j].key;
+        }
+    }
+    free(table);
+    return true;
+}
+
+/**
+ * @brief Counts every value of arr: the most frequent one (the smallest on ties), how often it
+ * occurs, and the number of distinct values. FAILURE when memory ran out.
+ */
+static status_code frequencySummary(const int* arr, int n, struct frequency_summary* out) {
+    out->mode = 0;
+    out->modeCount = 0;
+    out->distinct = 0;
+    if (arr == NULL || n <= 0)
+        return SUCCESS;
+
+    int minimum, maximum;
+    Arrays.minMax(arr, n, &minimum, &maximum);
+    uint64_t range = (uint64_t)((int64_t)maximum - minimum) + 1;
+    if (range <= ARRAYS_COUNTING_RANGE || range <= (uint64_t)n) {
+        uint32_t* counts = (uint32_t*)calloc((size_t)range, sizeof(uint32_t));
+        if (counts != NULL) {
+            struct histogram_spec spec;
+            histogramSpec(&spec, minimum, maximum, (int)range);
+            histogramScan(arr, (size_t)n, &spec, counts);
+            frequencyFromCounts(counts, (size_t)range, minimum, out);
+            free(counts);
+            return SUCCESS;
+        }
+    }
+    if (frequencyFromTable(arr, (size_t)n, out))
+        return SUCCESS;
+
+    int* sorted = (int*)malloc((size_t)n * sizeof(int));
+    if (sorted == NULL)
+        return FAILURE;
+    memcpy(sorted, arr, (size_t)n * sizeof(int));
+    if (radixSortKeys((unsigned int*)sorted, (size_t)n, NULL) != SUCCESS) {
+        free(sorted);
+        return FAILURE;
+    }
+    for (int i = 0; i < n;) {
+        int j = i + 1;
+        while (j < n && sorted[j] == sorted[i])
+            j++;
+        out->distinct++;
+        if ((size_t)(j - i) > out->modeCount) {
+            out->modeCount = (size_t)(j - i);
+            out->mode = sorted[i];
+        }
+        i = j;
+    }
+    free(sorted);
+    return SUCCESS;
+}
+
+/**
+ * Function: modeOf
+ * ----------------
+ * Finds the value that occurs most often in the array; on ties, the smallest such value.
+ *
+ * Parameters:
+ * - arr: The array to be processed.
+ * - n: The size of the array.
+ * - count: When not NULL, receives the number of occurrences of the mode: 0 for an empty array,
+ *   -1 if memory ran out.
+ *
+ * Returns:
+ * The mode, or 0 for an empty array.
+ */
+inline int modeOf(const int* arr, int n, int* count) {
+    struct frequency_summary summary;
+    status_code status = frequencySummary(arr, n, &summary);
+    if (count != NULL)
+        *count = status == SUCCESS ? (int)summary.modeCount : -1;
+    return summary.mode;
+}
+
+/**
+ * Function: countDistinct
+ * -----------------------
+ * Counts the distinct values in the array.
+ *
+ * Returns:
+ * The number of distinct values, or -1 if memory ran out.
+ */
+inline int countDistinct(const int* arr, int n) {
+    struct frequency_summary summary;
+    if (frequencySummary(arr, n, &summary) != SUCCESS)
+        return -1;
+    return (int)summary.distinct;
+}
+
+
+/**
+ * Views and pipelines.
+ *
+ * An array_view describes a sub-range, a stride, a rotation and a direction over an existing
+ * array without copying it, so chains of copyOfRange, reverse and rotate cost nothing until
+ * the elements are read. A pipeline reads a view once in blocks of ARRAYS_PIPELINE_BLOCK
+ * elements that stay in L1 while every stage runs over them.
+ */
+
+/**
+ * Elements a pipeline reads from its view at a time. Define before including this header to
+ * override.
+ */
+#ifndef ARRAYS_PIPELINE_BLOCK
+#define ARRAYS_PIPELINE_BLOCK 1024
+#endif
+
+/**
+ * Function: arrayView
+ * -------------------
+ * Returns a view of all n elements of an array.
+ */
+inline array_view arrayView(const int* arr, int n) {
+    array_view v;
+    v.data = arr;
+    v.length = n > 0 ? n : 0;
+    v.stride = 1;
+    v.offset = 0;
+    v.period = v.length;
+    v.reversed = false;
+    return v;
+}
+
+/**
+ * Function: stridedView
+ * ---------------------
+ * Returns a view of n elements `stride` ints apart: arr[0], arr[stride], ..., for example one
+ * column of a row-major matrix.
+ */
+inline array_view stridedView(const int* arr, int n, int stride) {
+    array_view v = arrayView(arr, n);
+    v.stride = stride;
+    return v;
+}
+
+/**
+ * @brief Rebases a view that does not wrap around its period, so that it starts at data.
+ */
+static void viewNormalize(array_view* v) {
+    if (v->offset + v->length <= v->period) {
+        v->data += (ptrdiff_t)v->offset * v->stride;
+        v->offset = 0;
+        v->period = v->length;
+    }
+}
+
+/**
+ * Function: viewRange
+ * -------------------
+ * Makes a view of the elements [start, end) of a view, like copyOfRange without the copy.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE (out untouched) if the range is outside the view.
+ */
+inline status_code viewRange(const array_view* v, int start, int end, array_view* out) {
+    if (start < 0 || end > v->length || start > end)
+        return FAILURE;
+    array_view r = *v;
+    int first = v->reversed ? v->length - end : start;
+    r.length = end - start;
+    r.offset = v->period > 0 ? (int)(((long long)v->offset + first) % v->period) : 0;
+    viewNormalize(&r);
+    *out = r;
+    return SUCCESS;
+}
+
+/**
+ * Function: viewReverse
+ * ---------------------
+ * Returns the view read back to front, like reverse without touching the elements.
+ */
+inline array_view viewReverse(const array_view* v) {
+    array_view r = *v;
+    r.reversed = !v->reversed;
+    return r;
+}
+
+/**
+ * Function: viewRotate
+ * --------------------
+ * Makes the view rotated to the right by k positions (to the left for negative k), like
+ * rotate without moving the elements.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE (out untouched) for a range of a rotated view that spans its rotation
+ * point, which a single view cannot rotate again.
+ */
+inline status_code viewRotate(const array_view* v, int k, array_view* out) {
+    array_view r = *v;
+    viewNormalize(&r);
+    if (r.length != r.period)
+        return FAILURE;
+    if (r.length > 0) {
+        long long shift = (long long)k % r.length;
+        long long offset = r.reversed ? r.offset + shift : r.offset - shift;
+        r.offset = (int)((offset % r.length + r.length) % r.length);
+    }
+    *out = r;
+    return SUCCESS;
+}
+
+/**
+ * Function: viewGet
+ * -----------------
+ * Returns element i of a view (0 <= i < length).
+ */
+inline int viewGet(const array_view* v, int i) {
+    int j = v->reversed ? v->length - 1 - i : i;
+    long long p = (long long)v->offset + j;
+    if (p >= v->period)
+        p -= v->period;
+    return v->data[(ptrdiff_t)p * v->stride];
+}
+
+/**
+ * @brief Copies count elements of a view, starting at element from, into dest: one run per
+ * stretch between wrap-arounds, with copyInts for contiguous forward runs.
+ */
+static void viewGather(const array_view* v, int from, int count, int* dest) {
+    int j = v->reversed ? v->length - 1 - from : from;
+    int p = (int)(((long long)v->offset + j) % v->period);
+    while (count > 0) {
+        int run;
+        if (!v->reversed) {
+            run = v->period - p < count ? v->period - p : count;
+            if (v->stride == 1) {
+                copyInts(dest, v->data + p, (size_t)run);
+            } else {
+                for (int k = 0; k < run; ++k)
+                    dest[k] = v->data[(ptrdiff_t)(p + k) * v->stride];
+            }
+            p = 0;
+        } else {
+            run = p + 1 < count ? p + 1 : count;
+            for (int k = 0; k < run; ++k)
+                dest[k] = v->data[(ptrdiff_t)(p - k) * v->stride];
+            p = v->period - 1;
+        }
+        dest += run;
+        count -= run;
+    }
+}
+
+/**
+ * Function: viewSum
+ * -----------------
+ * Returns the sum of the elements of a view, accumulated in 64 bits. The order of the elements
+ * does not matter, so a contiguous view is summed with Arrays.sum straight from its data, at
+ * most in two pieces, whatever its rotation and direction.
+ */
+inline long long viewSum(const array_view* v) {
+    if (v->length == 0)
+        return 0;
+    int first = v->period - v->offset < v->length ? v->period - v->offset : v->length;
+    if (v->stride == 1)
+        return Arrays.sum((int*)(v->data + v->offset), first) + Arrays.sum((int*)v->data, v->length - first);
+    long long sum = 0;
+    for (int k = 0; k < first; ++k)
+        sum += v->data[(ptrdiff_t)(v->offset + k) * v->stride];
+    for (int k = 0; k < v->length - first; ++k)
+        sum += v->data[(ptrdiff_t)k * v->stride];
+    return sum;
+}
+
+/**
+ * Function: viewCopy
+ * ------------------
+ * Copies the elements of a view, in view order, into dest (at least length ints).
+ *
+ * Returns:
+ * The number of elements written.
+ */
+inline int viewCopy(const array_view* v, int* dest) {
+    if (v->length > 0)
+        viewGather(v, 0, v->length, dest);
+    return v->length;
+}
+
+/**
+ * Function: pipelineInit
+ * ----------------------
+ * Starts a pipeline with no stages over a view.
+ */
+inline void pipelineInit(array_pipeline* p, const array_view* source) {
+    p->source = *source;
+    p->count = 0;
+}
+
+/**
+ * Function: pipelineFilter
+ * ------------------------
+ * Adds a stage that keeps only the values for which keep(value, context) is true.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the pipeline already has ARRAYS_PIPELINE_STAGES stages.
+ */
+inline status_code pipelineFilter(array_pipeline* p, bool (*keep)(int value, void* context), void* context) {
+    if (p->count >= ARRAYS_PIPELINE_STAGES)
+        return FAILURE;
+    p->stages[p->count].filter = keep;
+    p->stages[p->count].map = NULL;
+    p->stages[p->count].context = context;
+    p->count++;
+    return SUCCESS;
+}
+
+/**
+ * Function: pipelineMap
+ * ---------------------
+ * Adds a stage that replaces every value with map(value, context).
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the pipeline already has ARRAYS_PIPELINE_STAGES stages.
+ */
+inline status_code pipelineMap(array_pipeline* p, int (*map)(int value, void* context), void* context) {
+    if (p->count >= ARRAYS_PIPELINE_STAGES)
+        return FAILURE;
+    p->stages[p->count].filter = NULL;
+    p->stages[p->count].map = map;
+    p->stages[p->count].context = context;
+    p->count++;
+    return SUCCESS;
+}
+
+/**
+ * @brief Reads the next block of the view from element `from` and runs every stage over it,
+ * compacting the survivors of each filter. Returns the number of values left in block.
+ */
+static int pipelineBlock(const array_pipeline* p, int from, int* block) {
+    int count = p->source.length - from < ARRAYS_PIPELINE_BLOCK ? p->source.length - from : ARRAYS_PIPELINE_BLOCK;
+    viewGather(&p->source, from, count, block);
+    for (int s = 0; s < p->count && count > 0; ++s) {
+        void* context = p->stages[s].context;
+        if (p->stages[s].map != NULL) {
+            int (*map)(int, void*) = p->stages[s].map;
+            for (int k = 0; k < count; ++k)
+                block[k] = map(block[k], context);
+        } else {
+            bool (*keep)(int, void*) = p->stages[s].filter;
+            int kept = 0;
+            for (int k = 0; k < count; ++k) {
+                int value = block[k];
+                block[kept] = value;
+                kept += keep(value, context) ? 1 : 0;
+            }
+            count = kept;
+        }
+    }
+    return count;
+}
+
+/**
+ * Function: pipelineReduce
+ * ------------------------
+ * Runs the pipeline and folds the values that come out of it: acc = reduce(acc, value, context),
+ * in view order, starting from `initial`.
+ */
+inline long long pipelineReduce(const array_pipeline* p, long long initial, long long (*reduce)(long long acc, int value, void* context), void* context) {
+    int block[ARRAYS_PIPELINE_BLOCK];
+    long long acc = initial;
+    for (int from = 0; from < p->source.length; from += ARRAYS_PIPELINE_BLOCK) {
+        int count = pipelineBlock(p, from, block);
+        for (int k = 0; k < count; ++k)
+            acc = reduce(acc, block[k], context);
+    }
+    return acc;
+}
+
+/**
+ * Function: pipelineSum
+ * ---------------------
+ * Runs the pipeline and returns the sum of its output, accumulated in 64 bits. Each block is
+ * summed with Arrays.sum; a pipeline without stages is summed straight from the view.
+ */
+inline long long pipelineSum(const array_pipeline* p) {
+    if (p->count == 0)
+        return viewSum(&p->source);
+    int block[ARRAYS_PIPELINE_BLOCK];
+    long long sum = 0;
+    for (int from = 0; from < p->source.length; from += ARRAYS_PIPELINE_BLOCK) {
+        int count = pipelineBlock(p, from, block);
+        sum += Arrays.sum(block, count);
+    }
+    return sum;
+}
+
+/**
+ * Function: pipelineCount
+ * -----------------------
+ * Runs the pipeline and returns the number of values that come out of it.
+ */
+inline int pipelineCount(const array_pipeline* p) {
+    int block[ARRAYS_PIPELINE_BLOCK];
+    int total = 0;
+    for (int from = 0; from < p->source.length; from += ARRAYS_PIPELINE_BLOCK)
+        total += pipelineBlock(p, from, block);
+    return total;
+}
+
+/**
+ * Function: pipelineCollect
+ * -------------------------
+ * Runs the pipeline and writes its output, in view order, into dest.
+ *
+ * Parameters:
+ * - p: The pipeline.
+ * - dest: The destination buffer.
+ * - capacity: The number of ints dest can hold; the output is truncated to it.
+ *
+ * Returns:
+ * The number of elements written.
+ */
+inline int pipelineCollect(const array_pipeline* p, int* dest, int capacity) {
+    int block[ARRAYS_PIPELINE_BLOCK];
+    int written = 0;
+    for (int from = 0; from < p->source.length && written < capacity; from += ARRAYS_PIPELINE_BLOCK) {
+        int count = pipelineBlock(p, from, block);
+        if (count > capacity - written)
+            count = capacity - written;
+        copyInts(dest + written, block, (size_t)count);
+        written += count;
+    }
+    return written;
+}
+
+
+/**
+ * Managed handles.
+ *
+ * An array_handle remembers what it has learned about its elements, so repeated isSorted,
+ * minValue, maxValue and hashCode queries on unchanged data cost nothing, and writes through
+ * the handle update the cached values instead of discarding them. hashCode is the polynomial
+ * 1 * 19^n + sum of f(x_i) * 19^(n - 1 - i) (f(x) = x ^ (x >> 31)), so appending multiplies
+ * by 19 and adds, and replacing x_i adds (f(new) - f(old)) * 19^(n - 1 - i), all mod 2^64.
+ */
+
+/**
+ * @brief 19^e mod 2^64, by squaring.
+ */
+static unsigned long long hashPower(unsigned long long e) {
+    unsigned long long result = 1, base = 19;
+    while (e != 0) {
+        if (e & 1)
+            result *= base;
+        base *= base;
+        e >>= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief The term hashCode adds for one element.
+ */
+static inline unsigned long long hashTerm(int value) {
+    return (unsigned long long)(value ^ (value >> 31));
+}
+
+/**
+ * @brief Grows the storage of a handle to hold at least `needed` elements, at least doubling it.
+ */
+static status_code handleReserve(array_handle* h, int needed) {
+    if (needed <= h->capacity)
+        return SUCCESS;
+    long long grown = 2 * (long long)h->capacity;
+    if (grown < needed)
+        grown = needed;
+    if (grown < 16)
+        grown = 16;
+    if (grown > INT32_MAX)
+        grown = INT32_MAX;
+    int* data = (int*)ownedAlloc(&h->allocator, (size_t)grown * sizeof(int));
+    if (data == NULL)
+        return FAILURE;
+    if (h->size > 0)
+        copyInts(data, h->data, (size_t)h->size);
+    ownedRelease(&h->allocator, h->data);
+    h->data = data;
+    h->capacity = (int)grown;
+    return SUCCESS;
+}
+
+/**
+ * Function: handleInvalidate
+ * --------------------------
+ * Forgets the cached properties of a handle, after its elements were written through data.
+ */
+inline void handleInvalidate(array_handle* h) {
+    h->sortedKnown = h->size <= 1;
+    h->sorted = h->sortedKnown;
+    h->boundsKnown = false;
+    h->hashKnown = false;
+}
+
+/**
+ * Function: handleInit
+ * --------------------
+ * Makes a handle holding a copy of n elements (arr may be NULL when n is 0). The cached
+ * properties are computed on first use. The storage comes from the installed allocator and is
+ * released by handleFree().
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if memory ran out (the handle is then empty).
+ */
+inline status_code handleInit(array_handle* h, const int* arr, int n) {
+    memset(h, 0, sizeof(*h));
+    handleInvalidate(h);
+    if (n <= 0)
+        return SUCCESS;
+    if (handleReserve(h, n) != SUCCESS)
+        return FAILURE;
+    copyInts(h->data, arr, (size_t)n);
+    h->size = n;
+    handleInvalidate(h);
+    return SUCCESS;
+}
+
+/**
+ * Function: handleFree
+ * --------------------
+ * Releases the storage of a handle and leaves it empty.
+ */
+inline void handleFree(array_handle* h) {
+    ownedRelease(&h->allocator, h->data);
+    memset(h, 0, sizeof(*h));
+    handleInvalidate(h);
+}
+
+/**
+ * Function: handleIsSorted
+ * ------------------------
+ * Returns whether the elements are in ascending order, scanning them only if no earlier call
+ * or write has established it.
+ */
+inline bool handleIsSorted(array_handle* h) {
+    if (!h->sortedKnown) {
+        h->sorted = Arrays.isSorted(h->data, h->size);
+        h->sortedKnown = true;
+    }
+    return h->sorted;
+}
+
+/**
+ * @brief Computes the bounds of a handle if they are not cached.
+ */
+static void handleBounds(array_handle* h) {
+    if (!h->boundsKnown && h->size > 0) {
+        Arrays.minMax(h->data, h->size, &h->minimum, &h->maximum);
+        h->boundsKnown = true;
+    }
+}
+
+/**
+ * Function: handleMin
+ * -------------------
+ * Returns the minimum element (0 if the handle is empty), from the cache when possible.
+ */
+inline int handleMin(array_handle* h) {
+    handleBounds(h);
+    return h->size > 0 ? h->minimum : 0;
+}
+
+/**
+ * Function: handleMax
+ * -------------------
+ * Returns the maximum element (0 if the handle is empty), from the cache when possible.
+ */
+inline int handleMax(array_handle* h) {
+    handleBounds(h);
+    return h->size > 0 ? h->maximum : 0;
+}
+
+/**
+ * Function: handleHashCode
+ * ------------------------
+ * Returns the hashCode of the elements (1 for an empty handle), from the cache when possible.
+ */
+inline unsigned long long handleHashCode(array_handle* h) {
+    if (!h->hashKnown) {
+        h->hashCode = h->size > 0 ? Arrays.hashCode(h->data, h->size) : 1;
+        h->hashKnown = true;
+    }
+    return h->hashCode;
+}
+
+/**
+ * Function: handleAppend
+ * ----------------------
+ * Appends one element, growing the storage geometrically, and updates the cached properties
+ * in O(1).
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if memory ran out (the handle is unchanged).
+ */
+inline status_code handleAppend(array_handle* h, int value) {
+    if (handleReserve(h, h->size + 1) != SUCCESS)
+        return FAILURE;
+    if (h->sortedKnown && h->sorted && h->size > 0 && h->data[h->size - 1] > value)
+        h->sorted = false;
+    if (h->size == 0) {
+        h->minimum = h->maximum = value;
+        h->boundsKnown = true;
+    } else if (h->boundsKnown) {
+        h->minimum = value < h->minimum ? value : h->minimum;
+        h->maximum = value > h->maximum ? value : h->maximum;
+    }
+    if (h->hashKnown)
+        h->hashCode = h->hashCode * 19 + hashTerm(value);
+    h->data[h->size++] = value;
+    return SUCCESS;
+}
+
+/**
+ * Function: handleSet
+ * -------------------
+ * Replaces element i and updates the cached properties in O(1): sortedness from the two
+ * neighbours, bounds unless the old value was the only known extreme, and the hash by the
+ * difference of the two terms.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if i is out of range.
+ */
+inline status_code handleSet(array_handle* h, int i, int value) {
+    if (i < 0 || i >= h->size)
+        return FAILURE;
+    int old = h->data[i];
+    if (old == value)
+        return SUCCESS;
+    if (h->sortedKnown) {
+        if (h->sorted)
+            h->sorted = (i == 0 || h->data[i - 1] <= value) && (i == h->size - 1 || value <= h->data[i + 1]);
+        else
+            h->sortedKnown = false;
+    }
+    if (h->boundsKnown) {
+        if ((old == h->minimum && value > old) || (old == h->maximum && value < old)) {
+            h->boundsKnown = false;
+        } else {
+            h->minimum = value < h->minimum ? value : h->minimum;
+            h->maximum = value > h->maximum ? value : h->maximum;
+        }
+    }
+    if (h->hashKnown)
+        h->hashCode += (hashTerm(value) - hashTerm(old)) * hashPower((unsigned long long)(h->size - 1 - i));
+    h->data[i] = value;
+    return SUCCESS;
+}
+
+/**
+ * Function: handleWrite
+ * ---------------------
+ * Writes count elements at position at, overwriting and, past the end, appending. The cached
+ * properties are updated from the old and new contents of the range only: sortedness from the
+ * new run and its two neighbours, bounds from the minima and maxima of both, and the hash from
+ * the term differences. src may point into the handle.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if at is outside [0, size] or memory ran out (the handle is unchanged).
+ */
+inline status_code handleWrite(array_handle* h, int at, const int* src, int count) {
+    if (at < 0 || at > h->size || count < 0 || (long long)at + count > INT32_MAX)
+        return FAILURE;
+    if (count == 0)
+        return SUCCESS;
+    int end = at + count;
+    bool inside = (uintptr_t)src >= (uintptr_t)h->data && (uintptr_t)src < (uintptr_t)(h->data + h->capacity);
+    size_t srcOffset = inside ? (size_t)(src - h->data) : 0;
+    if (handleReserve(h, end) != SUCCESS)
+        return FAILURE;
+    if (inside)
+        src = h->data + srcOffset;
+    int overlap = (end < h->size ? end : h->size) - at;
+
+    if (h->sortedKnown) {
+        if (h->sorted)
+            h->sorted = Arrays.isSorted((int*)src, count) && (at == 0 || h->data[at - 1] <= src[0]) && (end >= h->size || src[count - 1] <= h->data[end]);
+        else
+            h->sortedKnown = false;
+    }
+    int newMin, newMax;
+    Arrays.minMax(src, count, &newMin, &newMax);
+    if (h->size == 0) {
+        h->minimum = newMin;
+        h->maximum = newMax;
+        h->boundsKnown = true;
+    } else if (h->boundsKnown) {
+        int oldMin = newMin, oldMax = newMax;
+        if (overlap > 0)
+            Arrays.minMax(h->data + at, overlap, &oldMin, &oldMax);
+        if ((oldMin == h->minimum && newMin > oldMin) || (oldMax == h->maximum && newMax < oldMax)) {
+            h->boundsKnown = false;
+        } else {
+            h->minimum = newMin < h->minimum ? newMin : h->minimum;
+            h->maximum = newMax > h->maximum ? newMax : h->maximum;
+        }
+    }
+    if (h->hashKnown) {
+        unsigned long long power = hashPower((unsigned long long)(h->size - at - overlap));
+        unsigned long long delta = 0;
+        for (int j = overlap - 1; j >= 0; --j) {
+            delta += (hashTerm(src[j]) - hashTerm(h->data[at + j])) * power;
+            power *= 19;
+        }
+        unsigned long long hash = h->hashCode + delta;
+        for (int j = overlap; j < count; ++j)
+            hash = hash * 19 + hashTerm(src[j]);
+        h->hashCode = hash;
+    }
+    memmove(h->data + at, src, (size_t)count * sizeof(int));
+    if (end > h->size)
+        h->size = end;
+    return SUCCESS;
+}
+
+/**
+ * Function: handleSort
+ * --------------------
+ * Sorts the elements with Arrays.sort unless the handle already knows they are sorted. Sorting
+ * leaves the bounds at the two ends; the hash is recomputed on next use.
+ */
+inline void handleSort(array_handle* h) {
+    if (h->sortedKnown && h->sorted)
+        return;
+    Arrays.sort(h->data, 0, h->size - 1);
+    h->sorted = true;
+    h->sortedKnown = true;
+    if (h->size > 0) {
+        h->minimum = h->data[0];
+        h->maximum = h->data[h->size - 1];
+        h->boundsKnown = true;
+    }
+    h->hashKnown = false;
+}
+
+/**
+ * Function: handleSearch
+ * ----------------------
+ * Returns the index of the first occurrence of a value, or -1: with searchBIN when the handle
+ * knows it is sorted, with a linear search otherwise, and without reading the elements when
+ * the value lies outside the cached bounds.
+ */
+inline int handleSearch(array_handle* h, int value) {
+    if (h->size == 0 || (h->boundsKnown && (value < h->minimum || value > h->maximum)))
+        return -1;
+    if (h->sortedKnown && h->sorted)
+        return Arrays.searchBIN(h->data, h->size, value);
+    return Arrays.searchLIN(h->data, h->size, value);
+}
+
+
+/**
+ * Dynamic arrays.
+ *
+ * An array_vector grows by doubling into heap blocks aligned to ARRAYS_VECTOR_ALIGNMENT bytes,
+ * obtained from the installed allocator, so the SIMD kernels start on a cache line and
+ * appending n elements copies O(n) in total. Its elements are always contiguous in data.
+ */
+
+/**
+ * Function: vectorInit
+ * --------------------
+ * Makes an empty vector. Nothing is allocated until the first element is added.
+ */
+inline void vectorInit(array_vector* v) {
+    memset(v, 0, sizeof(*v));
+}
+
+/**
+ * Function: smallVectorInit
+ * -------------------------
+ * Makes an empty vector that keeps up to ARRAYS_SMALL_VECTOR elements in the inline buffer of
+ * `small`, so short arrays never touch the heap.
+ */
+inline void smallVectorInit(array_small_vector* small) {
+    vectorInit(&small->vector);
+    small->vector.data = small->buffer;
+    small->vector.capacity = ARRAYS_SMALL_VECTOR;
+    small->vector.inlineData = small->buffer;
+    small->vector.inlineCapacity = ARRAYS_SMALL_VECTOR;
+}
+
+/**
+ * @brief Moves the elements of a vector into a new aligned heap block of `capacity` ints.
+ */
+static status_code vectorReallocate(array_vector* v, int capacity) {
+    void* storage = ownedAlloc(&v->allocator, (size_t)capacity * sizeof(int) + ARRAYS_VECTOR_ALIGNMENT);
+    if (storage == NULL)
+        return FAILURE;
+    int* data = (int*)(((size_t)storage + ARRAYS_VECTOR_ALIGNMENT - 1) & ~(size_t)(ARRAYS_VECTOR_ALIGNMENT - 1));
+    if (v->size > 0)
+        copyInts(data, v->data, (size_t)v->size);
+    ownedRelease(&v->allocator, v->storage);
+    v->storage = storage;
+    v->data = data;
+    v->capacity = capacity;
+    return SUCCESS;
+}
+
+/**
+ * Function: vectorReserve
+ * -----------------------
+ * Makes room for at least `capacity` elements without changing the size.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if memory ran out (the vector is unchanged).
+ */
+inline status_code vectorReserve(array_vector* v, int capacity) {
+    if (capacity <= v->capacity)
+        return SUCCESS;
+    return vectorReallocate(v, capacity);
+}
+
+/**
+ * @brief Makes room for `needed` elements, at least doubling the capacity.
+ */
+static status_code vectorGrow(array_vector* v, long long needed) {
+    if (needed <= v->capacity)
+        return SUCCESS;
+    if (needed > INT32_MAX)
+        return FAILURE;
+    long long grown = 2 * (long long)v->capacity;
+    if (grown < needed)
+        grown = needed;
+    if (grown < 16)
+        grown = 16;
+    if (grown > INT32_MAX)
+        grown = INT32_MAX;
+    return vectorReallocate(v, (int)grown);
+}
+
+/**
+ * Function: vectorShrink
+ * ----------------------
+ * Releases the unused capacity: a small vector whose elements fit its inline buffer moves
+ * back into it, other vectors move into a heap block of exactly size elements, and an empty
+ * vector releases its heap block.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if memory ran out (the vector is unchanged).
+ */
+inline status_code vectorShrink(array_vector* v) {
+    if (v->storage == NULL || v->size == v->capacity)
+        return SUCCESS;
+    if (v->size <= v->inlineCapacity || v->size == 0) {
+        if (v->size > 0)
+            copyInts(v->inlineData, v->data, (size_t)v->size);
+        ownedRelease(&v->allocator, v->storage);
+        memset(&v->allocator, 0, sizeof(v->allocator));
+        v->storage = NULL;
+        v->data = v->inlineData;
+        v->capacity = v->inlineCapacity;
+        return SUCCESS;
+    }
+    return vectorReallocate(v, v->size);
+}
+
+/**
+ * Function: vectorAppend
+ * ----------------------
+ * Appends one element in amortized O(1).
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if memory ran out (the vector is unchanged).
+ */
+inline status_code vectorAppend(array_vector* v, int value) {
+    if (v->size == v->capacity && vectorGrow(v, (long long)v->size + 1) != SUCCESS)
+        return FAILURE;
+    v->data[v->size++] = value;
+    return SUCCESS;
+}
+
+/**
+ * Function: vectorAppendN
+ * -----------------------
+ * Appends n elements with a single capacity check and one bulk copy. src may point into the
+ * vector itself.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if memory ran out (the vector is unchanged).
+ */
+inline status_code vectorAppendN(array_vector* v, const int* src, int n) {
+    if (n <= 0)
+        return SUCCESS;
+    bool inside = (uintptr_t)src >= (uintptr_t)v->data && (uintptr_t)src < (uintptr_t)(v->data + v->size);
+    size_t offset = inside ? (size_t)(src - v->data) : 0;
+    if (vectorGrow(v, (long long)v->size + n) != SUCCESS)
+        return FAILURE;
+    if (inside)
+        src = v->data + offset;
+    memmove(v->data + v->size, src, (size_t)n * sizeof(int));
+    v->size += n;
+    return SUCCESS;
+}
+
+/**
+ * Function: vectorResize
+ * ----------------------
+ * Sets the size to n, zero-filling the new elements when growing.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if n < 0 or memory ran out (the vector is unchanged).
+ */
+inline status_code vectorResize(array_vector* v, int n) {
+    if (n < 0 || vectorGrow(v, n) != SUCCESS)
+        return FAILURE;
+    if (n > v->size)
+        memset(v->data + v->size, 0, (size_t)(n - v->size) * sizeof(int));
+    v->size = n;
+    return SUCCESS;
+}
+
+/**
+ * Function: vectorClear
+ * ---------------------
+ * Removes every element and keeps the capacity.
+ */
+inline void vectorClear(array_vector* v) {
+    v->size = 0;
+}
+
+/**
+ * Function: vectorFree
+ * --------------------
+ * Releases the heap block of a vector and leaves it empty; a small vector goes back to its
+ * inline buffer and stays usable.
+ */
+inline void vectorFree(array_vector* v) {
+    ownedRelease(&v->allocator, v->storage);
+    memset(&v->allocator, 0, sizeof(v->allocator));
+    v->storage = NULL;
+    v->data = v->inlineData;
+    v->capacity = v->inlineCapacity;
+    v->size = 0;
+}
+
+/**
+ * Function: vectorView
+ * --------------------
+ * Returns a view of the elements of a vector, valid until it next grows or shrinks.
+ */
+inline array_view vectorView(const array_vector* v) {
+    return arrayView(v->data, v->size);
+}
+
+
+/**
+ * @brief Calculates the sum of all elements in an integer array.
+ *
+ * This inline function iterates through the elements of the given array
+ * and calculates the sum. The function is designed to be used with small,
+ * frequently called operations for potential performance optimization.
+ * The sum is accumulated in 64 bits, so it cannot overflow for any int array.
+ *
+ * @param arr Pointer to the integer array.
+ * @param n   Number of elements in the array.
+ * @return    The sum of all elements in the array.
+ */
+inline long long sumAllElements(int *arr, int n)
+{
+    long long sum = 0;
+    for (int i = 0; i < n; i++){
+        sum = sum + arr[i];
+        }
+    return sum;
+}
+
+/**
+ * Scans and windows.
+ *
+ * The prefix sums accumulate in 64 bits, like sum, so dest is an array of long long. A scan
+ * has a carried dependency on the previous element; the SIMD kernels scan each vector in
+ * registers and carry only one vector add per block from one block to the next.
+ */
+
+/**
+ * @brief Writes the running sums of arr[0..n) starting from carry, including (inclusive) or
+ * excluding each element, and returns carry plus the sum of the range.
+ */
+static long long prefixSums(const int* arr, size_t n, long long* dest, long long carry, bool inclusive) {
+    long long sum = carry;
+    if (inclusive) {
+        for (size_t i = 0; i < n; ++i) {
+            sum += arr[i];
+            dest[i] = sum;
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            dest[i] = sum;
+            sum += arr[i];
+        }
+    }
+    return sum;
+}
+
+/**
+ * Scan kernel behind prefixSum, exclusivePrefixSum and parallelPrefixSum; useArrayFunctions()
+ * installs the best one for the CPU.
+ */
+static long long (*arraysPrefixSums)(const int* arr, size_t n, long long* dest, long long carry, bool inclusive) = prefixSums;
+
+/**
+ * Function: prefixSum
+ * -------------------
+ * Writes the inclusive prefix sums of the array: dest[i] = arr[0] + ... + arr[i].
+ *
+ * Returns:
+ * The sum of all elements.
+ */
+inline long long prefixSum(const int* arr, int n, long long* dest) {
+    if (n <= 0)
+        return 0;
+    return arraysPrefixSums(arr, (size_t)n, dest, 0, true);
+}
+
+/**
+ * Function: exclusivePrefixSum
+ * ----------------------------
+ * Writes the exclusive prefix sums of the array: dest[0] = 0 and
+ * dest[i] = arr[0] + ... + arr[i - 1].
+ *
+ * Returns:
+ * The sum of all elements.
+ */
+inline long long exclusivePrefixSum(const int* arr, int n, long long* dest) {
+    if (n <= 0)
+        return 0;
+    return arraysPrefixSums(arr, (size_t)n, dest, 0, false);
+}
+
+/**
+ * Function: segmentedPrefixSum
+ * ----------------------------
+ * Writes inclusive prefix sums that restart at every segment head: dest[i] = arr[i] where
+ * heads[i] is true, dest[i] = dest[i - 1] + arr[i] otherwise. Element 0 always starts a segment.
+ *
+ * Parameters:
+ * - arr: The values.
+ * - heads: n flags marking the first element of each segment.
+ * - n: The number of elements.
+ * - dest: Receives n sums.
+ */
+inline void segmentedPrefixSum(const int* arr, const bool* heads, int n, long long* dest) {
+    long long sum = 0;
+    for (int i = 0; i < n; ++i) {
+        sum = (heads[i] ? 0 : sum) + arr[i];
+        dest[i] = sum;
+    }
+}
+
+/**
+ * Function: windowSum
+ * -------------------
+ * Writes the sums of every window of w consecutive elements: dest[i] = arr[i] + ... +
+ * arr[i + w - 1], in one pass that adds the element entering and subtracts the one leaving.
+ *
+ * Returns:
+ * The number of windows, n - w + 1 (0 if w > n), or -1 if w <= 0.
+ */
+inline int windowSum(const int* arr, int n, int w, long long* dest) {
+    if (w <= 0)
+        return -1;
+    if (w > n)
+        return 0;
+    long long sum = 0;
+    for (int i = 0; i < w; ++i)
+        sum += arr[i];
+    dest[0] = sum;
+    for (int i = w; i < n; ++i) {
+        sum += (long long)arr[i] - arr[i - w];
+        dest[i - w + 1] = sum;
+    }
+    return n - w + 1;
+}
+
+/**
+ * @brief Sliding-window minimum (flip == 0) or maximum (flip == -1) with the van Herk/Gil-Werman
+ * scheme: the input is cut into blocks of w, and the window starting at offset j of a block is
+ * the minimum of the block's suffix from j and the next block's prefix up to j - 1. That is
+ * three branch-free comparisons per element whatever w is, where a monotonic deque mispredicts
+ * on every pop. x ^ -1 reverses the order of ints, so the maximum is the minimum of the
+ * flipped values.
+ */
+static int windowExtreme(const int* arr, int n, int w, int* dest, int flip) {
+    if (w <= 0)
+        return -1;
+    if (w > n)
+        return 0;
+    int* suffix = (int*)malloc((size_t)w * sizeof(int));
+    if (suffix == NULL)
+        return -1;
+
+    int windows = n - w + 1;
+    for (int start = 0; start < windows; start += w) {
+        int last = start + w - 1;
+        int minimum = arr[last] ^ flip;
+        suffix[w - 1] = minimum;
+        for (int j = w - 2; j >= 0; --j) {
+            int value = arr[start + j] ^ flip;
+            minimum = value < minimum ? value : minimum;
+            suffix[j] = minimum;
+        }
+        int count = windows - start < w ? windows - start : w;
+        int prefix = INT32_MAX;
+        dest[start] = suffix[0] ^ flip;
+        for (int j = 1; j < count; ++j) {
+            int value = arr[last + j] ^ flip;
+            prefix = value < prefix ? value : prefix;
+            dest[start + j] = (suffix[j] < prefix ? suffix[j] : prefix) ^ flip;
+        }
+    }
+    free(suffix);
+    return windows;
+}
+
+/**
+ * Function: windowMin
+ * -------------------
+ * Writes the minimum of every window of w consecutive elements, in O(n) whatever w is.
+ *
+ * Returns:
+ * The number of windows, n - w + 1 (0 if w > n), or -1 if w <= 0 or memory ran out.
+ */
+inline int windowMin(const int* arr, int n, int w, int* dest) {
+    return windowExtreme(arr, n, w, dest, 0);
+}
+
+/**
+ * Function: windowMax
+ * -------------------
+ * Writes the maximum of every window of w consecutive elements, in O(n) whatever w is.
+ *
+ * Returns:
+ * The number of windows, n - w + 1 (0 if w > n), or -1 if w <= 0 or memory ran out.
+ */
+inline int windowMax(const int* arr, int n, int w, int* dest) {
+    return windowExtreme(arr, n, w, dest, -1);
+}
+
+
+/**
+ * @brief Checks if an integer array is sorted in ascending order.
+ *
+ * This inline function iterates through the elements of the given array,
+ * comparing each element with its predecessor. If any element is smaller
+ * than its preceding element, the function returns false, indicating that
+ * the array is not sorted. Otherwise, it returns true, signifying that the
+ * array is sorted in ascending order.
+ *
+ * @param arr Pointer to the integer array.
+ * @param n   Number of elements in the array.
+ * @return    True if the array is sorted in ascending order, false otherwise.
+ */
+inline bool checkForSort(int *arr, int n)
+{
+    for (int i = 1; i < n; i++)
+    {
+        if (arr[i]<arr[i-1])
+        return false;
+    }
+    
+    return true;
+}
+
+
+/**
+ * @brief Concatenates two arrays into a new array.
+ *
+ * @param arr1 The first array.
+ * @param size1 The size of the first array.
+ * @param arr2 The second array.
+ * @param size2 The size of the second array.
+ * @return A new array containing elements from both input arrays, or NULL if memory could not be allocated.
+ * 
+ * NOTE: The array returned must be released explicitly by the user (Arrays.release).
+ */
+inline int *concatenateTwoArrays(int *arr1, int size1, int *arr2, int size2)
+{
+    size_t total = (size_t)size1 + (size_t)size2;
+    int* new_array = (int*)arraysAlloc((total ? total : 1)*sizeof(int));
+    if (new_array == NULL)
+        return NULL;
+    copyInts(new_array, arr1, (size_t)size1);
+    copyInts(new_array + size1, arr2, (size_t)size2);
+    return new_array;
+}
+
+
+/**
+ * @brief Concatenates two arrays into a caller-provided buffer, without allocating.
+ *
+ * Each input is copied in one sequential stream (non-temporal for large copies).
+ *
+ * @param arr1 The first array.
+ * @param size1 The size of the first array.
+ * @param arr2 The second array.
+ * @param size2 The size of the second array.
+ * @param dest The destination buffer. Must not overlap either input.
+ * @param capacity The number of ints dest can hold; the result is truncated to it.
+ * @return The number of elements written.
+ */
+inline int concatInto(const int *arr1, int size1, const int *arr2, int size2, int *dest, int capacity)
+{
+    const int* arrays[2] = {arr1, arr2};
+    int sizes[2] = {size1, size2};
+    return concatN(arrays, sizes, 2, dest, capacity);
+}
+
+
+/**
+ * @brief Concatenates any number of arrays into a caller-provided buffer, without allocating.
+ *
+ * @param arrays The arrays to concatenate, in order.
+ * @param sizes The size of each array.
+ * @param count The number of arrays.
+ * @param dest The destination buffer. Must not overlap any input.
+ * @param capacity The number of ints dest can hold; the result is truncated to it.
+ * @return The number of elements written.
+ */
+inline int concatN(const int *const *arrays, const int *sizes, int count, int *dest, int capacity)
+{
+    int written = 0;
+    for (int i = 0; i < count && written < capacity; i++)
+    {
+        int size = sizes[i] < capacity - written ? sizes[i] : capacity - written;
+        if (size <= 0)
+            continue;
+        copyInts(dest + written, arrays[i], (size_t)size);
+        written += size;
+    }
+    return written;
+}
+
+
+/**
+ * @brief Return the index of first occurrence of the element in the array.
+ * @param arr Array.
+ * @param n Size of the array.
+ * @param element Element to be searched
+ * @return index of the found element 
+*/
+inline int firstIndexOf(int *arr, int n, int element)
+{
+    return searchLIN(arr, n, element);
+}
+
+
+/**
+ * @brief Calculates the hash code of an integer array.
+ *
+ * This function takes an integer array and calculates its hash code using a specific formula.
+ *
+ * @param arr Pointer to the integer array.
+ * @param n Number of elements in the array.
+ *
+ * @return Unsigned long long representing the hash code.
+ */
+inline unsigned long long getHashCodeOf(int *arr, int n)
+{
+    if (arr==NULL)
+        return 0;
+    unsigned long long hash = 1;
+    for (int i = 0; i < n; i++)
+    {
+        int val = arr[i];
+        val = val ^ (val>>31);
+        hash = hash * 19 + val ;
+    }
+    
+    return hash;
+}
+
+
+/**
+ * Wide-lane hash.
+ *
+ * The data is consumed in 64-byte stripes (16 ints) by eight independent 64-bit lanes, in the
+ * style of XXH3: each lane multiplies the two 32-bit halves of a keyed input word and adds the
+ * neighbouring word, so there is no dependency between stripes other than the accumulators and
+ * the stripe loop vectorizes (SSE4.2, AVX2, AVX-512 and NEON kernels below). The lanes are
+ * scrambled every ARRAYS_HASH_BLOCK stripes and folded into one value by hashStateFinal().
+ *
+ * The result depends only on the elements and the seed, not on how the input was split
+ * between hashStateUpdate() calls. It is not the value of getHashCodeOf(), which is kept as is.
+ */
+
+/**
+ * Stripes accumulated between two scrambles of the hash lanes. Changing it changes every hash.
+ */
+#ifndef ARRAYS_HASH_BLOCK
+#define ARRAYS_HASH_BLOCK 16
+#endif
+
+static const uint64_t arraysHashSecret[8] = {
+    0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull, 0xdb979083e96dd4deull, 0x1f67b3b7a4a44072ull,
+    0x78e5c0cc4ee679cbull, 0x2172ffcc7dd05a82ull, 0x8e2443f7744608b8ull, 0x4c263a81e69035e0ull
+};
+
+#define ARRAYS_HASH_PRIME32 0x9E3779B1ull
+#define ARRAYS_HASH_PRIME64_1 0x9E3779B185EBCA87ull
+#define ARRAYS_HASH_PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define ARRAYS_HASH_PRIME64_3 0x165667B19E3779F9ull
+
+/**
+ * @brief Portable stripe kernel: accumulates `stripes` 16-int stripes of data into the eight lanes.
+ */
+static void hashStripes(uint64_t* acc, const int* data, size_t stripes) {
+    for (size_t s = 0; s < stripes; ++s, data += 16) {
+        for (int j = 0; j < 8; ++j) {
+            uint64_t word = (uint64_t)(unsigned int)data[2 * j] | ((uint64_t)(unsigned int)data[2 * j + 1] << 32);
+            uint64_t keyed = word ^ arraysHashSecret[j];
+            acc[j ^ 1] += word;
+            acc[j] += (keyed & 0xFFFFFFFFull) * (keyed >> 32);
+        }
+    }
+}
+
+/**
+ * Stripe kernel used by hashStateUpdate(); useArrayFunctions() installs the best one for the CPU.
+ */
+static void (*arraysHashStripes)(uint64_t* acc, const int* data, size_t stripes) = hashStripes;
+
+static void hashScramble(uint64_t* acc) {
+    for (int j = 0; j < 8; ++j) {
+        uint64_t lane = acc[j];
+        lane ^= lane >> 47;
+        lane ^= arraysHashSecret[7 - j];
+        acc[j] = lane * ARRAYS_HASH_PRIME32;
+    }
+}
+
+static uint64_t hashAvalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= ARRAYS_HASH_PRIME64_2;
+    h ^= h >> 29;
+    h *= ARRAYS_HASH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * @brief Accumulates whole stripes, scrambling the lanes at every block boundary.
+ */
+static void hashConsumeStripes(array_hash_state* state, const int* data, size_t stripes) {
+    while (stripes > 0) {
+        size_t room = ARRAYS_HASH_BLOCK - state->stripes;
+        size_t run = stripes < room ? stripes : room;
+        arraysHashStripes(state->acc, data, run);
+        data += run * 16;
+        stripes -= run;
+        state->stripes += run;
+        if (state->stripes == ARRAYS_HASH_BLOCK) {
+            hashScramble(state->acc);
+            state->stripes = 0;
+        }
+    }
+}
+
+/**
+ * Function: hashStateInit
+ * -----------------------
+ * Starts a streaming wide-lane hash.
+ *
+ * Parameters:
+ * - state: The state to initialize.
+ * - seed: Any value; different seeds give independent hash functions.
+ */
+inline void hashStateInit(array_hash_state* state, uint64_t seed) {
+    for (int j = 0; j < 8; ++j)
+        state->acc[j] = arraysHashSecret[j] + ((j & 1) ? seed : 0 - seed);
+    state->stripes = 0;
+    state->buffered = 0;
+    state->length = 0;
+}
+
+/**
+ * Function: hashStateUpdate
+ * -------------------------
+ * Adds the next n elements to a streaming hash. Input is processed in whole stripes as soon as
+ * it arrives; fewer than 16 leftover elements are buffered in the state.
+ *
+ * Parameters:
+ * - state: A state started with hashStateInit().
+ * - arr: The next elements.
+ * - n: The number of elements.
+ */
+inline void hashStateUpdate(array_hash_state* state, const int* arr, size_t n) {
+    if (arr == NULL || n == 0)
+        return;
+    state->length += n;
+    if (state->buffered > 0) {
+        size_t take = 16 - state->buffered < n ? 16 - state->buffered : n;
+        memcpy(state->buffer + state->buffered, arr, take * sizeof(int));
+        state->buffered += take;
+        arr += take;
+        n -= take;
+        if (state->buffered < 16)
+            return;
+        hashConsumeStripes(state, state->buffer, 1);
+        state->buffered = 0;
+    }
+    hashConsumeStripes(state, arr, n / 16);
+    state->buffered = n % 16;
+    memcpy(state->buffer, arr + (n - state->buffered), state->buffered * sizeof(int));
+}
+
+/**
+ * Function: hashStateFinal
+ * ------------------------
+ * Returns the hash of everything added so far. The state is not modified, so hashing can go on.
+ */
+inline uint64_t hashStateFinal(const array_hash_state* state) {
+    uint64_t h = (uint64_t)state->length * ARRAYS_HASH_PRIME64_1;
+    for (int j = 0; j < 8; ++j) {
+        h ^= hashAvalanche(state->acc[j] ^ arraysHashSecret[j]);
+        h = ((h << 27) | (h >> 37)) * ARRAYS_HASH_PRIME64_1 + ARRAYS_HASH_PRIME64_3;
+    }
+    for (size_t i = 0; i < state->buffered; ++i) {
+        h ^= (uint64_t)(unsigned int)state->buffer[i] * ARRAYS_HASH_PRIME64_1;
+        h = ((h << 23) | (h >> 41)) * ARRAYS_HASH_PRIME64_2 + ARRAYS_HASH_PRIME64_3;
+    }
+    return hashAvalanche(h);
+}
+
+/**
+ * Function: fastHashOf
+ * --------------------
+ * Wide-lane hash of a whole array; equal to hashing it with hashStateInit/Update/Final.
+ *
+ * Parameters:
+ * - arr: The array to hash.
+ * - n: The number of elements.
+ * - seed: The seed passed to hashStateInit().
+ */
+inline uint64_t fastHashOf(const int* arr, size_t n, uint64_t seed) {
+    array_hash_state state;
+    hashStateInit(&state, seed);
+    hashStateUpdate(&state, arr, n);
+    return hashStateFinal(&state);
+}
+
+
+/**
+ * SIMD kernels.
+ *
+ * The kernels below are compiled with per-function target attributes, so the header needs
+ * no -msse4.2/-mavx2/-mavx512f flags; useArrayFunctions() installs them only when the CPU
+ * running the program supports them.
+ */
+#ifdef ARRAYS_X86_SIMD
+
+static ARRAYS_TARGET_SSE42 int horizontalMin_sse42(__m128i r) {
+    r = _mm_min_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(1, 0, 3, 2)));
+    r = _mm_min_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(r);
+}
+
+static ARRAYS_TARGET_SSE42 int horizontalMax_sse42(__m128i r) {
+    r = _mm_max_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(1, 0, 3, 2)));
+    r = _mm_max_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(r);
+}
+
+/**
+ * @brief SSE4.2 getminOf: four independent 4-lane accumulators, 16 elements per iteration.
+ */
+static ARRAYS_TARGET_SSE42 int getminOf_sse42(const int* arr, int n) {
+    if (n <= 0)
+        return 0;
+    int i = 0;
+    int minimum = arr[0];
+    if (n >= 16) {
+        __m128i m0 = _mm_loadu_si128((const __m128i*)arr);
+        __m128i m1 = m0, m2 = m0, m3 = m0;
+        for (; i + 16 <= n; i += 16) {
+            m0 = _mm_min_epi32(m0, _mm_loadu_si128((const __m128i*)(arr + i)));
+            m1 = _mm_min_epi32(m1, _mm_loadu_si128((const __m128i*)(arr + i + 4)));
+            m2 = _mm_min_epi32(m2, _mm_loadu_si128((const __m128i*)(arr + i + 8)));
+            m3 = _mm_min_epi32(m3, _mm_loadu_si128((const __m128i*)(arr + i + 12)));
+        }
+        minimum = horizontalMin_sse42(_mm_min_epi32(_mm_min_epi32(m0, m1), _mm_min_epi32(m2, m3)));
+    }
+    for (; i < n; ++i) {
+        if (arr[i] < minimum)
+            minimum = arr[i];
+    }
+    return minimum;
+}
+
+/**
+ * @brief SSE4.2 getmaxOf: four independent 4-lane accumulators, 16 elements per iteration.
+ */
+static ARRAYS_TARGET_SSE42 int getmaxOf_sse42(const int* arr, int n) {
+    if (n <= 0)
+        return 0;
+    int i = 0;
+    int maximum = arr[0];
+    if (n >= 16) {
+        __m128i m0 = _mm_loadu_si128((const __m128i*)arr);
+        __m128i m1 = m0, m2 = m0, m3 = m0;
+        for (; i + 16 <= n; i += 16) {
+            m0 = _mm_max_epi32(m0, _mm_loadu_si128((const __m128i*)(arr + i)));
+            m1 = _mm_max_epi32(m1, _mm_loadu_si128((const __m128i*)(arr + i + 4)));
+            m2 = _mm_max_epi32(m2, _mm_loadu_si128((const __m128i*)(arr + i + 8)));
+            m3 = _mm_max_epi32(m3, _mm_loadu_si128((const __m128i*)(arr + i + 12)));
+        }
+        maximum = horizontalMax_sse42(_mm_max_epi32(_mm_max_epi32(m0, m1), _mm_max_epi32(m2, m3)));
+    }
+    for (; i < n; ++i) {
+        if (arr[i] > maximum)
+            maximum = arr[i];
+    }
+    return maximum;
+}
+
+/**
+ * @brief SSE4.2 getMinMaxOf: both reductions share every load.
+ */
+static ARRAYS_TARGET_SSE42 void getMinMaxOf_sse42(const int* arr, int n, int* minimum, int* maximum) {
+    if (n <= 0) {
+        *minimum = 0;
+        *maximum = 0;
+        return;
+    }
+    int i = 0;
+    int low = arr[0];
+    int high = arr[0];
+    if (n >= 8) {
+        __m128i lo0 = _mm_loadu_si128((const __m128i*)arr);
+        __m128i lo1 = lo0, hi0 = lo0, hi1 = lo0;
+        for (; i + 8 <= n; i += 8) {
+            __m128i a = _mm_loadu_si128((const __m128i*)(arr + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(arr + i + 4));
+            lo0 = _mm_min_epi32(lo0, a);
+            hi0 = _mm_max_epi32(hi0, a);
+            lo1 = _mm_min_epi32(lo1, b);
+            hi1 = _mm_max_epi32(hi1, b);
+        }
+        low = horizontalMin_sse42(_mm_min_epi32(lo0, lo1));
+        high = horizontalMax_sse42(_mm_max_epi32(hi0, hi1));
+    }
+    for (; i < n; ++i) {
+        if (arr[i] < low)
+            low = arr[i];
+        if (arr[i] > high)
+            high = arr[i];
+    }
+    *minimum = low;
+    *maximum = high;
+}
+
+/**
+ * @brief SSE4.2 sumAllElements: every element is sign-extended into a 64-bit lane before adding.
+ */
+static ARRAYS_TARGET_SSE42 long long sumAllElements_sse42(int* arr, int n) {
+    int i = 0;
+    __m128i s0 = _mm_setzero_si128();
+    __m128i s1 = _mm_setzero_si128();
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(arr + i));
+        s0 = _mm_add_epi64(s0, _mm_cvtepi32_epi64(v));
+        s1 = _mm_add_epi64(s1, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+    }
+    long long lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, _mm_add_epi64(s0, s1));
+    long long sum = lanes[0] + lanes[1];
+    for (; i < n; ++i) {
+        sum += arr[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief SSE4.2 MAX_count: per-lane maxima and counts, updated with comparison masks.
+ */
+static ARRAYS_TARGET_SSE42 int MAX_count_sse42(const int* arr, int n) {
+    if (n < 8)
+        return MAX_count(arr, n);
+    const __m128i one = _mm_set1_epi32(1);
+    __m128i maxima = _mm_loadu_si128((const __m128i*)arr);
+    __m128i counts = one;
+    int i = 4;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(arr + i));
+        __m128i greater = _mm_cmpgt_epi32(v, maxima);
+        __m128i equal = _mm_cmpeq_epi32(v, maxima);
+        counts = _mm_blendv_epi8(_mm_sub_epi32(counts, equal), one, greater);
+        maxima = _mm_max_epi32(maxima, v);
+    }
+    int maximum = horizontalMax_sse42(maxima);
+    for (int j = i; j < n; ++j) {
+        if (arr[j] > maximum)
+            maximum = arr[j];
+    }
+    int laneMax[4], laneCount[4];
+    _mm_storeu_si128((__m128i*)laneMax, maxima);
+    _mm_storeu_si128((__m128i*)laneCount, counts);
+    int count = 0;
+    for (int lane = 0; lane < 4; ++lane) {
+        if (laneMax[lane] == maximum)
+            count += laneCount[lane];
+    }
+    for (; i < n; ++i) {
+        if (arr[i] == maximum)
+            count++;
+    }
+    return count;
+}
+
+static ARRAYS_TARGET_AVX2 int horizontalMin_avx2(__m256i v) {
+    __m128i r = _mm_min_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    r = _mm_min_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(1, 0, 3, 2)));
+    r = _mm_min_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(r);
+}
+
+static ARRAYS_TARGET_AVX2 int horizontalMax_avx2(__m256i v) {
+    __m128i r = _mm_max_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    r = _mm_max_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(1, 0, 3, 2)));
+    r = _mm_max_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(r);
+}
+
+/**
+ * @brief AVX2 getminOf: four independent 8-lane accumulators, 32 elements per iteration.
+ */
+static ARRAYS_TARGET_AVX2 int getminOf_avx2(const int* arr, int n) {
+    if (n <= 0)
+        return 0;
+    int i = 0;
+    int minimum = arr[0];
+    if (n >= 32) {
+        __m256i m0 = _mm256_loadu_si256((const __m256i*)arr);
+        __m256i m1 = m0, m2 = m0, m3 = m0;
+        for (; i + 32 <= n; i += 32) {
+            m0 = _mm256_min_epi32(m0, _mm256_loadu_si256((const __m256i*)(arr + i)));
+            m1 = _mm256_min_epi32(m1, _mm256_loadu_si256((const __m256i*)(arr + i + 8)));
+            m2 = _mm256_min_epi32(m2, _mm256_loadu_si256((const __m256i*)(arr + i + 16)));
+            m3 = _mm256_min_epi32(m3, _mm256_loadu_si256((const __m256i*)(arr + i + 24)));
+        }
+        minimum = horizontalMin_avx2(_mm256_min_epi32(_mm256_min_epi32(m0, m1), _mm256_min_epi32(m2, m3)));
+    }
+    for (; i < n; ++i) {
+        if (arr[i] < minimum)
+            minimum = arr[i];
+    }
+    return minimum;
+}
+
+/**
+ * @brief AVX2 getmaxOf: four independent 8-lane accumulators, 32 elements per iteration.
+ */
+static ARRAYS_TARGET_AVX2 int getmaxOf_avx2(const int* arr, int n) {
+    if (n <= 0)
+        return 0;
+    int i = 0;
+    int maximum = arr[0];
+    if (n >= 32) {
+        __m256i m0 = _mm256_loadu_si256((const __m256i*)arr);
+        __m256i m1 = m0, m2 = m0, m3 = m0;
+        for (; i + 32 <= n; i += 32) {
+            m0 = _mm256_max_epi32(m0, _mm256_loadu_si256((const __m256i*)(arr + i)));
+            m1 = _mm256_max_epi32(m1, _mm256_loadu_si256((const __m256i*)(arr + i + 8)));
+            m2 = _mm256_max_epi32(m2, _mm256_loadu_si256((const __m256i*)(arr + i + 16)));
+            m3 = _mm256_max_epi32(m3, _mm256_loadu_si256((const __m256i*)(arr + i + 24)));
+        }
+        maximum = horizontalMax_avx2(_mm256_max_epi32(_mm256_max_epi32(m0, m1), _mm256_max_epi32(m2, m3)));
+    }
+    for (; i < n; ++i) {
+        if (arr[i] > maximum)
+            maximum = arr[i];
+    }
+    return maximum;
+}
+
+/**
+ * @brief AVX2 getMinMaxOf: both reductions share every load.
+ */
+static ARRAYS_TARGET_AVX2 void getMinMaxOf_avx2(const int* arr, int n, int* minimum, int* maximum) {
+    if (n <= 0) {
+        *minimum = 0;
+        *maximum = 0;
+        return;
+    }
+    int i = 0;
+    int low = arr[0];
+    int high = arr[0];
+    if (n >= 16) {
+        __m256i lo0 = _mm256_loadu_si256((const __m256i*)arr);
+        __m256i lo1 = lo0, hi0 = lo0, hi1 = lo0;
+        for (; i + 16 <= n; i += 16) {
+            __m256i a = _mm256_loadu_si256((const __m256i*)(arr + i));
+            __m256i b = _mm256_loadu_si256((const __m256i*)(arr + i + 8));
+            lo0 = _mm256_min_epi32(lo0, a);
+            hi0 = _mm256_max_epi32(hi0, a);
+            lo1 = _mm256_min_epi32(lo1, b);
+            hi1 = _mm256_max_epi32(hi1, b);
+        }
+        low = horizontalMin_avx2(_mm256_min_epi32(lo0, lo1));
+        high = horizontalMax_avx2(_mm256_max_epi32(hi0, hi1));
+    }
+    for (; i < n; ++i) {
+        if (arr[i] < low)
+            low = arr[i];
+        if (arr[i] > high)
+            high = arr[i];
+    }
+    *minimum = low;
+    *maximum = high;
+}
+
+/**
+ * @brief AVX2 sumAllElements: every element is sign-extended into a 64-bit lane before adding.
+ */
+static ARRAYS_TARGET_AVX2 long long sumAllElements_avx2(int* arr, int n) {
+    int i = 0;
+    long long sum = 0;
+    __m256i s0 = _mm256_setzero_si256();
+    __m256i s1 = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(arr + i));
+        s0 = _mm256_add_epi64(s0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        s1 = _mm256_add_epi64(s1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(s0, s1));
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; ++i) {
+        sum += arr[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief AVX2 prefix sums: two vectors of four 64-bit lanes are scanned in registers, the
+ * second offset by the last lane of the first, and the running total is added to both.
+ */
+static ARRAYS_TARGET_AVX2 long long prefixSums_avx2(const int* arr, size_t n, long long* dest, long long carry, bool inclusive) {
+    size_t i = 0;
+    __m256i zero = _mm256_setzero_si256();
+    __m256i total = _mm256_set1_epi64x(carry);
+    for (; i + 8 <= n; i += 8) {
+        __m256i x0 = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(arr + i)));
+        __m256i x1 = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(arr + i + 4)));
+        __m256i v0 = _mm256_add_epi64(x0, _mm256_blend_epi32(_mm256_permute4x64_epi64(x0, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03));
+        __m256i v1 = _mm256_add_epi64(x1, _mm256_blend_epi32(_mm256_permute4x64_epi64(x1, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03));
+        v0 = _mm256_add_epi64(v0, _mm256_blend_epi32(_mm256_permute4x64_epi64(v0, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F));
+        v1 = _mm256_add_epi64(v1, _mm256_blend_epi32(_mm256_permute4x64_epi64(v1, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F));
+        v1 = _mm256_add_epi64(v1, _mm256_permute4x64_epi64(v0, _MM_SHUFFLE(3, 3, 3, 3)));
+        v0 = _mm256_add_epi64(v0, total);
+        v1 = _mm256_add_epi64(v1, total);
+        total = _mm256_permute4x64_epi64(v1, _MM_SHUFFLE(3, 3, 3, 3));
+        if (!inclusive) {
+            v0 = _mm256_sub_epi64(v0, x0);
+            v1 = _mm256_sub_epi64(v1, x1);
+        }
+        _mm256_storeu_si256((__m256i*)(dest + i), v0);
+        _mm256_storeu_si256((__m256i*)(dest + i + 4), v1);
+    }
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, total);
+    return prefixSums(arr + i, n - i, dest + i, lanes[0], inclusive);
+}
+
+/**
+ * @brief AVX2 MAX_count: each lane tracks its own maximum and how often it was seen; lanes
+ * whose maximum equals the overall maximum contribute their counts.
+ */
+static ARRAYS_TARGET_AVX2 int MAX_count_avx2(const int* arr, int n) {
+    if (n < 16)
+        return MAX_count(arr, n);
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i maxima = _mm256_loadu_si256((const __m256i*)arr);
+    __m256i counts = one;
+    int i = 8;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(arr + i));
+        __m256i greater = _mm256_cmpgt_epi32(v, maxima);
+        __m256i equal = _mm256_cmpeq_epi32(v, maxima);
+        counts = _mm256_blendv_epi8(_mm256_sub_epi32(counts, equal), one, greater);
+        maxima = _mm256_max_epi32(maxima, v);
+    }
+    int maximum = horizontalMax_avx2(maxima);
+    for (int j = i; j < n; ++j) {
+        if (arr[j] > maximum)
+            maximum = arr[j];
+    }
+    int laneMax[8], laneCount[8];
+    _mm256_storeu_si256((__m256i*)laneMax, maxima);
+    _mm256_storeu_si256((__m256i*)laneCount, counts);
+    int count = 0;
+    for (int lane = 0; lane < 8; ++lane) {
+        if (laneMax[lane] == maximum)
+            count += laneCount[lane];
+    }
+    for (; i < n; ++i) {
+        if (arr[i] == maximum)
+            count++;
+    }
+    return count;
+}
+
+/**
+ * @brief AVX-512 getminOf: two independent 16-lane accumulators, 32 elements per iteration.
+ */
+static ARRAYS_TARGET_AVX512 int getminOf_avx512(const int* arr, int n) {
+    if (n <= 0)
+        return 0;
+    __m512i m0 = _mm512_set1_epi32(arr[0]);
+    __m512i m1 = m0;
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        m0 = _mm512_min_epi32(m0, _mm512_loadu_si512((const void*)(arr + i)));
+        m1 = _mm512_min_epi32(m1, _mm512_loadu_si512((const void*)(arr + i + 16)));
+    }
+    if (i + 16 <= n) {
+        m0 = _mm512_min_epi32(m0, _mm512_loadu_si512((const void*)(arr + i)));
+        i += 16;
+    }
+    if (i < n) {
+        __mmask16 tail = (__mmask16)((1u << (n - i)) - 1);
+        m1 = _mm512_min_epi32(m1, _mm512_mask_loadu_epi32(m1, tail, arr + i));
+    }
+    return _mm512_reduce_min_epi32(_mm512_min_epi32(m0, m1));
+}
+
+/**
+ * @brief AVX-512 getmaxOf: two independent 16-lane accumulators, 32 elements per iteration.
+ */
+static ARRAYS_TARGET_AVX512 int getmaxOf_avx512(const int* arr, int n) {
+    if (n <= 0)
+        return 0;
+    __m512i m0 = _mm512_set1_epi32(arr[0]);
+    __m512i m1 = m0;
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        m0 = _mm512_max_epi32(m0, _mm512_loadu_si512((const void*)(arr + i)));
+        m1 = _mm512_max_epi32(m1, _mm512_loadu_si512((const void*)(arr + i + 16)));
+    }
+    if (i + 16 <= n) {
+        m0 = _mm512_max_epi32(m0, _mm512_loadu_si512((const void*)(arr + i)));
+        i += 16;
+    }
+    if (i < n) {
+        __mmask16 tail = (__mmask16)((1u << (n - i)) - 1);
+        m1 = _mm512_max_epi32(m1, _mm512_mask_loadu_epi32(m1, tail, arr + i));
+    }
+    return _mm512_reduce_max_epi32(_mm512_max_epi32(m0, m1));
+}
+
+/**
+ * @brief AVX-512 getMinMaxOf: both reductions share every load; the tail uses a masked load.
+ */
+static ARRAYS_TARGET_AVX512 void getMinMaxOf_avx512(const int* arr, int n, int* minimum, int* maximum) {
+    if (n <= 0) {
+        *minimum = 0;
+        *maximum = 0;
+        return;
+    }
+    __m512i low = _mm512_set1_epi32(arr[0]);
+    __m512i high = low;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void*)(arr + i));
+        low = _mm512_min_epi32(low, v);
+        high = _mm512_max_epi32(high, v);
+    }
+    if (i < n) {
+        __mmask16 tail = (__mmask16)((1u << (n - i)) - 1);
+        low = _mm512_min_epi32(low, _mm512_mask_loadu_epi32(low, tail, arr + i));
+        high = _mm512_max_epi32(high, _mm512_mask_loadu_epi32(high, tail, arr + i));
+    }
+    *minimum = _mm512_reduce_min_epi32(low);
+    *maximum = _mm512_reduce_max_epi32(high);
+}
+
+/**
+ * @brief AVX-512 sumAllElements: every element is sign-extended into a 64-bit lane before adding.
+ */
+static ARRAYS_TARGET_AVX512 long long sumAllElements_avx512(int* arr, int n) {
+    int i = 0;
+    __m512i s0 = _mm512_setzero_si512();
+    __m512i s1 = _mm512_setzero_si512();
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void*)(arr + i));
+        s0 = _mm512_add_epi64(s0, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)));
+        s1 = _mm512_add_epi64(s1, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+    }
+    if (i < n) {
+        __mmask16 tail = (__mmask16)((1u << (n - i)) - 1);
+        __m512i v = _mm512_maskz_loadu_epi32(tail, arr + i);
+        s0 = _mm512_add_epi64(s0, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)));
+        s1 = _mm512_add_epi64(s1, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+    }
+    return _mm512_reduce_add_epi64(_mm512_add_epi64(s0, s1));
+}
+
+/**
+ * @brief AVX-512 prefix sums: eight 64-bit lanes scanned in registers with three lane shifts.
+ */
+static ARRAYS_TARGET_AVX512 long long prefixSums_avx512(const int* arr, size_t n, long long* dest, long long carry, bool inclusive) {
+    size_t i = 0;
+    __m512i zero = _mm512_setzero_si512();
+    __m512i last = _mm512_set1_epi64(7);
+    __m512i total = _mm512_set1_epi64(carry);
+    for (; i + 16 <= n; i += 16) {
+        __m512i x0 = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(arr + i)));
+        __m512i x1 = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)(arr + i + 8)));
+        __m512i v0 = _mm512_add_epi64(x0, _mm512_alignr_epi64(x0, zero, 7));
+        __m512i v1 = _mm512_add_epi64(x1, _mm512_alignr_epi64(x1, zero, 7));
+        v0 = _mm512_add_epi64(v0, _mm512_alignr_epi64(v0, zero, 6));
+        v1 = _mm512_add_epi64(v1, _mm512_alignr_epi64(v1, zero, 6));
+        v0 = _mm512_add_epi64(v0, _mm512_alignr_epi64(v0, zero, 4));
+        v1 = _mm512_add_epi64(v1, _mm512_alignr_epi64(v1, zero, 4));
+        v1 = _mm512_add_epi64(v1, _mm512_permutexvar_epi64(last, v0));
+        v0 = _mm512_add_epi64(v0, total);
+        v1 = _mm512_add_epi64(v1, total);
+        total = _mm512_permutexvar_epi64(last, v1);
+        if (!inclusive) {
+            v0 = _mm512_sub_epi64(v0, x0);
+            v1 = _mm512_sub_epi64(v1, x1);
+        }
+        _mm512_storeu_si512((void*)(dest + i), v0);
+        _mm512_storeu_si512((void*)(dest + i + 8), v1);
+    }
+    long long lanes[8];
+    _mm512_storeu_si512((void*)lanes, total);
+    return prefixSums(arr + i, n - i, dest + i, lanes[0], inclusive);
+}
+
+/**
+ * @brief AVX-512 MAX_count: per-lane maxima and counts, updated with comparison masks.
+ */
+static ARRAYS_TARGET_AVX512 int MAX_count_avx512(const int* arr, int n) {
+    if (n < 32)
+        return MAX_count(arr, n);
+    const __m512i one = _mm512_set1_epi32(1);
+    __m512i maxima = _mm512_loadu_si512((const void*)arr);
+    __m512i counts = one;
+    int i = 16;
+    for (; i + 16 <= n; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void*)(arr + i));
+        __mmask16 greater = _mm512_cmpgt_epi32_mask(v, maxima);
+        __mmask16 equal = _mm512_cmpeq_epi32_mask(v, maxima);
+        counts = _mm512_mask_add_epi32(counts, equal, counts, one);
+        counts = _mm512_mask_mov_epi32(counts, greater, one);
+        maxima = _mm512_max_epi32(maxima, v);
+    }
+    int maximum = _mm512_reduce_max_epi32(maxima);
+    for (int j = i; j < n; ++j) {
+        if (arr[j] > maximum)
+            maximum = arr[j];
+    }
+    __mmask16 winners = _mm512_cmpeq_epi32_mask(maxima, _mm512_set1_epi32(maximum));
+    int count = _mm512_mask_reduce_add_epi32(winners, counts);
+    for (; i < n; ++i) {
+        if (arr[i] == maximum)
+            count++;
+    }
+    return count;
+}
+
+/**
+ * @brief SSE4.2 searchLIN: compares 16 elements per iteration and only looks for the exact
+ * lane once a block contains a match.
+ */
+static ARRAYS_TARGET_SSE42 int searchLIN_sse42(const int* arr, int n, int sr) {
+    const __m128i key = _mm_set1_epi32(sr);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i e0 = _mm_cmpeq_epi32(key, _mm_loadu_si128((const __m128i*)(arr + i)));
+        __m128i e1 = _mm_cmpeq_epi32(key, _mm_loadu_si128((const __m128i*)(arr + i + 4)));
+        __m128i e2 = _mm_cmpeq_epi32(key, _mm_loadu_si128((const __m128i*)(arr + i + 8)));
+        __m128i e3 = _mm_cmpeq_epi32(key, _mm_loadu_si128((const __m128i*)(arr + i + 12)));
+        if (!_mm_testz_si128(_mm_or_si128(_mm_or_si128(e0, e1), _mm_or_si128(e2, e3)), _mm_set1_epi32(-1))) {
+            unsigned int mask = (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(e0))
+                | ((unsigned int)_mm_movemask_ps(_mm_castsi128_ps(e1)) << 4)
+                | ((unsigned int)_mm_movemask_ps(_mm_castsi128_ps(e2)) << 8)
+                | ((unsigned int)_mm_movemask_ps(_mm_castsi128_ps(e3)) << 12);
+            return i + __builtin_ctz(mask);
+        }
+    }
+    for (; i < n; ++i) {
+        if (arr[i] == sr)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief SSE4.2 countOccurrences: comparison masks (-1 per match) are subtracted from lane counters.
+ */
+static ARRAYS_TARGET_SSE42 int countOccurrences_sse42(const int* arr, int n, int sr) {
+    const __m128i key = _mm_set1_epi32(sr);
+    __m128i c0 = _mm_setzero_si128();
+    __m128i c1 = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        c0 = _mm_sub_epi32(c0, _mm_cmpeq_epi32(key, _mm_loadu_si128((const __m128i*)(arr + i))));
+        c1 = _mm_sub_epi32(c1, _mm_cmpeq_epi32(key, _mm_loadu_si128((const __m128i*)(arr + i + 4))));
+    }
+    int lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, _mm_add_epi32(c0, c1));
+    int count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; ++i) {
+        count += (arr[i] == sr);
+    }
+    return count;
+}
+
+/**
+ * @brief SSE4.2 searchAll: turns each 4-lane comparison into a bit mask and emits one index per set bit.
+ */
+static ARRAYS_TARGET_SSE42 int searchAll_sse42(const int* arr, int n, int sr, int* indices, int capacity) {
+    const __m128i key = _mm_set1_epi32(sr);
+    int count = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        unsigned int mask = (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(
+            _mm_cmpeq_epi32(key, _mm_loadu_si128((const __m128i*)(arr + i)))));
+        while (mask) {
+            if (count < capacity)
+                indices[count] = i + __builtin_ctz(mask);
+            count++;
+            mask &= mask - 1;
+        }
+    }
+    for (; i < n; ++i) {
+        if (arr[i] == sr) {
+            if (count < capacity)
+                indices[count] = i;
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief AVX2 searchLIN: compares 32 elements per iteration and only looks for the exact
+ * lane once a block contains a match.
+ */
+static ARRAYS_TARGET_AVX2 int searchLIN_avx2(const int* arr, int n, int sr) {
+    const __m256i key = _mm256_set1_epi32(sr);
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i e0 = _mm256_cmpeq_epi32(key, _mm256_loadu_si256((const __m256i*)(arr + i)));
+        __m256i e1 = _mm256_cmpeq_epi32(key, _mm256_loadu_si256((const __m256i*)(arr + i + 8)));
+        __m256i e2 = _mm256_cmpeq_epi32(key, _mm256_loadu_si256((const __m256i*)(arr + i + 16)));
+        __m256i e3 = _mm256_cmpeq_epi32(key, _mm256_loadu_si256((const __m256i*)(arr + i + 24)));
+        __m256i any = _mm256_or_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e2, e3));
+        if (!_mm256_testz_si256(any, any)) {
+            unsigned int mask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(e0))
+                | ((unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(e1)) << 8)
+                | ((unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(e2)) << 16)
+                | ((unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(e3)) << 24);
+            return i + __builtin_ctz(mask);
+        }
+    }
+    for (; i + 8 <= n; i += 8) {
+        unsigned int mask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(key, _mm256_loadu_si256((const __m256i*)(arr + i)))));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    for (; i < n; ++i) {
+        if (arr[i] == sr)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief AVX2 countOccurrences: comparison masks (-1 per match) are subtracted from lane counters.
+ */
+static ARRAYS_TARGET_AVX2 int countOccurrences_avx2(const int* arr, int n, int sr) {
+    const __m256i key = _mm256_set1_epi32(sr);
+    __m256i c0 = _mm256_setzero_si256();
+    __m256i c1 = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        c0 = _mm256_sub_epi32(c0, _mm256_cmpeq_epi32(key, _mm256_loadu_si256((const __m256i*)(arr + i))));
+        c1 = _mm256_sub_epi32(c1, _mm256_cmpeq_epi32(key, _mm256_loadu_si256((const __m256i*)(arr + i + 8))));
+    }
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi32(c0, c1));
+    int count = 0;
+    for (int lane = 0; lane < 8; ++lane) {
+        count += lanes[lane];
+    }
+    for (; i < n; ++i) {
+        count += (arr[i] == sr);
+    }
+    return count;
+}
+
+/**
+ * @brief AVX2 searchAll: turns each 8-lane comparison into a bit mask and emits one index per set bit.
+ */
+static ARRAYS_TARGET_AVX2 int searchAll_avx2(const int* arr, int n, int sr, int* indices, int capacity) {
+    const __m256i key = _mm256_set1_epi32(sr);
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        unsigned int mask = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(key, _mm256_loadu_si256((const __m256i*)(arr + i)))));
+        while (mask) {
+            if (count < capacity)
+                indices[count] = i + __builtin_ctz(mask);
+            count++;
+            mask &= mask - 1;
+        }
+    }
+    for (; i < n; ++i) {
+        if (arr[i] == sr) {
+            if (count < capacity)
+                indices[count] = i;
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief AVX-512 searchLIN: compares 32 elements per iteration into mask registers; the tail
+ * uses a masked load.
+ */
+static ARRAYS_TARGET_AVX512 int searchLIN_avx512(const int* arr, int n, int sr) {
+    const __m512i key = _mm512_set1_epi32(sr);
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __mmask16 m0 = _mm512_cmpeq_epi32_mask(key, _mm512_loadu_si512((const void*)(arr + i)));
+        __mmask16 m1 = _mm512_cmpeq_epi32_mask(key, _mm512_loadu_si512((const void*)(arr + i + 16)));
+        if (m0 | m1)
+            return i + __builtin_ctz((unsigned int)m0 | ((unsigned int)m1 << 16));
+    }
+    for (; i < n; i += 16) {
+        __mmask16 valid = n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        __mmask16 m = _mm512_mask_cmpeq_epi32_mask(valid, key, _mm512_maskz_loadu_epi32(valid, arr + i));
+        if (m)
+            return i + __builtin_ctz((unsigned int)m);
+    }
+    return -1;
+}
+
+/**
+ * @brief AVX-512 countOccurrences: population count of the comparison masks.
+ */
+static ARRAYS_TARGET_AVX512 int countOccurrences_avx512(const int* arr, int n, int sr) {
+    const __m512i key = _mm512_set1_epi32(sr);
+    int count = 0;
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __mmask16 m0 = _mm512_cmpeq_epi32_mask(key, _mm512_loadu_si512((const void*)(arr + i)));
+        __mmask16 m1 = _mm512_cmpeq_epi32_mask(key, _mm512_loadu_si512((const void*)(arr + i + 16)));
+        count += __builtin_popcount((unsigned int)m0 | ((unsigned int)m1 << 16));
+    }
+    for (; i < n; i += 16) {
+        __mmask16 valid = n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        count += __builtin_popcount((unsigned int)_mm512_mask_cmpeq_epi32_mask(valid, key, _mm512_maskz_loadu_epi32(valid, arr + i)));
+    }
+    return count;
+}
+
+/**
+ * @brief AVX-512 searchAll: compress-stores the indices of matching lanes while the buffer has room.
+ */
+static ARRAYS_TARGET_AVX512 int searchAll_avx512(const int* arr, int n, int sr, int* indices, int capacity) {
+    const __m512i key = _mm512_set1_epi32(sr);
+    const __m512i step = _mm512_set1_epi32(16);
+    __m512i position = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    int count = 0;
+    for (int i = 0; i < n; i += 16) {
+        __mmask16 valid = n - i >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+        __mmask16 m = _mm512_mask_cmpeq_epi32_mask(valid, key, _mm512_maskz_loadu_epi32(valid, arr + i));
+        if (m) {
+            int matches = __builtin_popcount((unsigned int)m);
+            if (count + matches <= capacity) {
+                _mm512_mask_compressstoreu_epi32(indices + count, m, position);
+            } else {
+                int stored = count;
+                for (unsigned int bits = m; bits && stored < capacity; bits &= bits - 1) {
+                    indices[stored++] = i + __builtin_ctz(bits);
+                }
+            }
+            count += matches;
+        }
+        position = _mm512_add_epi32(position, step);
+    }
+    return count;
+}
+
+static ARRAYS_TARGET_SSE42 int firstIndexOf_sse42(int* arr, int n, int element) {
+    return searchLIN_sse42(arr, n, element);
+}
+
+static ARRAYS_TARGET_AVX2 int firstIndexOf_avx2(int* arr, int n, int element) {
+    return searchLIN_avx2(arr, n, element);
+}
+
+static ARRAYS_TARGET_AVX512 int firstIndexOf_avx512(int* arr, int n, int element) {
+    return searchLIN_avx512(arr, n, element);
+}
+
+/**
+ * @brief Wide-lane hash stripe kernels: the eight lanes of hashStripes, two, four or eight at a time.
+ */
+static ARRAYS_TARGET_SSE42 void hashStripes_sse42(uint64_t* acc, const int* data, size_t stripes) {
+    __m128i a[4], k[4];
+    for (int j = 0; j < 4; ++j) {
+        a[j] = _mm_loadu_si128((const __m128i*)(acc + 2 * j));
+        k[j] = _mm_loadu_si128((const __m128i*)(arraysHashSecret + 2 * j));
+    }
+    for (size_t s = 0; s < stripes; ++s, data += 16) {
+        for (int j = 0; j < 4; ++j) {
+            __m128i word = _mm_loadu_si128((const __m128i*)(data + 4 * j));
+            __m128i keyed = _mm_xor_si128(word, k[j]);
+            __m128i product = _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32));
+            a[j] = _mm_add_epi64(a[j], _mm_add_epi64(product, _mm_shuffle_epi32(word, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+    }
+    for (int j = 0; j < 4; ++j)
+        _mm_storeu_si128((__m128i*)(acc + 2 * j), a[j]);
+}
+
+static ARRAYS_TARGET_AVX2 void hashStripes_avx2(uint64_t* acc, const int* data, size_t stripes) {
+    __m256i a0 = _mm256_loadu_si256((const __m256i*)acc);
+    __m256i a1 = _mm256_loadu_si256((const __m256i*)(acc + 4));
+    const __m256i k0 = _mm256_loadu_si256((const __m256i*)arraysHashSecret);
+    const __m256i k1 = _mm256_loadu_si256((const __m256i*)(arraysHashSecret + 4));
+    for (size_t s = 0; s < stripes; ++s, data += 16) {
+        __m256i w0 = _mm256_loadu_si256((const __m256i*)data);
+        __m256i w1 = _mm256_loadu_si256((const __m256i*)(data + 8));
+        __m256i x0 = _mm256_xor_si256(w0, k0);
+        __m256i x1 = _mm256_xor_si256(w1, k1);
+        __m256i p0 = _mm256_mul_epu32(x0, _mm256_srli_epi64(x0, 32));
+        __m256i p1 = _mm256_mul_epu32(x1, _mm256_srli_epi64(x1, 32));
+        a0 = _mm256_add_epi64(a0, _mm256_add_epi64(p0, _mm256_shuffle_epi32(w0, _MM_SHUFFLE(1, 0, 3, 2))));
+        a1 = _mm256_add_epi64(a1, _mm256_add_epi64(p1, _mm256_shuffle_epi32(w1, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+    _mm256_storeu_si256((__m256i*)acc, a0);
+    _mm256_storeu_si256((__m256i*)(acc + 4), a1);
+}
+
+static ARRAYS_TARGET_AVX512 void hashStripes_avx512(uint64_t* acc, const int* data, size_t stripes) {
+    __m512i a = _mm512_loadu_si512((const void*)acc);
+    const __m512i k = _mm512_loadu_si512((const void*)arraysHashSecret);
+    for (size_t s = 0; s < stripes; ++s, data += 16) {
+        __m512i word = _mm512_loadu_si512((const void*)data);
+        __m512i keyed = _mm512_xor_si512(word, k);
+        __m512i product = _mm512_mul_epu32(keyed, _mm512_srli_epi64(keyed, 32));
+        a = _mm512_add_epi64(a, _mm512_add_epi64(product, _mm512_shuffle_epi32(word, _MM_PERM_BADC)));
+    }
+    _mm512_storeu_si512((void*)acc, a);
+}
+
+/**
+ * @brief Vectorized firstMismatch: compares 4, 8 or 16 pairs of ints per step with one mask test.
+ */
+static ARRAYS_TARGET_SSE42 int firstMismatch_sse42(const int* arr1, int size1, const int* arr2, int size2) {
+    int n = size1 < size2 ? size1 : size2;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i e0 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(arr1 + i)), _mm_loadu_si128((const __m128i*)(arr2 + i)));
+        __m128i e1 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(arr1 + i + 4)), _mm_loadu_si128((const __m128i*)(arr2 + i + 4)));
+        unsigned int m = (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(e0)) | ((unsigned int)_mm_movemask_ps(_mm_castsi128_ps(e1)) << 4);
+        if (m != 0xFFu)
+            return i + __builtin_ctz(~m);
+    }
+    for (; i < n; ++i) {
+        if (arr1[i] != arr2[i])
+            return i;
+    }
+    return mismatchResult(-1, size1, size2);
+}
+
+static ARRAYS_TARGET_AVX2 int firstMismatch_avx2(const int* arr1, int size1, const int* arr2, int size2) {
+    int n = size1 < size2 ? size1 : size2;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i e0 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(arr1 + i)), _mm256_loadu_si256((const __m256i*)(arr2 + i)));
+        __m256i e1 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(arr1 + i + 8)), _mm256_loadu_si256((const __m256i*)(arr2 + i + 8)));
+        unsigned int m = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(e0)) | ((unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(e1)) << 8);
+        if (m != 0xFFFFu)
+            return i + __builtin_ctz(~m);
+    }
+    for (; i < n; ++i) {
+        if (arr1[i] != arr2[i])
+            return i;
+    }
+    return mismatchResult(-1, size1, size2);
+}
+
+static ARRAYS_TARGET_AVX512 int firstMismatch_avx512(const int* arr1, int size1, const int* arr2, int size2) {
+    int n = size1 < size2 ? size1 : size2;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __mmask16 m = _mm512_cmpneq_epi32_mask(_mm512_loadu_si512((const void*)(arr1 + i)), _mm512_loadu_si512((const void*)(arr2 + i)));
+        if (m)
+            return i + __builtin_ctz((unsigned int)m);
+    }
+    if (i < n) {
+        __mmask16 tail = (__mmask16)((1u << (n - i)) - 1);
+        __mmask16 m = _mm512_mask_cmpneq_epi32_mask(tail, _mm512_maskz_loadu_epi32(tail, arr1 + i), _mm512_maskz_loadu_epi32(tail, arr2 + i));
+        if (m)
+            return i + __builtin_ctz((unsigned int)m);
+    }
+    return mismatchResult(-1, size1, size2);
+}
+
+/**
+ * @brief Block intersection/difference: compares 4 (or 8) elements of arr1 with all rotations
+ * of 4 (or 8) elements of arr2, accumulates the matches of the arr1 block, and advances the block
+ * with the smaller last element.
+ */
+static ARRAYS_TARGET_SSE42 int filterSorted_sse42(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity, bool keep) {
+    int i = 0, j = 0, written = 0;
+    unsigned int found = 0;
+    while (i + 4 <= size1 && j + 4 <= size2 && written + 4 <= capacity) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(arr1 + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(arr2 + j));
+        __m128i e = _mm_cmpeq_epi32(a, b);
+        e = _mm_or_si128(e, _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1))));
+        e = _mm_or_si128(e, _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2))));
+        e = _mm_or_si128(e, _mm_cmpeq_epi32(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3))));
+        found |= (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(e));
+        if (arr1[i + 3] <= arr2[j + 3]) {
+            unsigned int emit = keep ? found : ~found & 0xFu;
+            for (; emit; emit &= emit - 1)
+                dest[written++] = arr1[i + __builtin_ctz(emit)];
+            found = 0;
+            i += 4;
+        } else {
+            j += 4;
+        }
+    }
+    return filterSortedFinish(arr1, size1, arr2, size2, dest, capacity, keep, i, j, written, found, 4);
+}
+
+static ARRAYS_TARGET_AVX2 int filterSorted_avx2(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity, bool keep) {
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    int i = 0, j = 0, written = 0;
+    unsigned int found = 0;
+    while (i + 8 <= size1 && j + 8 <= size2 && written + 8 <= capacity) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(arr1 + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(arr2 + j));
+        __m256i e = _mm256_cmpeq_epi32(a, b);
+        for (int r = 1; r < 8; ++r) {
+            b = _mm256_permutevar8x32_epi32(b, rotate);
+            e = _mm256_or_si256(e, _mm256_cmpeq_epi32(a, b));
+        }
+        found |= (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(e));
+        if (arr1[i + 7] <= arr2[j + 7]) {
+            unsigned int emit = keep ? found : ~found & 0xFFu;
+            for (; emit; emit &= emit - 1)
+                dest[written++] = arr1[i + __builtin_ctz(emit)];
+            found = 0;
+            i += 8;
+        } else {
+            j += 8;
+        }
+    }
+    return filterSortedFinish(arr1, size1, arr2, size2, dest, capacity, keep, i, j, written, found, 8);
+}
+
+/**
+ * @brief Vectorized applyPermutation: 8 or 16 indices per hardware gather.
+ */
+static ARRAYS_TARGET_AVX2 void applyPermutation_avx2(const int* src, const int* indices, int n, int* dest) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i index = _mm256_loadu_si256((const __m256i*)(indices + i));
+        _mm256_storeu_si256((__m256i*)(dest + i), _mm256_i32gather_epi32(src, index, 4));
+    }
+    for (; i < n; ++i)
+        dest[i] = src[indices[i]];
+}
+
+static ARRAYS_TARGET_AVX512 void applyPermutation_avx512(const int* src, const int* indices, int n, int* dest) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i index = _mm512_loadu_si512((const void*)(indices + i));
+        _mm512_storeu_si512((void*)(dest + i), _mm512_i32gather_epi32(index, (const void*)src, 4));
+    }
+    for (; i < n; ++i)
+        dest[i] = src[indices[i]];
+}
+
+#endif
+
+#ifdef ARRAYS_NEON_SIMD
+
+/**
+ * @brief NEON getminOf: four independent 4-lane accumulators, 16 elements per iteration.
+ */
+static int getminOf_neon(const int* arr, int n) {
+    if (n <= 0)
+        return 0;
+    int i = 0;
+    int minimum = arr[0];
+    if (n >= 16) {
+        int32x4_t m0 = vld1q_s32(arr);
+        int32x4_t m1 = m0, m2 = m0, m3 = m0;
+        for (; i + 16 <= n; i += 16) {
+            m0 = vminq_s32(m0, vld1q_s32(arr + i));
+            m1 = vminq_s32(m1, vld1q_s32(arr + i + 4));
+            m2 = vminq_s32(m2, vld1q_s32(arr + i + 8));
+            m3 = vminq_s32(m3, vld1q_s32(arr + i + 12));
+        }
+        minimum = vminvq_s32(vminq_s32(vminq_s32(m0, m1), vminq_s32(m2, m3)));
+    }
+    for (; i < n; ++i) {
+        if (arr[i] < minimum)
+            minimum = arr[i];
+    }
+    return minimum;
+}
+
+/**
+ * @brief NEON getmaxOf: four independent 4-lane accumulators, 16 elements per iteration.
+ */
+static int getmaxOf_neon(const int* arr, int n) {
+    if (n <= 0)
+        return 0;
+    int i = 0;
+    int maximum = arr[0];
+    if (n >= 16) {
+        int32x4_t m0 = vld1q_s32(arr);
+        int32x4_t m1 = m0, m2 = m0, m3 = m0;
+        for (; i + 16 <= n; i += 16) {
+            m0 = vmaxq_s32(m0, vld1q_s32(arr + i));
+            m1 = vmaxq_s32(m1, vld1q_s32(arr + i + 4));
+            m2 = vmaxq_s32(m2, vld1q_s32(arr + i + 8));
+            m3 = vmaxq_s32(m3, vld1q_s32(arr + i + 12));
+        }
+        maximum = vmaxvq_s32(vmaxq_s32(vmaxq_s32(m0, m1), vmaxq_s32(m2, m3)));
+    }
+    for (; i < n; ++i) {
+        if (arr[i] > maximum)
+            maximum = arr[i];
+    }
+    return maximum;
+}
+
+/**
+ * @brief NEON getMinMaxOf: both reductions share every load.
+ */
+static void getMinMaxOf_neon(const int* arr, int n, int* minimum, int* maximum) {
+    if (n <= 0) {
+        *minimum = 0;
+        *maximum = 0;
+        return;
+    }
+    int i = 0;
+    int low = arr[0];
+    int high = arr[0];
+    if (n >= 8) {
+        int32x4_t lo0 = vld1q_s32(arr);
+        int32x4_t lo1 = lo0, hi0 = lo0, hi1 = lo0;
+        for (; i + 8 <= n; i += 8) {
+            int32x4_t a = vld1q_s32(arr + i);
+            int32x4_t b = vld1q_s32(arr + i + 4);
+            lo0 = vminq_s32(lo0, a);
+            hi0 = vmaxq_s32(hi0, a);
+            lo1 = vminq_s32(lo1, b);
+            hi1 = vmaxq_s32(hi1, b);
+        }
+        low = vminvq_s32(vminq_s32(lo0, lo1));
+        high = vmaxvq_s32(vmaxq_s32(hi0, hi1));
+    }
+    for (; i < n; ++i) {
+        if (arr[i] < low)
+            low = arr[i];
+        if (arr[i] > high)
+            high = arr[i];
+    }
+    *minimum = low;
+    *maximum = high;
+}
+
+/**
+ * @brief NEON sumAllElements: pairwise add-and-widen into 64-bit lanes.
+ */
+static long long sumAllElements_neon(int* arr, int n) {
+    int i = 0;
+    int64x2_t s0 = vdupq_n_s64(0);
+    int64x2_t s1 = vdupq_n_s64(0);
+    for (; i + 8 <= n; i += 8) {
+        s0 = vpadalq_s32(s0, vld1q_s32(arr + i));
+        s1 = vpadalq_s32(s1, vld1q_s32(arr + i + 4));
+    }
+    long long sum = vaddvq_s64(vaddq_s64(s0, s1));
+    for (; i < n; ++i) {
+        sum += arr[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief NEON prefix sums: four elements widened into two pairs of 64-bit lanes per step.
+ */
+static long long prefixSums_neon(const int* arr, size_t n, long long* dest, long long carry, bool inclusive) {
+    size_t i = 0;
+    int64x2_t zero = vdupq_n_s64(0);
+    int64x2_t total = vdupq_n_s64(carry);
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t x = vld1q_s32(arr + i);
+        int64x2_t x0 = vmovl_s32(vget_low_s32(x));
+        int64x2_t x1 = vmovl_s32(vget_high_s32(x));
+        int64x2_t v0 = vaddq_s64(x0, vextq_s64(zero, x0, 1));
+        int64x2_t v1 = vaddq_s64(x1, vextq_s64(zero, x1, 1));
+        v1 = vaddq_s64(v1, vdupq_laneq_s64(v0, 1));
+        v0 = vaddq_s64(v0, total);
+        v1 = vaddq_s64(v1, total);
+        total = vdupq_laneq_s64(v1, 1);
+        if (!inclusive) {
+            v0 = vsubq_s64(v0, x0);
+            v1 = vsubq_s64(v1, x1);
+        }
+        vst1q_s64((int64_t*)(dest + i), v0);
+        vst1q_s64((int64_t*)(dest + i + 2), v1);
+    }
+    return prefixSums(arr + i, n - i, dest + i, vgetq_lane_s64(total, 0), inclusive);
+}
+
+/**
+ * @brief NEON MAX_count: per-lane maxima and counts, updated with comparison masks.
+ */
+static int MAX_count_neon(const int* arr, int n) {
+    if (n < 8)
+        return MAX_count(arr, n);
+    const int32x4_t one = vdupq_n_s32(1);
+    int32x4_t maxima = vld1q_s32(arr);
+    int32x4_t counts = one;
+    int i = 4;
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t v = vld1q_s32(arr + i);
+        uint32x4_t greater = vcgtq_s32(v, maxima);
+        uint32x4_t equal = vceqq_s32(v, maxima);
+        counts = vbslq_s32(greater, one, vsubq_s32(counts, vreinterpretq_s32_u32(equal)));
+        maxima = vmaxq_s32(maxima, v);
+    }
+    int maximum = vmaxvq_s32(maxima);
+    for (int j = i; j < n; ++j) {
+        if (arr[j] > maximum)
+            maximum = arr[j];
+    }
+    uint32x4_t winners = vceqq_s32(maxima, vdupq_n_s32(maximum));
+    int count = vaddvq_s32(vandq_s32(counts, vreinterpretq_s32_u32(winners)));
+    for (; i < n; ++i) {
+        if (arr[i] == maximum)
+            count++;
+    }
+    return count;
+}
+
+/**
+ * @brief NEON searchLIN: compares 16 elements per iteration and only looks for the exact
+ * lane once a block contains a match.
+ */
+static int searchLIN_neon(const int* arr, int n, int sr) {
+    const int32x4_t key = vdupq_n_s32(sr);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint32x4_t e0 = vceqq_s32(key, vld1q_s32(arr + i));
+        uint32x4_t e1 = vceqq_s32(key, vld1q_s32(arr + i + 4));
+        uint32x4_t e2 = vceqq_s32(key, vld1q_s32(arr + i + 8));
+        uint32x4_t e3 = vceqq_s32(key, vld1q_s32(arr + i + 12));
+        if (vmaxvq_u32(vorrq_u32(vorrq_u32(e0, e1), vorrq_u32(e2, e3))) != 0) {
+            for (int j = i;; ++j) {
+                if (arr[j] == sr)
+                    return j;
+            }
+        }
+    }
+    for (; i < n; ++i) {
+        if (arr[i] == sr)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief NEON countOccurrences: comparison masks (-1 per match) are subtracted from lane counters.
+ */
+static int countOccurrences_neon(const int* arr, int n, int sr) {
+    const int32x4_t key = vdupq_n_s32(sr);
+    int32x4_t c0 = vdupq_n_s32(0);
+    int32x4_t c1 = vdupq_n_s32(0);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        c0 = vsubq_s32(c0, vreinterpretq_s32_u32(vceqq_s32(key, vld1q_s32(arr + i))));
+        c1 = vsubq_s32(c1, vreinterpretq_s32_u32(vceqq_s32(key, vld1q_s32(arr + i + 4))));
+    }
+    int count = vaddvq_s32(vaddq_s32(c0, c1));
+    for (; i < n; ++i) {
+        count += (arr[i] == sr);
+    }
+    return count;
+}
+
+static int firstIndexOf_neon(int* arr, int n, int element) {
+    return searchLIN_neon(arr, n, element);
+}
+
+/**
+ * @brief NEON searchAll: tests eight elements per step and only walks the lanes of a block
+ * that contains a match.
+ */
+static int searchAll_neon(const int* arr, int n, int sr, int* indices, int capacity) {
+    const int32x4_t key = vdupq_n_s32(sr);
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint32x4_t e0 = vceqq_s32(key, vld1q_s32(arr + i));
+        uint32x4_t e1 = vceqq_s32(key, vld1q_s32(arr + i + 4));
+        if (vmaxvq_u32(vorrq_u32(e0, e1)) == 0)
+            continue;
+        for (int t = i; t < i + 8; ++t) {
+            if (arr[t] == sr) {
+                if (count < capacity)
+                    indices[count] = t;
+                count++;
+            }
+        }
+    }
+    for (; i < n; ++i) {
+        if (arr[i] == sr) {
+            if (count < capacity)
+                indices[count] = i;
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief NEON wide-lane hash stripe kernel: the eight lanes of hashStripes, two at a time.
+ */
+static void hashStripes_neon(uint64_t* acc, const int* data, size_t stripes) {
+    uint64x2_t a[4], k[4];
+    for (int j = 0; j < 4; ++j) {
+        a[j] = vld1q_u64(acc + 2 * j);
+        k[j] = vld1q_u64(arraysHashSecret + 2 * j);
+    }
+    for (size_t s = 0; s < stripes; ++s, data += 16) {
+        for (int j = 0; j < 4; ++j) {
+            uint64x2_t word = vreinterpretq_u64_s32(vld1q_s32(data + 4 * j));
+            uint64x2_t keyed = veorq_u64(word, k[j]);
+            uint64x2_t product = vmull_u32(vmovn_u64(keyed), vshrn_n_u64(keyed, 32));
+            a[j] = vaddq_u64(a[j], vaddq_u64(product, vextq_u64(word, word, 1)));
+        }
+    }
+    for (int j = 0; j < 4; ++j)
+        vst1q_u64(acc + 2 * j, a[j]);
+}
+
+/**
+ * @brief NEON firstMismatch: eight pairs of ints per step, reduced with one horizontal minimum.
+ */
+static int firstMismatch_neon(const int* arr1, int size1, const int* arr2, int size2) {
+    int n = size1 < size2 ? size1 : size2;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint32x4_t e0 = vceqq_s32(vld1q_s32(arr1 + i), vld1q_s32(arr2 + i));
+        uint32x4_t e1 = vceqq_s32(vld1q_s32(arr1 + i + 4), vld1q_s32(arr2 + i + 4));
+        if (vminvq_u32(vandq_u32(e0, e1)) == 0)
+            break;
+    }
+    for (; i < n; ++i) {
+        if (arr1[i] != arr2[i])
+            return i;
+    }
+    return mismatchResult(-1, size1, size2);
+}
+
+/**
+ * @brief NEON block intersection/difference: 4 elements of arr1 against all rotations of 4 of arr2.
+ */
+static int filterSorted_neon(const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity, bool keep) {
+    const uint32x4_t bits = {1, 2, 4, 8};
+    int i = 0, j = 0, written = 0;
+    unsigned int found = 0;
+    while (i + 4 <= size1 && j + 4 <= size2 && written + 4 <= capacity) {
+        int32x4_t a = vld1q_s32(arr1 + i);
+        int32x4_t b = vld1q_s32(arr2 + j);
+        uint32x4_t e = vceqq_s32(a, b);
+        e = vorrq_u32(e, vceqq_s32(a, vextq_s32(b, b, 1)));
+        e = vorrq_u32(e, vceqq_s32(a, vextq_s32(b, b, 2)));
+        e = vorrq_u32(e, vceqq_s32(a, vextq_s32(b, b, 3)));
+        found |= vaddvq_u32(vandq_u32(e, bits));
+        if (arr1[i + 3] <= arr2[j + 3]) {
+            unsigned int emit = keep ? found : ~found & 0xFu;
+            for (; emit; emit &= emit - 1)
+                dest[written++] = arr1[i + ARRAYS_CTZ(emit)];
+            found = 0;
+            i += 4;
+        } else {
+            j += 4;
+        }
+    }
+    return filterSortedFinish(arr1, size1, arr2, size2, dest, capacity, keep, i, j, written, found, 4);
+}
+
+#endif
+
+
+/**
+ * 64-bit sizes.
+ *
+ * Arrays64 mirrors the int-sized functions of Arrays with size_t sizes and ptrdiff_t indices
+ * (-1 when not found), for arrays of more than INT_MAX elements. Scans are split into chunks of
+ * ARRAYS_LARGE_CHUNK elements and each chunk runs through the kernel currently installed in
+ * Arrays, so the SIMD paths apply unchanged; sums are accumulated in int64_t.
+ * useArrayFunctions() initializes Arrays64 along with Arrays.
+ */
+
+/**
+ * Number of elements each Arrays64 function hands to an int-sized kernel at a time. Must be
+ * at most INT_MAX. Define before including this header to override.
+ */
+#ifndef ARRAYS_LARGE_CHUNK
+#define ARRAYS_LARGE_CHUNK ((size_t)1 << 30)
+#endif
+
+/**
+ * @brief Size of the next chunk of a scan that has `remaining` elements left.
+ */
+static inline int largeChunk(size_t remaining) {
+    return (int)(remaining < ARRAYS_LARGE_CHUNK ? remaining : ARRAYS_LARGE_CHUNK);
+}
+
+/**
+ * Function: copyOfRange64
+ * -----------------------
+ * Creates a copy of the range [start, end) of an array.
+ *
+ * Returns:
+ * A new array containing the range, or NULL if end < start or memory could not be allocated.
+ * NOTE: The array returned must be released explicitly by the user (Arrays.release).
+ */
+inline int* copyOfRange64(const int* arr, ptrdiff_t start, ptrdiff_t end) {
+    if (end < start)
+        return NULL;
+    size_t count = (size_t)(end - start);
+    int *ret_arr = (int*)arraysAlloc((count ? count : 1) * sizeof(int));
+    if (ret_arr == NULL)
+        return NULL;
+    copyInts(ret_arr, arr + start, count);
+    return ret_arr;
+}
+
+/**
+ * Function: copyOfRangeInto64
+ * ---------------------------
+ * Copies the range [start, end) of an array into a caller-provided buffer of `capacity` ints.
+ *
+ * Returns:
+ * The number of elements written.
+ */
+inline size_t copyOfRangeInto64(const int* arr, ptrdiff_t start, ptrdiff_t end, int* dest, size_t capacity) {
+    if (end <= start)
+        return 0;
+    size_t count = (size_t)(end - start) < capacity ? (size_t)(end - start) : capacity;
+    copyInts(dest, arr + start, count);
+    return count;
+}
+
+/**
+ * Function: reverse64
+ * -------------------
+ * Reverses the elements of an array in-place.
+ */
+inline int* reverse64(int* arr, size_t n) {
+    for (size_t i = 0; i < n / 2; ++i) {
+        int temp = arr[i];
+        arr[i] = arr[n - i - 1];
+        arr[n - i - 1] = temp;
+    }
+    return arr;
+}
+
+/**
+ * @brief Reduces a rotation by k positions to the right of an n-element array to [0, n).
+ */
+static inline size_t rotationShift(size_t n, ptrdiff_t k) {
+    if (k >= 0)
+        return (size_t)k % n;
+    return n - 1 - (size_t)(-(k + 1)) % n;
+}
+
+/**
+ * Function: rotate64
+ * ------------------
+ * Rotates an array to the right by k positions (to the left for negative k), in O(n) time,
+ * with the same buffered and three-reversal strategies as rotate.
+ */
+inline int* rotate64(int* arr, size_t n, ptrdiff_t k) {
+    if (n <= 1)
+        return arr;
+    size_t shift = rotationShift(n, k);
+    if (shift == 0)
+        return arr;
+
+    int buffer[ARRAYS_ROTATE_BUFFER];
+    if (shift <= ARRAYS_ROTATE_BUFFER) {
+        memcpy(buffer, arr + n - shift, shift * sizeof(int));
+        memmove(arr + shift, arr, (n - shift) * sizeof(int));
+        memcpy(arr, buffer, shift * sizeof(int));
+    } else if (n - shift <= ARRAYS_ROTATE_BUFFER) {
+        memcpy(buffer, arr, (n - shift) * sizeof(int));
+        memmove(arr, arr + n - shift, shift * sizeof(int));
+        memcpy(arr + shift, buffer, (n - shift) * sizeof(int));
+    } else {
+        reverse64(arr, n);
+        reverse64(arr, shift);
+        reverse64(arr + shift, n - shift);
+    }
+    return arr;
+}
+
+/**
+ * Function: rotateLeft64
+ * ----------------------
+ * Rotates an array to the left by k positions (to the right for negative k).
+ */
+inline int* rotateLeft64(int* arr, size_t n, ptrdiff_t k) {
+    if (n <= 1)
+        return arr;
+    return rotate64(arr, n, (ptrdiff_t)(n - rotationShift(n, k)));
+}
+
+/**
+ * Function: searchLIN64
+ * ---------------------
+ * Returns the index of the first occurrence of a value, or -1 if not found.
+ */
+inline ptrdiff_t searchLIN64(const int* arr, size_t n, int sr) {
+    for (size_t offset = 0; offset < n; offset += ARRAYS_LARGE_CHUNK) {
+        int found = Arrays.searchLIN(arr + offset, largeChunk(n - offset), sr);
+        if (found >= 0)
+            return (ptrdiff_t)offset + found;
+    }
+    return -1;
+}
+
+/**
+ * Function: countOccurrences64
+ * ----------------------------
+ * Returns the number of occurrences of a value.
+ */
+inline size_t countOccurrences64(const int* arr, size_t n, int sr) {
+    size_t count = 0;
+    for (size_t offset = 0; offset < n; offset += ARRAYS_LARGE_CHUNK)
+        count += (size_t)Arrays.count(arr + offset, largeChunk(n - offset), sr);
+    return count;
+}
+
+/**
+ * Function: searchAll64
+ * ---------------------
+ * Stores the indices of the first `capacity` occurrences of a value in `indices`.
+ *
+ * Returns:
+ * The total number of occurrences, which may exceed capacity.
+ */
+inline size_t searchAll64(const int* arr, size_t n, int sr, ptrdiff_t* indices, size_t capacity) {
+    size_t found = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (arr[i] == sr) {
+            if (found < capacity)
+                indices[found] = (ptrdiff_t)i;
+            found++;
+        }
+    }
+    return found;
+}
+
+/**
+ * Function: searchBIN64
+ * ---------------------
+ * Returns the index of the first occurrence of a value in a sorted array, or -1 if not found.
+ */
+inline ptrdiff_t searchBIN64(const int* arr, size_t n, int sr) {
+    size_t start = 0, end = n;
+    while (start < end) {
+        size_t mid = start + (end - start) / 2;
+        if (arr[mid] < sr)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+    return (start < n && arr[start] == sr) ? (ptrdiff_t)start : -1;
+}
+
+/**
+ * Function: getminOf64
+ * --------------------
+ * Returns the minimum value of the array, or 0 if it is empty.
+ */
+inline int getminOf64(const int* arr, size_t n) {
+    if (n == 0)
+        return 0;
+    int minimum = arr[0];
+    for (size_t offset = 0; offset < n; offset += ARRAYS_LARGE_CHUNK) {
+        int value = Arrays.minValue(arr + offset, largeChunk(n - offset));
+        minimum = value < minimum ? value : minimum;
+    }
+    return minimum;
+}
+
+/**
+ * Function: getmaxOf64
+ * --------------------
+ * Returns the maximum value of the array, or 0 if it is empty.
+ */
+inline int getmaxOf64(const int* arr, size_t n) {
+    if (n == 0)
+        return 0;
+    int maximum = arr[0];
+    for (size_t offset = 0; offset < n; offset += ARRAYS_LARGE_CHUNK) {
+        int value = Arrays.maxValue(arr + offset, largeChunk(n - offset));
+        maximum = value > maximum ? value : maximum;
+    }
+    return maximum;
+}
+
+/**
+ * Function: getMinMaxOf64
+ * -----------------------
+ * Stores the minimum and the maximum value of the array (0 for both if it is empty).
+ */
+inline void getMinMaxOf64(const int* arr, size_t n, int* minimum, int* maximum) {
+    *minimum = 0;
+    *maximum = 0;
+    if (n == 0)
+        return;
+    *minimum = arr[0];
+    *maximum = arr[0];
+    for (size_t offset = 0; offset < n; offset += ARRAYS_LARGE_CHUNK) {
+        int low, high;
+        Arrays.minMax(arr + offset, largeChunk(n - offset), &low, &high);
+        *minimum = low < *minimum ? low : *minimum;
+        *maximum = high > *maximum ? high : *maximum;
+    }
+}
+
+/**
+ * Function: MAX_count64
+ * ---------------------
+ * Counts the occurrences of the maximum value in the array.
+ */
+inline size_t MAX_count64(const int* arr, size_t n) {
+    if (n == 0)
+        return 0;
+    return countOccurrences64(arr, n, getmaxOf64(arr, n));
+}
+
+/**
+ * Function: sumAllElements64
+ * --------------------------
+ * Returns the sum of all elements, accumulated in int64_t.
+ */
+inline int64_t sumAllElements64(const int* arr, size_t n) {
+    int64_t sum = 0;
+    for (size_t offset = 0; offset < n; offset += ARRAYS_LARGE_CHUNK)
+        sum += (int64_t)Arrays.sum((int*)(arr + offset), largeChunk(n - offset));
+    return sum;
+}
+
+/**
+ * Function: checkForSort64
+ * ------------------------
+ * Returns true if the array is sorted in ascending order.
+ */
+inline bool checkForSort64(const int* arr, size_t n) {
+    for (size_t offset = 0; offset < n; offset += ARRAYS_LARGE_CHUNK) {
+        if (offset > 0 && arr[offset] < arr[offset - 1])
+            return false;
+        if (!Arrays.isSorted((int*)(arr + offset), largeChunk(n - offset)))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Function: compareTwoArray64
+ * ---------------------------
+ * Returns true if the arrays are equal in size and content.
+ */
+inline bool compareTwoArray64(const int* arr1, size_t size1, const int* arr2, size_t size2) {
+    if (size1 != size2)
+        return false;
+    return size1 == 0 || memcmp(arr1, arr2, size1 * sizeof(int)) == 0;
+}
+
+/**
+ * Function: firstMismatch64
+ * -------------------------
+ * Returns the first index at which two arrays differ, the length of the shorter array if it is
+ * a prefix of the longer one, or -1 if they are equal. Runs Arrays.mismatch chunk by chunk.
+ */
+inline ptrdiff_t firstMismatch64(const int* arr1, size_t size1, const int* arr2, size_t size2) {
+    size_t n = size1 < size2 ? size1 : size2;
+    for (size_t offset = 0; offset < n; offset += ARRAYS_LARGE_CHUNK) {
+        int chunk = largeChunk(n - offset);
+        int found = Arrays.mismatch(arr1 + offset, chunk, arr2 + offset, chunk);
+        if (found >= 0)
+            return (ptrdiff_t)offset + found;
+    }
+    return size1 == size2 ? -1 : (ptrdiff_t)n;
+}
+
+/**
+ * Function: compareArrays64
+ * -------------------------
+ * Compares two arrays lexicographically; returns a negative value, zero or a positive value.
+ */
+inline int compareArrays64(const int* arr1, size_t size1, const int* arr2, size_t size2) {
+    ptrdiff_t at = firstMismatch64(arr1, size1, arr2, size2);
+    if (at < 0)
+        return 0;
+    if ((size_t)at == size1 || (size_t)at == size2)
+        return size1 < size2 ? -1 : 1;
+    return arr1[at] < arr2[at] ? -1 : 1;
+}
+
+/**
+ * Function: concatenateTwoArrays64
+ * --------------------------------
+ * Concatenates two arrays into a new array, or returns NULL if memory could not be allocated.
+ * NOTE: The array returned must be released explicitly by the user (Arrays.release).
+ */
+inline int* concatenateTwoArrays64(const int* arr1, size_t size1, const int* arr2, size_t size2) {
+    size_t total = size1 + size2;
+    int* new_array = (int*)arraysAlloc((total ? total : 1) * sizeof(int));
+    if (new_array == NULL)
+        return NULL;
+    copyInts(new_array, arr1, size1);
+    copyInts(new_array + size1, arr2, size2);
+    return new_array;
+}
+
+/**
+ * Function: getHashCodeOf64
+ * -------------------------
+ * Returns the same hash code as getHashCodeOf, for arrays of any size.
+ */
+inline unsigned long long getHashCodeOf64(const int* arr, size_t n) {
+    if (arr == NULL)
+        return 0;
+    unsigned long long hash = 1;
+    for (size_t i = 0; i < n; i++) {
+        int val = arr[i];
+        val = val ^ (val >> 31);
+        hash = hash * 19 + val;
+    }
+    return hash;
+}
+
+/**
+ * Function: radixSort64
+ * ---------------------
+ * Sorts arr[low..high] (inclusive) with the LSD radix sort of radixSort.
+ *
+ * Returns:
+ * SUCCESS once the range is sorted, or FAILURE if no scratch buffer was given and allocating one failed.
+ */
+status_code radixSort64(int* arr, ptrdiff_t low, ptrdiff_t high, int* scratch) {
+    if (arr == NULL || low >= high)
+        return SUCCESS;
+    return radixSortKeys((unsigned int*)(arr + low), (size_t)(high - low) + 1, (unsigned int*)scratch);
+}
+
+/**
+ * @brief In-place heap sort of n ints, used by sort64 when the radix sort buffer cannot be allocated.
+ */
+static void heapSort64(int* arr, size_t n) {
+    if (n < 2)
+        return;
+    for (size_t start = n / 2; start-- > 0;) {
+        for (size_t root = start;;) {
+            size_t child = 2 * root + 1;
+            if (child >= n)
+                break;
+            if (child + 1 < n && arr[child] < arr[child + 1])
+                child++;
+            if (arr[root] >= arr[child])
+                break;
+            int temp = arr[root];
+            arr[root] = arr[child];
+            arr[child] = temp;
+            root = child;
+        }
+    }
+    for (size_t end = n - 1; end > 0; --end) {
+        int temp = arr[0];
+        arr[0] = arr[end];
+        arr[end] = temp;
+        for (size_t root = 0;;) {
+            size_t child = 2 * root + 1;
+            if (child >= end)
+                break;
+            if (child + 1 < end && arr[child] < arr[child + 1])
+                child++;
+            if (arr[root] >= arr[child])
+                break;
+            temp = arr[root];
+            arr[root] = arr[child];
+            arr[child] = temp;
+            root = child;
+        }
+    }
+}
+
+/**
+ * Function: sort64
+ * ----------------
+ * Sorts arr[low..high] (inclusive) in ascending order. Ranges that fit an int go to Arrays.sort;
+ * larger ones are radix sorted, or heap sorted in place if the radix buffer cannot be allocated.
+ */
+void sort64(int* arr, ptrdiff_t low, ptrdiff_t high) {
+    if (arr == NULL || low >= high)
+        return;
+    if (high - low < (ptrdiff_t)ARRAYS_LARGE_CHUNK) {
+        Arrays.sort(arr + low, 0, (int)(high - low));
+        return;
+    }
+    if (radixSort64(arr, low, high, NULL) != SUCCESS)
+        heapSort64(arr + low, (size_t)(high - low) + 1);
+}
+
+/**
+ * @brief Fills every slot of Arrays64.
+ */
+static void installLargeFunctions() {
+    Arrays64.copyOfRange = copyOfRange64;
+    Arrays64.copyOfRangeInto = copyOfRangeInto64;
+    Arrays64.rotate = rotate64;
+    Arrays64.rotateLeft = rotateLeft64;
+    Arrays64.searchLIN = searchLIN64;
+    Arrays64.count = countOccurrences64;
+    Arrays64.searchAll = searchAll64;
+    Arrays64.searchBIN = searchBIN64;
+    Arrays64.reverse = reverse64;
+    Arrays64.maxValue = getmaxOf64;
+    Arrays64.minValue = getminOf64;
+    Arrays64.minMax = getMinMaxOf64;
+    Arrays64.getMaxOccurrence = MAX_count64;
+    Arrays64.sort = sort64;
+    Arrays64.radixSort = radixSort64;
+    Arrays64.compare = compareTwoArray64;
+    Arrays64.mismatch = firstMismatch64;
+    Arrays64.compareOrder = compareArrays64;
+    Arrays64.sum = sumAllElements64;
+    Arrays64.isSorted = checkForSort64;
+    Arrays64.concat = concatenateTwoArrays64;
+    Arrays64.indexOf = searchLIN64;
+    Arrays64.hashCode = getHashCodeOf64;
+}
+
+
+/**
+ * Parallel reductions and transforms.
+ *
+ * These functions split [0, n) into ranges and run one pool task per range, each calling the
+ * kernel installed in Arrays for its range. Ranges are at least the parallel grain
+ * (setParallelGrain, ARRAYS_PARALLEL_GRAIN by default) and a multiple of a 4 KiB page, with their
+ * boundaries on page boundaries of the array that is written (or read, for reductions). No page
+ * or cache line is therefore shared by two tasks, and with the first-touch policy of Linux and
+ * other NUMA systems the pages of a freshly allocated destination end up on the node of the
+ * thread that fills them. Each task writes its partial result to a cache line of its own.
+ *
+ * - threads: Number of threads to use, including the caller. Values <= 0 use one thread per
+ *   online CPU, as in parallelSort. Small inputs and threads == 1 run on the calling thread.
+ */
+
+/**
+ * Ranges handed out per thread; more than one lets faster threads steal the remainder.
+ */
+#ifndef ARRAYS_PARALLEL_SPLIT
+#define ARRAYS_PARALLEL_SPLIT 4
+#endif
+
+/**
+ * Elements hashed independently by parallelHash before the chunk hashes are combined. Part of
+ * the definition of the parallelHash value.
+ */
+#ifndef ARRAYS_HASH_CHUNK
+#define ARRAYS_HASH_CHUNK 65536
+#endif
+
+#define ARRAYS_PAGE_INTS (4096 / sizeof(int))
+
+struct arrays_partial {
+    long long sum;
+    size_t count;
+    int minimum;
+    int maximum;
+    char padding[64 - sizeof(long long) - sizeof(size_t) - 2 * sizeof(int)];
+};
+
+struct arrays_parallel_job {
+    const int* src;
+    int* dest;
+    size_t n;
+    int value;
+    uint64_t seed;
+    uint64_t* hashes;
+    const struct histogram_spec* histogram;
+    ARRAYS_ATOMIC(size_t)* bins;
+    long long* scan;
+    const struct arrays_partial* carries;
+    struct arrays_partial* partials;
+};
+
+/**
+ * Function: setParallelGrain
+ * --------------------------
+ * Sets the smallest range, in elements, that the parallel functions hand to one task.
+ * 0 restores ARRAYS_PARALLEL_GRAIN.
+ */
+inline void setParallelGrain(size_t grain) {
+    ARRAYS_ATOMIC_STORE(&arraysParallelGrain, grain ? grain : (size_t)ARRAYS_PARALLEL_GRAIN, ARRAYS_RELAXED);
+}
+
+/**
+ * How parallelRun cuts [0, n) into ranges: the first range ends at `head` plus `chunk`, every
+ * later one is `chunk` elements long, and the last one ends at n.
+ */
+struct arrays_split {
+    size_t head;
+    size_t chunk;
+    size_t ranges;
+};
+
+/**
+ * Function: parallelSplit
+ * -----------------------
+ * Cuts [0, n) into page-aligned ranges of at least the parallel grain and a multiple of `unit`
+ * elements and starts enough pool threads to run them.
+ *
+ * Parameters:
+ * - base: The array whose pages the range boundaries follow.
+ *
+ * Returns:
+ * The number of ranges, or 0 when the work should run sequentially instead (a single range or
+ * a single thread).
+ */
+static size_t parallelSplit(struct arrays_split* split, const int* base, size_t n, size_t unit, int threads) {
+    threads = resolveThreads(threads);
+    size_t grain = ARRAYS_ATOMIC_LOAD(&arraysParallelGrain, ARRAYS_RELAXED);
+    if (threads <= 1 || n < 2 * grain)
+        return 0;
+
+    size_t step = unit > ARRAYS_PAGE_INTS ? unit : ARRAYS_PAGE_INTS;
+    size_t chunk = n / ((size_t)threads * ARRAYS_PARALLEL_SPLIT);
+    if (chunk < grain)
+        chunk = grain;
+    if (chunk > ARRAYS_LARGE_CHUNK)
+        chunk = ARRAYS_LARGE_CHUNK;
+    chunk = (chunk + step - 1) / step * step;
+    size_t head = unit > 1 ? 0 : ((4096 - ((size_t)base & 4095)) & 4095) / sizeof(int);
+    size_t ranges = head + chunk >= n ? 1 : 1 + (n - head - 1) / chunk;
+    if (ranges <= 1 || poolEnsureThreads(threads) <= 1)
+        return 0;
+    split->head = head;
+    split->chunk = chunk;
+    split->ranges = ranges;
+    return ranges;
+}
+
+/**
+ * Function: parallelRunSplit
+ * --------------------------
+ * Runs `run` over the ranges of a split made by parallelSplit for the same n, one pool task per
+ * range; task.depth is the index of the range. Work that runs over the same split twice sees
+ * the same ranges both times.
+ *
+ * Parameters:
+ * - job: Passed to each task as its context; job->partials is allocated here when `partials` is set.
+ *
+ * Returns:
+ * The number of ranges that ran, or 0 when there was no memory for the partial results.
+ */
+static size_t parallelRunSplit(struct arrays_parallel_job* job, const struct arrays_split* split, size_t n, bool partials, void (*run)(struct arrays_task* task)) {
+    size_t ranges = split->ranges;
+    job->partials = NULL;
+    if (partials) {
+        job->partials = (struct arrays_partial*)malloc(ranges * sizeof(struct arrays_partial));
+        if (job->partials == NULL)
+            return 0;
+    }
+
+    struct arrays_task_group group = {0};
+    struct arrays_task task;
+    task.run = run;
+    task.group = &group;
+    task.context = job;
+    size_t low = 0;
+    for (size_t i = 0; i < ranges; ++i) {
+        size_t high = i + 1 == ranges ? n : (i == 0 ? split->head : low) + split->chunk;
+        task.low = (ptrdiff_t)low;
+        task.high = (ptrdiff_t)high;
+        task.depth = (int)i;
+        poolSubmit(&task);
+        low = high;
+    }
+    poolWait(&group);
+    return ranges;
+}
+
+/**
+ * Function: parallelRun
+ * ---------------------
+ * Runs `run` over [0, n) in page-aligned ranges of at least the parallel grain and a multiple
+ * of `unit` elements, one pool task per range; task.depth is the index of the range.
+ *
+ * Parameters:
+ * - job: Passed to each task as its context; job->partials is allocated here when `partials` is set.
+ * - base: The array whose pages the range boundaries follow.
+ *
+ * Returns:
+ * The number of ranges that ran, or 0 when the work should run sequentially instead (a single
+ * range, a single thread, or no memory for the partial results).
+ */
+static size_t parallelRun(struct arrays_parallel_job* job, const int* base, size_t n, size_t unit, bool partials, int threads, void (*run)(struct arrays_task* task)) {
+    struct arrays_split split;
+    if (parallelSplit(&split, base, n, unit, threads) == 0)
+        return 0;
+    return parallelRunSplit(job, &split, n, partials, run);
+}
+
+static void parallelSumTask(struct arrays_task* task) {
+    struct arrays_parallel_job* job = (struct arrays_parallel_job*)task->context;
+    job->partials[task->depth].sum = Arrays.sum((int*)(job->src + task->low), (int)(task->high - task->low));
+}
+
+static void parallelPrefixSumTask(struct arrays_task* task) {
+    struct arrays_parallel_job* job = (struct arrays_parallel_job*)task->context;
+    size_t length = (size_t)(task->high - task->low);
+    arraysPrefixSums(job->src + task->low, length, job->scan + task->low, job->carries[task->depth].sum, true);
+}
+
+static void parallelMinMaxTask(struct arrays_task* task) {
+    struct arrays_parallel_job* job = (struct arrays_parallel_job*)task->context;
+    struct arrays_partial* partial = &job->partials[task->depth];
+    Arrays.minMax(job->src + task->low, (int)(task->high - task->low), &partial->minimum, &partial->maximum);
+}
+
+static void parallelCountTask(struct arrays_task* task) {
+    struct arrays_parallel_job* job = (struct arrays_parallel_job*)task->context;
+    job->partials[task->depth].count = (size_t)Arrays.count(job->src + task->low, (int)(task->high - task->low), job->value);
+}
+
+/**
+ * Elements a parallel histogram task counts into its 32-bit private counters before adding
+ * them to the shared size_t bins, so no private counter can wrap.
+ */
+#ifndef ARRAYS_HISTOGRAM_FLUSH
+#define ARRAYS_HISTOGRAM_FLUSH ((size_t)1 << 30)
+#endif
+
+/**
+ * @brief Histograms job->src[low..high) into private counters and adds them to job->bins
+ * every ARRAYS_HISTOGRAM_FLUSH elements; returns the number of elements counted. Without
+ * memory for the private counters every element is added to job->bins directly.
+ */
+static size_t parallelHistogramRange(struct arrays_parallel_job* job, size_t low, size_t high) {
+    const struct histogram_spec* spec = job->histogram;
+    uint32_t* counts = (uint32_t*)calloc(spec->buckets, sizeof(uint32_t));
+    if (counts == NULL) {
+        size_t counted = 0;
+        for (size_t i = low; i < high; ++i) {
+            uint32_t b = histogramIndex(spec, job->src[i]);
+            if (b < spec->buckets) {
+                ARRAYS_ATOMIC_ADD(&job->bins[b], 1, ARRAYS_RELAXED);
+                counted++;
+            }
+        }
+        return counted;
+    }
+    size_t counted = 0;
+    for (size_t from = low; from < high; from += ARRAYS_HISTOGRAM_FLUSH) {
+        size_t length = high - from < ARRAYS_HISTOGRAM_FLUSH ? high - from : ARRAYS_HISTOGRAM_FLUSH;
+        counted += histogramScan(job->src + from, length, spec, counts);
+        for (uint32_t b = 0; b < spec->buckets; ++b) {
+            if (counts[b] != 0)
+                ARRAYS_ATOMIC_ADD(&job->bins[b], (size_t)counts[b], ARRAYS_RELAXED);
+        }
+        memset(counts, 0, spec->buckets * sizeof(uint32_t));
+    }
+    free(counts);
+    return counted;
+}
+
+static void parallelHistogramTask(struct arrays_task* task) {
+    struct arrays_parallel_job* job = (struct arrays_parallel_job*)task->context;
+    job->partials[task->depth].count = parallelHistogramRange(job, (size_t)task->low, (size_t)task->high);
+}
+
+static void parallelHashTask(struct arrays_task* task) {
+    struct arrays_parallel_job* job = (struct arrays_parallel_job*)task->context;
+    for (size_t low = (size_t)task->low; low < (size_t)task->high; low += ARRAYS_HASH_CHUNK) {
+        size_t length = (size_t)task->high - low < ARRAYS_HASH_CHUNK ? (size_t)task->high - low : ARRAYS_HASH_CHUNK;
+        uint64_t hash = Arrays.fastHash(job->src + low, length, job->seed);
+        job->hashes[low / ARRAYS_HASH_CHUNK] = hash;
+    }
+}
+
+static void parallelReverseTask(struct arrays_task* task) {
+    struct arrays_parallel_job* job = (struct arrays_parallel_job*)task->context;
+    int* arr = job->dest;
+    size_t last = job->n - 1;
+    for (size_t i = (size_t)task->low; i < (size_t)task->high; ++i) {
+        int temp = arr[i];
+        arr[i] = arr[last - i];
+        arr[last - i] = temp;
+    }
+}
+
+static void parallelCopyTask(struct arrays_task* task) {
+    struct arrays_parallel_job* job = (struct arrays_parallel_job*)task->context;
+    copyInts(job->dest + task->low, job->src + task->low, (size_t)(task->high - task->low));
+}
+
+/**
+ * Function: parallelSum
+ * ---------------------
+ * Returns the sum of all elements, accumulated in 64 bits, using several threads.
+ */
+inline long long parallelSum(const int* arr, size_t n, int threads) {
+    struct arrays_parallel_job job = {0};
+    job.src = arr;
+    size_t ranges = parallelRun(&job, arr, n, 1, true, threads, parallelSumTask);
+    if (ranges == 0)
+        return (long long)sumAllElements64(arr, n);
+    long long sum = 0;
+    for (size_t i = 0; i < ranges; ++i)
+        sum += job.partials[i].sum;
+    free(job.partials);
+    return sum;
+}
+
+/**
+ * Function: parallelPrefixSum
+ * ---------------------------
+ * Writes the inclusive prefix sums of the array, as prefixSum does, using several threads.
+ * A first pass sums every range, the range totals are scanned, and a second pass scans every
+ * range starting from the total of the ranges before it, so the input is read twice and dest
+ * is written once. Both passes run over the same split, so every carry belongs to its range.
+ *
+ * Returns:
+ * The sum of all elements.
+ */
+inline long long parallelPrefixSum(const int* arr, size_t n, long long* dest, int threads) {
+    struct arrays_parallel_job job = {0};
+    job.src = arr;
+    struct arrays_split split;
+    size_t ranges = parallelSplit(&split, arr, n, 1, threads);
+    if (ranges != 0)
+        ranges = parallelRunSplit(&job, &split, n, true, parallelSumTask);
+    if (ranges == 0)
+        return n == 0 ? 0 : arraysPrefixSums(arr, n, dest, 0, true);
+    struct arrays_partial* carries = job.partials;
+    long long total = 0;
+    for (size_t i = 0; i < ranges; ++i) {
+        long long sum = carries[i].sum;
+        carries[i].sum = total;
+        total += sum;
+    }
+    job.scan = dest;
+    job.carries = carries;
+    parallelRunSplit(&job, &split, n, false, parallelPrefixSumTask);
+    free(carries);
+    return total;
+}
+
+/**
+ * Function: parallelMinMax
+ * ------------------------
+ * Stores the minimum and the maximum value of the array (0 for both if it is empty), using
+ * several threads.
+ */
+inline void parallelMinMax(const int* arr, size_t n, int* minimum, int* maximum, int threads) {
+    struct arrays_parallel_job job = {0};
+    job.src = arr;
+    size_t ranges = parallelRun(&job, arr, n, 1, true, threads, parallelMinMaxTask);
+    if (ranges == 0) {
+        getMinMaxOf64(arr, n, minimum, maximum);
+        return;
+    }
+    *minimum = job.partials[0].minimum;
+    *maximum = job.partials[0].maximum;
+    for (size_t i = 1; i < ranges; ++i) {
+        *minimum = job.partials[i].minimum < *minimum ? job.partials[i].minimum : *minimum;
+        *maximum = job.partials[i].maximum > *maximum ? job.partials[i].maximum : *maximum;
+    }
+    free(job.partials);
+}
+
+/**
+ * Function: parallelCount
+ * -----------------------
+ * Returns the number of occurrences of a value, using several threads.
+ */
+inline size_t parallelCount(const int* arr, size_t n, int sr, int threads) {
+    struct arrays_parallel_job job = {0};
+    job.src = arr;
+    job.value = sr;
+    size_t ranges = parallelRun(&job, arr, n, 1, true, threads, parallelCountTask);
+    if (ranges == 0)
+        return countOccurrences64(arr, n, sr);
+    size_t count = 0;
+    for (size_t i = 0; i < ranges; ++i)
+        count += job.partials[i].count;
+    free(job.partials);
+    return count;
+}
+
+/**
+ * Function: parallelHistogram
+ * ---------------------------
+ * Counts the elements into equal-width buckets over [low, high], as histogram does, using
+ * several threads. Each task counts into its own buckets and adds them to `counts` once.
+ *
+ * Returns:
+ * The number of elements counted, or 0 if low > high or buckets <= 0.
+ */
+inline size_t parallelHistogram(const int* arr, size_t n, int low, int high, int buckets, size_t* counts, int threads) {
+    struct histogram_spec spec;
+    if (!histogramSpec(&spec, low, high, buckets))
+        return 0;
+    memset(counts, 0, (size_t)buckets * sizeof(size_t));
+    struct arrays_parallel_job job = {0};
+    job.src = arr;
+    job.histogram = &spec;
+    job.bins = (ARRAYS_ATOMIC(size_t)*)counts;
+    size_t ranges = parallelRun(&job, arr, n, 1, true, threads, parallelHistogramTask);
+    size_t counted = 0;
+    if (ranges == 0) {
+        for (size_t i = 0; i < n; i += ARRAYS_LARGE_CHUNK)
+            counted += parallelHistogramRange(&job, i, n - i < ARRAYS_LARGE_CHUNK ? n : i + ARRAYS_LARGE_CHUNK);
+        return counted;
+    }
+    for (size_t i = 0; i < ranges; ++i)
+        counted += job.partials[i].count;
+    free(job.partials);
+    return counted;
+}
+
+/**
+ * @brief Feeds one chunk hash to the combining hash as the two ints of its in-memory representation.
+ */
+static void parallelHashCombine(array_hash_state* state, uint64_t hash) {
+    int words[2];
+    memcpy(words, &hash, sizeof(hash));
+    Arrays.hashUpdate(state, words, 2);
+}
+
+/**
+ * Function: parallelHash
+ * ----------------------
+ * Hashes an array using several threads. The array is cut into chunks of ARRAYS_HASH_CHUNK
+ * elements, each chunk is hashed with fastHash, and the chunk hashes are hashed in order.
+ * The value is the same for any number of threads, but differs from fastHash of the array.
+ *
+ * Parameters:
+ * - arr: The array to hash.
+ * - n: The number of elements.
+ * - seed: The seed, as for fastHash.
+ * - threads: Number of threads to use.
+ */
+inline uint64_t parallelHash(const int* arr, size_t n, uint64_t seed, int threads) {
+    array_hash_state state;
+    Arrays.hashInit(&state, seed ^ (uint64_t)n);
+    size_t chunks = (n + ARRAYS_HASH_CHUNK - 1) / ARRAYS_HASH_CHUNK;
+    struct arrays_parallel_job job = {0};
+    job.src = arr;
+    job.seed = seed;
+    job.hashes = chunks > 1 ? (uint64_t*)malloc(chunks * sizeof(uint64_t)) : NULL;
+    if (job.hashes != NULL && parallelRun(&job, arr, n, ARRAYS_HASH_CHUNK, false, threads, parallelHashTask) > 0) {
+        for (size_t c = 0; c < chunks; ++c)
+            parallelHashCombine(&state, job.hashes[c]);
+    } else {
+        for (size_t low = 0; low < n; low += ARRAYS_HASH_CHUNK) {
+            size_t length = n - low < ARRAYS_HASH_CHUNK ? n - low : ARRAYS_HASH_CHUNK;
+            parallelHashCombine(&state, Arrays.fastHash(arr + low, length, seed));
+        }
+    }
+    free(job.hashes);
+    return Arrays.hashFinal(&state);
+}
+
+/**
+ * Function: parallelReverse
+ * -------------------------
+ * Reverses the elements of an array in-place using several threads.
+ */
+inline int* parallelReverse(int* arr, size_t n, int threads) {
+    struct arrays_parallel_job job = {0};
+    job.dest = arr;
+    job.n = n;
+    if (parallelRun(&job, arr, n / 2, 1, false, threads, parallelReverseTask) == 0)
+        reverse64(arr, n);
+    return arr;
+}
+
+/**
+ * Function: parallelCopy
+ * ----------------------
+ * Copies n ints between non-overlapping buffers using several threads. Each task writes its
+ * own pages of dest, so on NUMA systems a new destination is placed near the threads that use it.
+ *
+ * Returns:
+ * dest.
+ */
+inline int* parallelCopy(int* dest, const int* src, size_t n, int threads) {
+    struct arrays_parallel_job job = {0};
+    job.src = src;
+    job.dest = dest;
+    if (parallelRun(&job, dest, n, 1, false, threads, parallelCopyTask) == 0)
+        copyInts(dest, src, n);
+    return dest;
+}
+
+
+/**
+ * Array files.
+ *
+ * An array file is a 64-byte header followed, at ARRAYS_FILE_ALIGNMENT, by the elements in the
+ * byte order of the machine that wrote them:
+ *
+ *   offset  size  field
+ *        0     8  magic "ARRAYS\0\1"
+ *        8     4  format version (1)
+ *       12     4  byte order mark 0x01020304
+ *       16     4  element type (array_element_type)
+ *       20     4  flags (ARRAY_FILE_SORTED)
+ *       24     8  element count
+ *       32     8  payload offset
+ *       40     8  hashCode of the elements
+ *       48     8  fastHash of the elements (seed 0)
+ *       56     8  reserved, zero
+ *
+ * mapArrayFile() maps the file with mmap, so every Arrays function (sort, searchBIN, buildIndex,
+ * ...) works on the page cache directly instead of on a private copy, and reports the
+ * sortedness and hashes from the header without reading the payload. The ARRAY_ADVISE_* hints
+ * use posix_madvise, which strict ISO C modes (-std=c11 without _POSIX_C_SOURCE) do not declare;
+ * they are ignored there. Define ARRAYS_NO_MMAP on platforms without mmap; the file is then read
+ * into memory from the installed allocator.
+ */
+#ifndef ARRAYS_NO_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Offset of the payload in files written by this header; a page, so the payload can be mapped
+ * and advised on its own. Define before including this header to override.
+ */
+#ifndef ARRAYS_FILE_ALIGNMENT
+#define ARRAYS_FILE_ALIGNMENT 4096
+#endif
+
+#define ARRAYS_FILE_VERSION 1
+#define ARRAYS_FILE_BYTE_ORDER 0x01020304u
+
+static const char arraysFileMagic[8] = {'A', 'R', 'R', 'A', 'Y', 'S', 0, 1};
+
+struct arrays_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t elementType;
+    uint32_t flags;
+    uint64_t count;
+    uint64_t payloadOffset;
+    uint64_t hashCode;
+    uint64_t fastHash;
+    uint64_t reserved;
+};
+
+static void fileHeaderInit(struct arrays_file_header* header, size_t count, bool sorted, unsigned long long hashCode, uint64_t fastHash) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, arraysFileMagic, sizeof(arraysFileMagic));
+    header->version = ARRAYS_FILE_VERSION;
+    header->byteOrder = ARRAYS_FILE_BYTE_ORDER;
+    header->elementType = ARRAY_ELEMENT_INT32;
+    header->flags = sorted ? ARRAY_FILE_SORTED : 0;
+    header->count = count;
+    header->payloadOffset = ARRAYS_FILE_ALIGNMENT;
+    header->hashCode = hashCode;
+    header->fastHash = fastHash;
+}
+
+/**
+ * @brief Checks a header read from a file of `size` bytes.
+ */
+static status_code fileHeaderCheck(const struct arrays_file_header* header, uint64_t size) {
+    if (memcmp(header->magic, arraysFileMagic, sizeof(arraysFileMagic)) != 0 || header->version != ARRAYS_FILE_VERSION)
+        return FAILURE;
+    if (header->byteOrder != ARRAYS_FILE_BYTE_ORDER || header->elementType != ARRAY_ELEMENT_INT32)
+        return FAILURE;
+    if (header->payloadOffset < sizeof(*header) || header->payloadOffset % sizeof(int) != 0 || header->payloadOffset > size)
+        return FAILURE;
+    if (header->count > (size - header->payloadOffset) / sizeof(int))
+        return FAILURE;
+    return SUCCESS;
+}
+
+/**
+ * Function: arrayWriterOpen
+ * -------------------------
+ * Creates (or truncates) an array file to be filled with arrayWriterAppend(). The sorted flag
+ * and both hashes are computed while the elements stream through.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the file could not be created.
+ */
+inline status_code arrayWriterOpen(array_file_writer* writer, const char* path) {
+    memset(writer, 0, sizeof(*writer));
+    writer->stream = fopen(path, "wb");
+    if (writer->stream == NULL)
+        return FAILURE;
+    char zero[ARRAYS_FILE_ALIGNMENT] = {0};
+    if (fwrite(zero, 1, sizeof(zero), writer->stream) != sizeof(zero)) {
+        fclose(writer->stream);
+        writer->stream = NULL;
+        return FAILURE;
+    }
+    writer->sorted = true;
+    writer->hashCode = 1;
+    hashStateInit(&writer->hash, 0);
+    return SUCCESS;
+}
+
+/**
+ * Function: arrayWriterAppend
+ * ---------------------------
+ * Appends n elements to an array file.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if writing failed (the file is then incomplete).
+ */
+inline status_code arrayWriterAppend(array_file_writer* writer, const int* arr, size_t n) {
+    if (writer->stream == NULL)
+        return FAILURE;
+    if (n == 0)
+        return SUCCESS;
+    if (fwrite(arr, sizeof(int), n, writer->stream) != n)
+        return FAILURE;
+    if (writer->sorted && ((writer->count > 0 && arr[0] < writer->last) || !Arrays64.isSorted(arr, n)))
+        writer->sorted = false;
+    for (size_t i = 0; i < n; i++) {
+        int val = arr[i];
+        val = val ^ (val >> 31);
+        writer->hashCode = writer->hashCode * 19 + val;
+    }
+    Arrays.hashUpdate(&writer->hash, arr, n);
+    writer->last = arr[n - 1];
+    writer->count += n;
+    return SUCCESS;
+}
+
+/**
+ * Function: arrayWriterClose
+ * --------------------------
+ * Writes the header and closes the file.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if any write failed.
+ */
+inline status_code arrayWriterClose(array_file_writer* writer) {
+    if (writer->stream == NULL)
+        return FAILURE;
+    struct arrays_file_header header;
+    fileHeaderInit(&header, writer->count, writer->sorted, writer->hashCode, Arrays.hashFinal(&writer->hash));
+    bool ok = fseek(writer->stream, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, writer->stream) == 1;
+    ok = fclose(writer->stream) == 0 && ok;
+    writer->stream = NULL;
+    return ok ? SUCCESS : FAILURE;
+}
+
+/**
+ * Function: writeArrayFile
+ * ------------------------
+ * Writes an array to an array file, recording in the header whether it is sorted and its hashes.
+ *
+ * Parameters:
+ * - path: The file to create (or truncate).
+ * - arr: The elements.
+ * - n: The number of elements.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the file could not be written.
+ */
+inline status_code writeArrayFile(const char* path, const int* arr, size_t n) {
+    array_file_writer writer;
+    if (arrayWriterOpen(&writer, path) != SUCCESS)
+        return FAILURE;
+    status_code appended = arrayWriterAppend(&writer, arr, n);
+    status_code closed = arrayWriterClose(&writer);
+    return appended == SUCCESS && closed == SUCCESS ? SUCCESS : FAILURE;
+}
+
+/**
+ * @brief Fills the public fields of an array_file from its header and payload.
+ */
+static void fileFromHeader(array_file* file, const struct arrays_file_header* header, char* base) {
+    file->data = (int*)(base + header->payloadOffset);
+    file->count = (size_t)header->count;
+    file->sorted = (header->flags & ARRAY_FILE_SORTED) != 0;
+    file->hashCode = header->hashCode;
+    file->fastHash = header->fastHash;
+}
+
+/**
+ * Function: mapArrayFile
+ * ----------------------
+ * Maps an array file into memory without copying it.
+ *
+ * Parameters:
+ * - path: The file to map.
+ * - file: Receives the elements (file->data, file->count) and the header metadata.
+ * - mode: One of ARRAY_MAP_READ (read-only), ARRAY_MAP_PRIVATE (writable, changes are
+ *   discarded on unmap) or ARRAY_MAP_SHARED (writable, changes go to the file; call
+ *   syncArrayFile to refresh the header), optionally combined with an ARRAY_ADVISE_* hint
+ *   for the payload.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the file cannot be opened or is not a valid int array file.
+ * NOTE: The mapping must be released with unmapArrayFile().
+ */
+inline status_code mapArrayFile(const char* path, array_file* file, int mode) {
+    memset(file, 0, sizeof(*file));
+    file->mode = mode;
+    struct arrays_file_header header;
+#ifndef ARRAYS_NO_MMAP
+    bool writable = (mode & (ARRAY_MAP_PRIVATE | ARRAY_MAP_SHARED)) != 0;
+    int fd = open(path, (mode & ARRAY_MAP_SHARED) ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+        return FAILURE;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size < sizeof(header)) {
+        close(fd);
+        return FAILURE;
+    }
+    size_t size = (size_t)info.st_size;
+    void* mapping = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, (mode & ARRAY_MAP_SHARED) ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return FAILURE;
+    memcpy(&header, mapping, sizeof(header));
+    if (fileHeaderCheck(&header, size) != SUCCESS) {
+        munmap(mapping, size);
+        return FAILURE;
+    }
+#ifdef POSIX_MADV_NORMAL
+    int advice = POSIX_MADV_NORMAL;
+    if (mode & ARRAY_ADVISE_SEQUENTIAL)
+        advice = POSIX_MADV_SEQUENTIAL;
+    else if (mode & ARRAY_ADVISE_RANDOM)
+        advice = POSIX_MADV_RANDOM;
+    else if (mode & ARRAY_ADVISE_WILLNEED)
+        advice = POSIX_MADV_WILLNEED;
+    size_t payload = (size_t)header.payloadOffset & ~(size_t)4095;
+    if (advice != POSIX_MADV_NORMAL && size > payload)
+        posix_madvise((char*)mapping + payload, size - payload, advice);
+#endif
+#else
+    FILE* stream = fopen(path, (mode & ARRAY_MAP_SHARED) ? "r+b" : "rb");
+    if (stream == NULL)
+        return FAILURE;
+    size_t size = 0;
+    void* mapping = NULL;
+    long end = fseek(stream, 0, SEEK_END) == 0 ? ftell(stream) : -1;
+    if (end >= 0 && fseek(stream, 0, SEEK_SET) == 0 && fread(&header, sizeof(header), 1, stream) == 1
+        && fileHeaderCheck(&header, (uint64_t)end) == SUCCESS) {
+        size = (size_t)end;
+        mapping = ownedAlloc(&file->allocator, size);
+    }
+    bool ok = mapping != NULL && fseek(stream, 0, SEEK_SET) == 0 && fread(mapping, 1, size, stream) == size;
+    if (!ok) {
+        fclose(stream);
+        ownedRelease(&file->allocator, mapping);
+        return FAILURE;
+    }
+    if (mode & ARRAY_MAP_SHARED)
+        file->stream = stream;
+    else
+        fclose(stream);
+#endif
+    file->mapping = mapping;
+    file->mappingSize = size;
+    fileFromHeader(file, &header, (char*)mapping);
+    return SUCCESS;
+}
+
+/**
+ * Function: syncArrayFile
+ * -----------------------
+ * After the elements of an ARRAY_MAP_SHARED file were modified in place (sorted, for example),
+ * recomputes its sorted flag and hashes, stores them in the header and writes everything back.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the file is not mapped with ARRAY_MAP_SHARED or could not be written.
+ */
+inline status_code syncArrayFile(array_file* file) {
+    if (file->mapping == NULL || !(file->mode & ARRAY_MAP_SHARED))
+        return FAILURE;
+    struct arrays_file_header header;
+    memcpy(&header, file->mapping, sizeof(header));
+    file->sorted = Arrays64.isSorted(file->data, file->count);
+    file->hashCode = Arrays64.hashCode(file->data, file->count);
+    file->fastHash = Arrays.fastHash(file->data, file->count, 0);
+    header.flags = file->sorted ? (header.flags | ARRAY_FILE_SORTED) : (header.flags & ~(uint32_t)ARRAY_FILE_SORTED);
+    header.hashCode = file->hashCode;
+    header.fastHash = file->fastHash;
+    memcpy(file->mapping, &header, sizeof(header));
+#ifndef ARRAYS_NO_MMAP
+    return msync(file->mapping, file->mappingSize, MS_SYNC) == 0 ? SUCCESS : FAILURE;
+#else
+    FILE* stream = (FILE*)file->stream;
+    bool ok = fseek(stream, 0, SEEK_SET) == 0 && fwrite(file->mapping, 1, file->mappingSize, stream) == file->mappingSize;
+    return ok && fflush(stream) == 0 ? SUCCESS : FAILURE;
+#endif
+}
+
+/**
+ * Function: unmapArrayFile
+ * ------------------------
+ * Releases a mapping made by mapArrayFile(). file->data must not be used afterwards.
+ */
+inline void unmapArrayFile(array_file* file) {
+    if (file->mapping != NULL) {
+#ifndef ARRAYS_NO_MMAP
+        munmap(file->mapping, file->mappingSize);
+#else
+        ownedRelease(&file->allocator, file->mapping);
+        if (file->stream != NULL)
+            fclose((FILE*)file->stream);
+#endif
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+
+/**
+ * External sort.
+ *
+ * externalSort() sorts an array file that does not fit in memory. The input is mapped and cut
+ * into runs that fit the memory budget; each run is radix sorted in memory and written next to
+ * the output as an array file of its own. The runs are then mapped with sequential advice, so
+ * the kernel reads them ahead asynchronously, and merged in one pass through a loser tree into
+ * the output, which is written in large sequential blocks.
+ */
+
+/**
+ * Elements buffered between the loser tree and the output file. Define before including this
+ * header to override.
+ */
+#ifndef ARRAYS_MERGE_BUFFER
+#define ARRAYS_MERGE_BUFFER (1 << 16)
+#endif
+
+struct arrays_merge_run {
+    array_file file;
+    size_t position;
+};
+
+/**
+ * @brief Loser tree order: true if run a's current element is smaller than run b's. Exhausted
+ * runs are larger than everything; ties go to the lower run index.
+ */
+static inline bool mergeRunLess(const struct arrays_merge_run* runs, int a, int b) {
+    bool doneA = runs[a].position == runs[a].file.count;
+    bool doneB = runs[b].position == runs[b].file.count;
+    if (doneA || doneB)
+        return !doneA || (doneB && a < b);
+    int keyA = runs[a].file.data[runs[a].position];
+    int keyB = runs[b].file.data[runs[b].position];
+    return keyA < keyB || (keyA == keyB && a < b);
+}
+
+/**
+ * @brief Replays the matches on the path from run `winner` to the root; tree[0] is the new winner.
+ */
+static void loserTreeReplay(int* tree, const struct arrays_merge_run* runs, int count, int winner) {
+    for (int node = (winner + count) / 2; node > 0; node /= 2) {
+        if (mergeRunLess(runs, tree[node], winner)) {
+            int loser = winner;
+            winner = tree[node];
+            tree[node] = loser;
+        }
+    }
+    tree[0] = winner;
+}
+
+/**
+ * @brief Merges `count` sorted runs into an open writer with a loser tree.
+ */
+static status_code mergeRuns(struct arrays_merge_run* runs, int count, array_file_writer* writer, int* buffer) {
+    int* tree = (int*)malloc((size_t)count * sizeof(int));
+    if (tree == NULL)
+        return FAILURE;
+    for (int i = 0; i < count; ++i)
+        tree[i] = -1;
+    for (int run = count - 1; run >= 0; --run) {
+        int winner = run;
+        for (int node = (run + count) / 2; node > 0 && winner >= 0; node /= 2) {
+            if (tree[node] < 0) {
+                tree[node] = winner;
+                winner = -1;
+            } else if (mergeRunLess(runs, tree[node], winner)) {
+                int loser = winner;
+                winner = tree[node];
+                tree[node] = loser;
+            }
+        }
+        if (winner >= 0)
+            tree[0] = winner;
+    }
+
+    status_code status = SUCCESS;
+    size_t buffered = 0;
+    for (;;) {
+        struct arrays_merge_run* run = &runs[tree[0]];
+        if (run->position == run->file.count)
+            break;
+        buffer[buffered++] = run->file.data[run->position++];
+        if (buffered == ARRAYS_MERGE_BUFFER) {
+            if (arrayWriterAppend(writer, buffer, buffered) != SUCCESS) {
+                status = FAILURE;
+                break;
+            }
+            buffered = 0;
+        }
+        loserTreeReplay(tree, runs, count, tree[0]);
+    }
+    if (status == SUCCESS && arrayWriterAppend(writer, buffer, buffered) != SUCCESS)
+        status = FAILURE;
+    free(tree);
+    return status;
+}
+
+/**
+ * @brief Name of the i-th run file of an external sort into `output`.
+ */
+static char* runFileName(const char* output, int index) {
+    size_t length = strlen(output) + 32;
+    char* name = (char*)malloc(length);
+    if (name != NULL)
+        snprintf(name, length, "%s.run%d", output, index);
+    return name;
+}
+
+/**
+ * @brief Name of the file an external sort into `output` writes before renaming it into place.
+ */
+static char* partialFileName(const char* output) {
+    size_t length = strlen(output) + 8;
+    char* name = (char*)malloc(length);
+    if (name != NULL)
+        snprintf(name, length, "%s.part", output);
+    return name;
+}
+
+/**
+ * Function: externalSort
+ * ----------------------
+ * Sorts an array file into a new array file using at most about `memory` bytes of heap,
+ * whatever the size of the input.
+ *
+ * Parameters:
+ * - input: The array file to sort. It is only read.
+ * - output: The array file to create. It is written as output.part and renamed to output only
+ *   once complete, so a failed sort leaves no partial output (and any existing output intact).
+ *   Temporary run files named output.run0, output.run1, ... are created and removed next to it.
+ * - memory: The memory budget in bytes. Each run holds memory / 8 elements (the elements plus
+ *   the radix sort scratch buffer); inputs that fit in one run are sorted without run files.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if a file could not be read or written or memory ran out.
  */
-inline bool compareTwoArray(int* arr1, int size1, int* arr2, int size2){
-    int iterator = 0;
-    if (size1!=size2)
-        return false;
-    while (iterator<size1 && iterator<size2 && arr1[iterator]==arr2[iterator]){
-        iterator++;
+inline status_code externalSort(const char* input, const char* output, size_t memory) {
+    array_file source;
+    if (mapArrayFile(input, &source, ARRAY_MAP_READ | ARRAY_ADVISE_SEQUENTIAL) != SUCCESS)
+        return FAILURE;
+
+    size_t runLength = memory / (2 * sizeof(int));
+    if (runLength < ARRAYS_MERGE_BUFFER)
+        runLength = ARRAYS_MERGE_BUFFER;
+    if (runLength > source.count)
+        runLength = source.count ? source.count : 1;
+    size_t runs = (source.count + runLength - 1) / runLength;
+    char* target = runs <= (size_t)ARRAYS_LARGE_CHUNK ? partialFileName(output) : NULL;
+    if (target == NULL) {
+        unmapArrayFile(&source);
+        return FAILURE;
+    }
+
+    int* buffer = (int*)malloc(runLength * sizeof(int));
+    int* scratch = (int*)malloc(runLength * sizeof(int));
+    status_code status = buffer != NULL && scratch != NULL ? SUCCESS : FAILURE;
+    int written = 0;
+    for (size_t run = 0; run < runs && status == SUCCESS; ++run) {
+        size_t low = run * runLength;
+        size_t length = source.count - low < runLength ? source.count - low : runLength;
+        copyInts(buffer, source.data + low, length);
+        radixSort64(buffer, 0, (ptrdiff_t)length - 1, scratch);
+        if (runs == 1) {
+            status = writeArrayFile(target, buffer, length);
+            break;
+        }
+        char* name = runFileName(output, (int)run);
+        status = name != NULL ? writeArrayFile(name, buffer, length) : FAILURE;
+        free(name);
+        written += status == SUCCESS;
+    }
+    free(scratch);
+    unmapArrayFile(&source);
+    if (runs == 0 && status == SUCCESS)
+        status = writeArrayFile(target, buffer, 0);
+
+    if (runs > 1 && status == SUCCESS) {
+        struct arrays_merge_run* merge = (struct arrays_merge_run*)calloc(runs, sizeof(struct arrays_merge_run));
+        status = merge != NULL ? SUCCESS : FAILURE;
+        for (size_t run = 0; run < runs && status == SUCCESS; ++run) {
+            char* name = runFileName(output, (int)run);
+            status = name != NULL ? mapArrayFile(name, &merge[run].file, ARRAY_MAP_READ | ARRAY_ADVISE_SEQUENTIAL) : FAILURE;
+            free(name);
+        }
+        array_file_writer writer;
+        if (status == SUCCESS)
+            status = arrayWriterOpen(&writer, target);
+        if (status == SUCCESS) {
+            status = mergeRuns(merge, (int)runs, &writer, buffer);
+            status = arrayWriterClose(&writer) == SUCCESS ? status : FAILURE;
+        }
+        for (size_t run = 0; merge != NULL && run < runs; ++run)
+            unmapArrayFile(&merge[run].file);
+        free(merge);
+    }
+
+    for (int run = 0; run < written; ++run) {
+        char* name = runFileName(output, run);
+        if (name != NULL)
+            remove(name);
+        free(name);
     }
-    return iterator==size1;    
+    free(buffer);
+    if (status == SUCCESS && rename(target, output) != 0)
+        status = FAILURE;
+    if (status != SUCCESS)
+        remove(target);
+    free(target);
+    return status;
 }
 
 
 /**
- * @brief Calculates the sum of all elements in an integer array.
+ * Type-specialized function tables.
  *
- * This inline function iterates through the elements of the given array
- * and calculates the sum. The function is designed to be used with small,
- * frequently called operations for potential performance optimization.
+ * ARRAYS_DEFINE_TYPE(S, T, KEY_T, KEY_FN, SUM_T, ACC_T) generates, for element type T:
+ * - the table type Array_Functions_S and its global instance Arrays_S,
+ * - sort (introsort, switching to an LSD radix sort over KEY_T at ARRAYS_RADIX_SORT_THRESHOLD),
+ *   radixSort, searchLIN, searchBIN, count, minValue, maxValue, minMax, sum, isSorted, hashCode,
+ * - useArrayFunctions_S(level), which fills Arrays_S with the kernels for an isa_level.
  *
- * @param arr Pointer to the integer array.
- * @param n   Number of elements in the array.
- * @return    The sum of all elements in the array.
+ * KEY_FN maps a T to an unsigned KEY_T whose unsigned order matches the order of T; it drives
+ * the radix sort and hashCode. sum accumulates in ACC_T and returns SUM_T.
+ *
+ * The reductions and searches are written as ARRAYS_TYPED_LANES independent lanes and are
+ * compiled once per instruction set with target attributes, so the compiler emits SSE4.2, AVX2
+ * or AVX-512 code for each type. useArrayFunctions() initializes the tables defined here:
+ * Arrays_i64 (int64_t), Arrays_u32 (uint32_t), Arrays_f32 (float) and Arrays_f64 (double).
+ * Arrays itself remains the int table. For floating point types NaN has no defined position.
  */
-inline int sumAllElements(int *arr, int n)
-{
-    int sum = 0;
-    for (int i = 0; i < n; i++){
-        sum = sum + arr[i];
-        }
-    return 0;
+#ifndef ARRAYS_TYPED_LANES
+#define ARRAYS_TYPED_LANES 16
+#endif
+
+#define ARRAYS_DEFINE_TYPE_BASE(S, T, KEY_T, KEY_FN, SUM_T, ACC_T) \
+typedef struct { \
+    void (*sort)(T* arr, int low, int high); \
+    status_code (*radixSort)(T* arr, int low, int high, T* scratch); \
+    int (*searchLIN)(const T* arr, int n, T sr); \
+    int (*searchBIN)(const T* arr, int n, T sr); \
+    int (*count)(const T* arr, int n, T sr); \
+    T (*minValue)(const T* arr, int n); \
+    T (*maxValue)(const T* arr, int n); \
+    void (*minMax)(const T* arr, int n, T* minimum, T* maximum); \
+    SUM_T (*sum)(const T* arr, int n); \
+    bool (*isSorted)(const T* arr, int n); \
+    unsigned long long (*hashCode)(const T* arr, int n); \
+}Array_Functions_##S; \
+\
+Array_Functions_##S Arrays_##S; \
+\
+static void insertionSort_##S(T* arr, int low, int high) { \
+    for (int i = low + 1; i <= high; ++i) { \
+        T value = arr[i]; \
+        int j = i - 1; \
+        while (j >= low && value < arr[j]) { \
+            arr[j + 1] = arr[j]; \
+            j--; \
+        } \
+        arr[j + 1] = value; \
+    } \
+} \
+\
+static void siftDown_##S(T* arr, int base, int root, int size) { \
+    T value = arr[base + root]; \
+    for (;;) { \
+        int child = 2 * root + 1; \
+        if (child >= size) \
+            break; \
+        if (child + 1 < size && arr[base + child] < arr[base + child + 1]) \
+            child++; \
+        if (!(value < arr[base + child])) \
+            break; \
+        arr[base + root] = arr[base + child]; \
+        root = child; \
+    } \
+    arr[base + root] = value; \
+} \
+\
+static void heapSort_##S(T* arr, int low, int high) { \
+    int size = high - low + 1; \
+    for (int root = size / 2 - 1; root >= 0; --root) \
+        siftDown_##S(arr, low, root, size); \
+    for (int end = size - 1; end > 0; --end) { \
+        T temp = arr[low]; \
+        arr[low] = arr[low + end]; \
+        arr[low + end] = temp; \
+        siftDown_##S(arr, low, 0, end); \
+    } \
+} \
+\
+static void introSort_##S(T* arr, int low, int high) { \
+    struct sort_range stack[ARRAYS_SORT_STACK_SIZE]; \
+    int top = 0; \
+    int depth = 0; \
+    for (int n = high - low + 1; n > 1; n >>= 1) \
+        depth += 2; \
+    stack[top].low = low; \
+    stack[top].high = high; \
+    stack[top].depth = depth; \
+    top++; \
+    while (top > 0) { \
+        struct sort_range range = stack[--top]; \
+        if (range.high - range.low < ARRAYS_INSERTION_SORT_THRESHOLD) { \
+            insertionSort_##S(arr, range.low, range.high); \
+            continue; \
+        } \
+        if (range.depth == 0) { \
+            heapSort_##S(arr, range.low, range.high); \
+            continue; \
+        } \
+        int mid = range.low + (range.high - range.low) / 2; \
+        T a = arr[range.low], b = arr[mid], c = arr[range.high]; \
+        T pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b)); \
+        int i = range.low, j = range.high; \
+        while (i <= j) { \
+            while (i <= range.high && arr[i] < pivot) \
+                i++; \
+            while (j >= range.low && pivot < arr[j]) \
+                j--; \
+            if (i <= j) { \
+                T temp = arr[i]; \
+                arr[i] = arr[j]; \
+                arr[j] = temp; \
+                i++; \
+                j--; \
+            } \
+        } \
+        struct sort_range left = {range.low, j, range.depth - 1}; \
+        struct sort_range right = {i, range.high, range.depth - 1}; \
+        if (left.high - left.low > right.high - right.low) { \
+            struct sort_range temp = left; \
+            left = right; \
+            right = temp; \
+        } \
+        if (right.low < right.high) \
+            stack[top++] = right; \
+        if (left.low < left.high) \
+            stack[top++] = left; \
+    } \
+} \
+\
+static status_code radixSort_##S(T* arr, int low, int high, T* scratch) { \
+    if (arr == NULL || low >= high) \
+        return SUCCESS; \
+    size_t n = (size_t)(high - low) + 1; \
+    T* buffer = scratch; \
+    if (buffer == NULL) { \
+        buffer = (T*)malloc(n * sizeof(T)); \
+        if (buffer == NULL) \
+            return FAILURE; \
+    } \
+    enum { DIGITS = sizeof(KEY_T) }; \
+    size_t counts[DIGITS][256]; \
+    memset(counts, 0, sizeof(counts)); \
+    T* keys = arr + low; \
+    for (size_t i = 0; i < n; ++i) { \
+        KEY_T key = KEY_FN(keys[i]); \
+        for (int d = 0; d < DIGITS; ++d) \
+            counts[d][(key >> (8 * d)) & 0xFF]++; \
+    } \
+    T* from = keys; \
+    T* to = buffer; \
+    for (int d = 0; d < DIGITS; ++d) { \
+        size_t* count = counts[d]; \
+        if (count[(KEY_FN(from[0]) >> (8 * d)) & 0xFF] == n) \
+            continue; \
+        size_t offset = 0; \
+        for (int digit = 0; digit < 256; ++digit) { \
+            size_t c = count[digit]; \
+            count[digit] = offset; \
+            offset += c; \
+        } \
+        for (size_t i = 0; i < n; ++i) \
+            to[count[(KEY_FN(from[i]) >> (8 * d)) & 0xFF]++] = from[i]; \
+        T* temp = from; \
+        from = to; \
+        to = temp; \
+    } \
+    if (from != keys) \
+        memcpy(keys, from, n * sizeof(T)); \
+    if (scratch == NULL) \
+        free(buffer); \
+    return SUCCESS; \
+} \
+\
+static void sort_##S(T* arr, int low, int high) { \
+    if (arr == NULL || low >= high) \
+        return; \
+    if (high - low >= ARRAYS_RADIX_SORT_THRESHOLD && radixSort_##S(arr, low, high, NULL) == SUCCESS) \
+        return; \
+    introSort_##S(arr, low, high); \
+} \
+\
+static int searchBIN_##S(const T* arr, int n, T sr) { \
+    int start = 0, end = n; \
+    while (start < end) { \
+        int mid = start + (end - start) / 2; \
+        if (arr[mid] < sr) \
+            start = mid + 1; \
+        else \
+            end = mid; \
+    } \
+    return (start < n && arr[start] == sr) ? start : -1; \
+} \
+\
+static bool isSorted_##S(const T* arr, int n) { \
+    for (int i = 1; i < n; i++) { \
+        if (arr[i] < arr[i - 1]) \
+            return false; \
+    } \
+    return true; \
+} \
+\
+static unsigned long long hashCode_##S(const T* arr, int n) { \
+    if (arr == NULL) \
+        return 0; \
+    unsigned long long hash = 1; \
+    for (int i = 0; i < n; i++) \
+        hash = hash * 19 + (unsigned long long)KEY_FN(arr[i]); \
+    return hash; \
+}
+
+#define ARRAYS_DEFINE_TYPE_KERNELS(S, T, SUM_T, ACC_T, ISA, ATTR) \
+static ATTR T minValue_##S##_##ISA(const T* arr, int n) { \
+    if (n <= 0) \
+        return (T)0; \
+    T lanes[ARRAYS_TYPED_LANES]; \
+    for (int l = 0; l < ARRAYS_TYPED_LANES; ++l) \
+        lanes[l] = arr[0]; \
+    int i = 0; \
+    for (; i + ARRAYS_TYPED_LANES <= n; i += ARRAYS_TYPED_LANES) \
+        for (int l = 0; l < ARRAYS_TYPED_LANES; ++l) \
+            lanes[l] = arr[i + l] < lanes[l] ? arr[i + l] : lanes[l]; \
+    T minimum = lanes[0]; \
+    for (int l = 1; l < ARRAYS_TYPED_LANES; ++l) \
+        minimum = lanes[l] < minimum ? lanes[l] : minimum; \
+    for (; i < n; ++i) \
+        minimum = arr[i] < minimum ? arr[i] : minimum; \
+    return minimum; \
+} \
+\
+static ATTR T maxValue_##S##_##ISA(const T* arr, int n) { \
+    if (n <= 0) \
+        return (T)0; \
+    T lanes[ARRAYS_TYPED_LANES]; \
+    for (int l = 0; l < ARRAYS_TYPED_LANES; ++l) \
+        lanes[l] = arr[0]; \
+    int i = 0; \
+    for (; i + ARRAYS_TYPED_LANES <= n; i += ARRAYS_TYPED_LANES) \
+        for (int l = 0; l < ARRAYS_TYPED_LANES; ++l) \
+            lanes[l] = lanes[l] < arr[i + l] ? arr[i + l] : lanes[l]; \
+    T maximum = lanes[0]; \
+    for (int l = 1; l < ARRAYS_TYPED_LANES; ++l) \
+        maximum = maximum < lanes[l] ? lanes[l] : maximum; \
+    for (; i < n; ++i) \
+        maximum = maximum < arr[i] ? arr[i] : maximum; \
+    return maximum; \
+} \
+\
+static ATTR void minMax_##S##_##ISA(const T* arr, int n, T* minimum, T* maximum) { \
+    *minimum = minValue_##S##_##ISA(arr, n); \
+    *maximum = maxValue_##S##_##ISA(arr, n); \
+} \
+\
+static ATTR SUM_T sum_##S##_##ISA(const T* arr, int n) { \
+    ACC_T lanes[ARRAYS_TYPED_LANES]; \
+    for (int l = 0; l < ARRAYS_TYPED_LANES; ++l) \
+        lanes[l] = 0; \
+    int i = 0; \
+    for (; i + ARRAYS_TYPED_LANES <= n; i += ARRAYS_TYPED_LANES) \
+        for (int l = 0; l < ARRAYS_TYPED_LANES; ++l) \
+            lanes[l] += (ACC_T)arr[i + l]; \
+    ACC_T sum = 0; \
+    for (int l = 0; l < ARRAYS_TYPED_LANES; ++l) \
+        sum += lanes[l]; \
+    for (; i < n; ++i) \
+        sum += (ACC_T)arr[i]; \
+    return (SUM_T)sum; \
+} \
+\
+static ATTR int count_##S##_##ISA(const T* arr, int n, T sr) { \
+    int lanes[ARRAYS_TYPED_LANES]; \
+    for (int l = 0; l < ARRAYS_TYPED_LANES; ++l) \
+        lanes[l] = 0; \
+    int i = 0; \
+    for (; i + ARRAYS_TYPED_LANES <= n; i += ARRAYS_TYPED_LANES) \
+        for (int l = 0; l < ARRAYS_TYPED_LANES; ++l) \
+            lanes[l] += (arr[i + l] == sr); \
+    int count = 0; \
+    for (int l = 0; l < ARRAYS_TYPED_LANES; ++l) \
+        count += lanes[l]; \
+    for (; i < n; ++i) \
+        count += (arr[i] == sr); \
+    return count; \
+} \
+\
+static ATTR int searchLIN_##S##_##ISA(const T* arr, int n, T sr) { \
+    int i = 0; \
+    for (; i + ARRAYS_TYPED_LANES <= n; i += ARRAYS_TYPED_LANES) { \
+        int any = 0; \
+        for (int l = 0; l < ARRAYS_TYPED_LANES; ++l) \
+            any |= (arr[i + l] == sr); \
+        if (any) \
+            break; \
+    } \
+    for (; i < n; ++i) { \
+        if (arr[i] == sr) \
+            return i; \
+    } \
+    return -1; \
+}
+
+#define ARRAYS_INSTALL_TYPE_KERNELS(S, ISA) \
+    Arrays_##S.searchLIN = searchLIN_##S##_##ISA; \
+    Arrays_##S.count = count_##S##_##ISA; \
+    Arrays_##S.minValue = minValue_##S##_##ISA; \
+    Arrays_##S.maxValue = maxValue_##S##_##ISA; \
+    Arrays_##S.minMax = minMax_##S##_##ISA; \
+    Arrays_##S.sum = sum_##S##_##ISA;
+
+#if defined(ARRAYS_X86_SIMD)
+#define ARRAYS_DEFINE_TYPE_DISPATCH(S, T, SUM_T, ACC_T) \
+ARRAYS_DEFINE_TYPE_KERNELS(S, T, SUM_T, ACC_T, scalar, ) \
+ARRAYS_DEFINE_TYPE_KERNELS(S, T, SUM_T, ACC_T, sse42, ARRAYS_TARGET_SSE42) \
+ARRAYS_DEFINE_TYPE_KERNELS(S, T, SUM_T, ACC_T, avx2, ARRAYS_TARGET_AVX2) \
+ARRAYS_DEFINE_TYPE_KERNELS(S, T, SUM_T, ACC_T, avx512, ARRAYS_TARGET_AVX512) \
+static void installTypeKernels_##S(isa_level level) { \
+    ARRAYS_INSTALL_TYPE_KERNELS(S, scalar) \
+    if (level == ISA_SSE42) { \
+        ARRAYS_INSTALL_TYPE_KERNELS(S, sse42) \
+    } else if (level == ISA_AVX2) { \
+        ARRAYS_INSTALL_TYPE_KERNELS(S, avx2) \
+    } else if (level == ISA_AVX512) { \
+        ARRAYS_INSTALL_TYPE_KERNELS(S, avx512) \
+    } \
 }
+#else
+#define ARRAYS_DEFINE_TYPE_DISPATCH(S, T, SUM_T, ACC_T) \
+ARRAYS_DEFINE_TYPE_KERNELS(S, T, SUM_T, ACC_T, scalar, ) \
+static void installTypeKernels_##S(isa_level level) { \
+    (void)level; \
+    ARRAYS_INSTALL_TYPE_KERNELS(S, scalar) \
+}
+#endif
 
+#define ARRAYS_DEFINE_TYPE(S, T, KEY_T, KEY_FN, SUM_T, ACC_T) \
+ARRAYS_DEFINE_TYPE_BASE(S, T, KEY_T, KEY_FN, SUM_T, ACC_T) \
+ARRAYS_DEFINE_TYPE_DISPATCH(S, T, SUM_T, ACC_T) \
+status_code useArrayFunctions_##S(isa_level level) { \
+    Arrays_##S.sort = sort_##S; \
+    Arrays_##S.radixSort = radixSort_##S; \
+    Arrays_##S.searchBIN = searchBIN_##S; \
+    Arrays_##S.isSorted = isSorted_##S; \
+    Arrays_##S.hashCode = hashCode_##S; \
+    installTypeKernels_##S(level); \
+    return SUCCESS; \
+}
 
 /**
- * @brief Checks if an integer array is sorted in ascending order.
+ * Order-preserving unsigned keys for the built-in element types: signed integers flip the
+ * sign bit; floating point values flip the sign bit when positive and every bit when negative.
+ */
+static inline uint64_t typedKey_i64(int64_t value) {
+    return (uint64_t)value ^ 0x8000000000000000ull;
+}
+
+static inline uint32_t typedKey_u32(uint32_t value) {
+    return value;
+}
+
+static inline uint32_t typedKey_f32(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits ^ ((bits & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u);
+}
+
+static inline uint64_t typedKey_f64(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits ^ ((bits & 0x8000000000000000ull) ? 0xFFFFFFFFFFFFFFFFull : 0x8000000000000000ull);
+}
+
+ARRAYS_DEFINE_TYPE(i64, int64_t, uint64_t, typedKey_i64, long long, unsigned long long)
+ARRAYS_DEFINE_TYPE(u32, uint32_t, uint32_t, typedKey_u32, unsigned long long, unsigned long long)
+ARRAYS_DEFINE_TYPE(f32, float, uint32_t, typedKey_f32, double, double)
+ARRAYS_DEFINE_TYPE(f64, double, uint64_t, typedKey_f64, double, double)
+
+
+/**
+ * CPU dispatch.
  *
- * This inline function iterates through the elements of the given array,
- * comparing each element with its predecessor. If any element is smaller
- * than its preceding element, the function returns false, indicating that
- * the array is not sorted. Otherwise, it returns true, signifying that the
- * array is sorted in ascending order.
+ * useArrayFunctions() probes the CPU once and fills every slot of Arrays with the fastest
+ * kernel the machine supports. Kernels are installed tier by tier (scalar, then SSE4.2,
+ * AVX2, AVX-512), so a slot without a kernel at the selected tier keeps the best one below it.
  *
- * @param arr Pointer to the integer array.
- * @param n   Number of elements in the array.
- * @return    True if the array is sorted in ascending order, false otherwise.
+ * The ARRAYS_ISA environment variable ("scalar", "sse4.2", "avx2", "avx512" or "neon") caps
+ * the level picked by useArrayFunctions(); useArrayFunctionsFor() selects a level directly.
  */
-inline bool checkForSort(int *arr, int n)
-{
-    for (int i = 1; i < n; i++)
-    {
-        if (arr[i]<arr[i-1])
-        return false;
+static isa_level arraysActiveISA = ISA_SCALAR;
+
+/**
+ * @brief Probes the CPU for the best supported instruction set level. The result is cached.
+ * @return The highest isa_level the running CPU (and operating system) supports.
+ */
+isa_level detectISA() {
+    static int detected = -1;
+    if (detected >= 0)
+        return (isa_level)detected;
+    isa_level level = ISA_SCALAR;
+#if defined(ARRAYS_X86_SIMD)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        level = ISA_AVX512;
+    else if (__builtin_cpu_supports("avx2"))
+        level = ISA_AVX2;
+    else if (__builtin_cpu_supports("sse4.2"))
+        level = ISA_SSE42;
+#elif defined(ARRAYS_NEON_SIMD)
+    level = ISA_NEON;
+#endif
+    detected = (int)level;
+    return level;
+}
+
+/**
+ * @brief Returns the instruction set level whose kernels are currently installed in Arrays.
+ */
+isa_level activeISA() {
+    return arraysActiveISA;
+}
+
+/**
+ * @brief Returns the printable name of an instruction set level, as accepted by ARRAYS_ISA.
+ */
+const char* isaName(isa_level level) {
+    switch (level) {
+    case ISA_SSE42:
+        return "sse4.2";
+    case ISA_AVX2:
+        return "avx2";
+    case ISA_AVX512:
+        return "avx512";
+    case ISA_NEON:
+        return "neon";
+    default:
+        return "scalar";
     }
-    
+}
+
+/**
+ * @brief Reports whether kernels for `level` can run on this CPU.
+ */
+static bool isaSupported(isa_level level) {
+    isa_level best = detectISA();
+    if (level == ISA_SCALAR)
+        return true;
+    if (level == ISA_NEON || best == ISA_NEON)
+        return level == best;
+    return level <= best;
+}
+
+/**
+ * @brief Parses the ARRAYS_ISA environment variable.
+ * @return true and the level in `level` if the variable is set to a known name.
+ */
+static bool isaFromEnvironment(isa_level* level) {
+    const char* name = getenv("ARRAYS_ISA");
+    if (name == NULL)
+        return false;
+    if (strcmp(name, "scalar") == 0)
+        *level = ISA_SCALAR;
+    else if (strcmp(name, "sse4.2") == 0 || strcmp(name, "sse42") == 0)
+        *level = ISA_SSE42;
+    else if (strcmp(name, "avx2") == 0)
+        *level = ISA_AVX2;
+    else if (strcmp(name, "avx512") == 0)
+        *level = ISA_AVX512;
+    else if (strcmp(name, "neon") == 0)
+        *level = ISA_NEON;
+    else
+        return false;
     return true;
 }
 
+/**
+ * @brief Fills every slot of Arrays with the portable scalar implementation.
+ */
+static void installScalarFunctions() {
+    Arrays.copyOfRange = copyOfRange;
+    Arrays.copyOfRangeInto = copyOfRangeInto;
+    Arrays.setAllocator = useArrayAllocator;
+    Arrays.release = arraysRelease;
+    Arrays.getMaxOccurrence = MAX_count;
+    Arrays.mode = modeOf;
+    Arrays.countDistinct = countDistinct;
+    Arrays.histogram = histogram;
+    Arrays.view = arrayView;
+    Arrays.stridedView = stridedView;
+    Arrays.viewRange = viewRange;
+    Arrays.viewReverse = viewReverse;
+    Arrays.viewRotate = viewRotate;
+    Arrays.viewGet = viewGet;
+    Arrays.viewSum = viewSum;
+    Arrays.viewCopy = viewCopy;
+    Arrays.pipelineInit = pipelineInit;
+    Arrays.pipelineFilter = pipelineFilter;
+    Arrays.pipelineMap = pipelineMap;
+    Arrays.pipelineReduce = pipelineReduce;
+    Arrays.pipelineSum = pipelineSum;
+    Arrays.pipelineCount = pipelineCount;
+    Arrays.pipelineCollect = pipelineCollect;
+    Arrays.handleInit = handleInit;
+    Arrays.handleFree = handleFree;
+    Arrays.handleAppend = handleAppend;
+    Arrays.handleSet = handleSet;
+    Arrays.handleWrite = handleWrite;
+    Arrays.handleInvalidate = handleInvalidate;
+    Arrays.handleIsSorted = handleIsSorted;
+    Arrays.handleMin = handleMin;
+    Arrays.handleMax = handleMax;
+    Arrays.handleHashCode = handleHashCode;
+    Arrays.handleSort = handleSort;
+    Arrays.handleSearch = handleSearch;
+    Arrays.vectorInit = vectorInit;
+    Arrays.smallVectorInit = smallVectorInit;
+    Arrays.vectorReserve = vectorReserve;
+    Arrays.vectorShrink = vectorShrink;
+    Arrays.vectorAppend = vectorAppend;
+    Arrays.vectorAppendN = vectorAppendN;
+    Arrays.vectorResize = vectorResize;
+    Arrays.vectorClear = vectorClear;
+    Arrays.vectorFree = vectorFree;
+    Arrays.vectorView = vectorView;
+    Arrays.toString = convertToString;
+    Arrays.stringLength = stringLength;
+    Arrays.toStringInto = toStringInto;
+    Arrays.writeTo = writeTo;
+    Arrays.maxValue = getmaxOf;
+    Arrays.minValue = getminOf;
+    Arrays.minMax = getMinMaxOf;
+    Arrays.reverse = reverse;
+    Arrays.rotate = rotate;
+    Arrays.rotateLeft = rotateLeft;
+    Arrays.search = search;
+    Arrays.count = countOccurrences;
+    Arrays.searchAll = searchAll;
+    Arrays.searchBIN = searchBIN;
+    Arrays.searchBINBatch = searchBINBatch;
+    Arrays.buildIndex = buildSearchIndex;
+    Arrays.freeIndex = freeSearchIndex;
+    Arrays.lowerBound = indexLowerBound;
+    Arrays.find = indexFind;
+    Arrays.searchLIN = searchLIN;
+#ifdef ARRAYS_NO_ADAPTIVE_SORT
+    Arrays.sort = dualPivotQuickSort;
+#else
+    Arrays.sort = adaptiveSort;
+#endif
+    Arrays.radixSort = radixSort;
+    Arrays.select = selectNth;
+    Arrays.partialSort = partialSort;
+    Arrays.topKInit = topKInit;
+    Arrays.topKUpdate = topKUpdate;
+    Arrays.topKResult = topKResult;
+    Arrays.argsort = argsort;
+    Arrays.stableSort = stableSort;
+    Arrays.applyPermutation = applyPermutation;
+    Arrays.parallelSort = parallelSort;
+    Arrays.shutdownThreads = shutdownThreads;
+    Arrays.setParallelGrain = setParallelGrain;
+    Arrays.parallelSum = parallelSum;
+    Arrays.parallelPrefixSum = parallelPrefixSum;
+    Arrays.parallelMinMax = parallelMinMax;
+    Arrays.parallelCount = parallelCount;
+    Arrays.parallelHistogram = parallelHistogram;
+    Arrays.parallelHash = parallelHash;
+    Arrays.parallelReverse = parallelReverse;
+    Arrays.parallelCopy = parallelCopy;
+    Arrays.mapFile = mapArrayFile;
+    Arrays.syncFile = syncArrayFile;
+    Arrays.unmapFile = unmapArrayFile;
+    Arrays.writeFile = writeArrayFile;
+    Arrays.externalSort = externalSort;
+    Arrays.compare = compareTwoArray;
+    Arrays.mismatch = firstMismatch;
+    Arrays.compareOrder = compareArrays;
+    Arrays.mergeSorted = mergeSorted;
+    Arrays.unionSorted = unionSorted;
+    Arrays.intersectSorted = intersectSorted;
+    Arrays.differenceSorted = differenceSorted;
+    arraysFilterSorted = filterSorted;
+    Arrays.sum = sumAllElements;
+    Arrays.prefixSum = prefixSum;
+    Arrays.exclusivePrefixSum = exclusivePrefixSum;
+    Arrays.segmentedPrefixSum = segmentedPrefixSum;
+    Arrays.windowSum = windowSum;
+    Arrays.windowMin = windowMin;
+    Arrays.windowMax = windowMax;
+    arraysPrefixSums = prefixSums;
+    Arrays.isSorted = checkForSort;
+    Arrays.concat = concatenateTwoArrays;
+    Arrays.concatInto = concatInto;
+    Arrays.concatN = concatN;
+    Arrays.indexOf = firstIndexOf;
+    Arrays.hashCode = getHashCodeOf;
+    Arrays.hashInit = hashStateInit;
+    Arrays.hashUpdate = hashStateUpdate;
+    Arrays.hashFinal = hashStateFinal;
+    Arrays.fastHash = fastHashOf;
+    arraysHashStripes = hashStripes;
+    Arrays.detectISA = detectISA;
+    Arrays.activeISA = activeISA;
+}
 
 /**
- * @brief Concatenates two arrays into a new array.
- *
- * @param arr1 The first array.
- * @param size1 The size of the first array.
- * @param arr2 The second array.
- * @param size2 The size of the second array.
- * @return A new array containing elements from both input arrays.
- * 
- * NOTE: The array returned must be freed explicitly by the user.
+ * @brief Overrides the slots that have a kernel for `level`. Lower tiers must already be installed.
  */
-inline int *concatenateTwoArrays(int *arr1, int size1, int *arr2, int size2)
-{
-    int* new_array = (int*)malloc((size1+size2)*sizeof(int));
-    int i = 0;
-    for (; i < size1 && i<size2; i++)
-    {
-        new_array[i] = arr1[i];
-        new_array[size1+i] = arr2[i];
+static void installKernels(isa_level level) {
+#if defined(ARRAYS_X86_SIMD)
+    switch (level) {
+    case ISA_SSE42:
+        Arrays.minValue = getminOf_sse42;
+        Arrays.maxValue = getmaxOf_sse42;
+        Arrays.minMax = getMinMaxOf_sse42;
+        Arrays.sum = sumAllElements_sse42;
+        Arrays.getMaxOccurrence = MAX_count_sse42;
+        Arrays.searchLIN = searchLIN_sse42;
+        Arrays.indexOf = firstIndexOf_sse42;
+        Arrays.count = countOccurrences_sse42;
+        Arrays.searchAll = searchAll_sse42;
+        arraysHashStripes = hashStripes_sse42;
+        Arrays.mismatch = firstMismatch_sse42;
+        arraysFilterSorted = filterSorted_sse42;
+        break;
+    case ISA_AVX2:
+        Arrays.minValue = getminOf_avx2;
+        Arrays.maxValue = getmaxOf_avx2;
+        Arrays.minMax = getMinMaxOf_avx2;
+        Arrays.sum = sumAllElements_avx2;
+        arraysPrefixSums = prefixSums_avx2;
+        Arrays.getMaxOccurrence = MAX_count_avx2;
+        Arrays.searchLIN = searchLIN_avx2;
+        Arrays.indexOf = firstIndexOf_avx2;
+        Arrays.count = countOccurrences_avx2;
+        Arrays.searchAll = searchAll_avx2;
+        arraysHashStripes = hashStripes_avx2;
+        Arrays.mismatch = firstMismatch_avx2;
+        arraysFilterSorted = filterSorted_avx2;
+        Arrays.applyPermutation = applyPermutation_avx2;
+        break;
+    case ISA_AVX512:
+        Arrays.minValue = getminOf_avx512;
+        Arrays.maxValue = getmaxOf_avx512;
+        Arrays.minMax = getMinMaxOf_avx512;
+        Arrays.sum = sumAllElements_avx512;
+        arraysPrefixSums = prefixSums_avx512;
+        Arrays.getMaxOccurrence = MAX_count_avx512;
+        Arrays.searchLIN = searchLIN_avx512;
+        Arrays.indexOf = firstIndexOf_avx512;
+        Arrays.count = countOccurrences_avx512;
+        Arrays.searchAll = searchAll_avx512;
+        arraysHashStripes = hashStripes_avx512;
+        Arrays.mismatch = firstMismatch_avx512;
+        Arrays.applyPermutation = applyPermutation_avx512;
+        break;
+    default:
+        break;
     }
-    while (i<size1)
-    {
-        new_array[i] = arr1[i];
-        i++;
+#elif defined(ARRAYS_NEON_SIMD)
+    if (level == ISA_NEON) {
+        Arrays.minValue = getminOf_neon;
+        Arrays.maxValue = getmaxOf_neon;
+        Arrays.minMax = getMinMaxOf_neon;
+        Arrays.sum = sumAllElements_neon;
+        arraysPrefixSums = prefixSums_neon;
+        Arrays.getMaxOccurrence = MAX_count_neon;
+        Arrays.searchLIN = searchLIN_neon;
+        Arrays.indexOf = firstIndexOf_neon;
+        Arrays.count = countOccurrences_neon;
+        Arrays.searchAll = searchAll_neon;
+        arraysHashStripes = hashStripes_neon;
+        Arrays.mismatch = firstMismatch_neon;
+        arraysFilterSorted = filterSorted_neon;
     }
-    while (i<size2)
-    {
-        new_array[size1+i] = arr2[i];
-        i++;
+#else
+    (void)level;
+#endif
+}
+
+/**
+ * Instrumentation.
+ *
+ * useInstrumentedFunctions(true), or ARRAYS_INSTRUMENT=1 in the environment of
+ * useArrayFunctions(), wraps every slot of Arrays after the kernels are installed. A wrapper
+ * reads the cycle counter around the call and adds the call, its element count and its
+ * latency to counters owned by the calling thread, so no locks or shared cache lines are
+ * touched. callStats(), dumpCallStats() and resetCallStats() sum the counters of all threads.
+ *
+ * When instrumentation is disabled the slots point straight at the kernels. Calls made
+ * through Arrays by other functions (Arrays64 chunks, the parallel tasks) are counted under
+ * the slot they call. Latencies are in ticks of the cycle counter: the time stamp counter on
+ * x86, the virtual counter on AArch64 and clock() elsewhere.
+ */
+#define ARRAYS_SLOT_COUNT (sizeof(Array_Functions) / sizeof(void (*)()))
+#define ARRAYS_SLOT(slot) (offsetof(Array_Functions, slot) / sizeof(void (*)()))
+
+struct arrays_slot_counters {
+    uint64_t calls;
+    uint64_t elements;
+    uint64_t ticks;
+    uint64_t histogram[ARRAYS_INSTRUMENT_BUCKETS];
+};
+
+struct arrays_thread_counters {
+    struct arrays_thread_counters* next;
+    struct arrays_thread_counters* nextFree;
+    struct arrays_slot_counters slots[ARRAYS_SLOT_COUNT];
+};
+
+static bool arraysInstrumented = false;
+static const char* arraysSlotNames[ARRAYS_SLOT_COUNT];
+static ARRAYS_ATOMIC(struct arrays_thread_counters*) arraysThreadCounters = NULL;
+static ARRAYS_THREAD_LOCAL struct arrays_thread_counters* arraysLocalCounters = NULL;
+static struct arrays_slot_counters arraysCounterBaseline[ARRAYS_SLOT_COUNT];
+
+#ifndef ARRAYS_NO_THREADS
+/**
+ * Counters of threads that have exited, and their zeroed blocks waiting for a new thread.
+ * Blocks stay on arraysThreadCounters for good; arraysCounterLock guards the free list, the
+ * retired totals and the hand-over between them, so a sum never sees a count twice or not at all.
+ */
+static pthread_mutex_t arraysCounterLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t arraysCounterKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t arraysCounterKey;
+static bool arraysCounterKeyMade = false;
+static struct arrays_thread_counters* arraysFreeCounters = NULL;
+static struct arrays_slot_counters arraysRetiredCounters[ARRAYS_SLOT_COUNT];
+
+/**
+ * @brief Runs when a thread that made instrumented calls exits: adds its counts to the
+ * retired totals, zeroes its block and puts the block on the free list.
+ */
+static void retireThreadCounters(void* block) {
+    struct arrays_thread_counters* local = (struct arrays_thread_counters*)block;
+    pthread_mutex_lock(&arraysCounterLock);
+    for (size_t slot = 0; slot < ARRAYS_SLOT_COUNT; ++slot) {
+        ARRAYS_ATOMIC(uint64_t)* from = (ARRAYS_ATOMIC(uint64_t)*)&local->slots[slot].calls;
+        uint64_t* to = &arraysRetiredCounters[slot].calls;
+        for (size_t i = 0; i < sizeof(struct arrays_slot_counters) / sizeof(uint64_t); ++i) {
+            to[i] += ARRAYS_ATOMIC_LOAD(&from[i], ARRAYS_RELAXED);
+            ARRAYS_ATOMIC_STORE(&from[i], 0, ARRAYS_RELAXED);
+        }
     }
-    
-    return new_array;
+    local->nextFree = arraysFreeCounters;
+    arraysFreeCounters = local;
+    pthread_mutex_unlock(&arraysCounterLock);
+    arraysLocalCounters = NULL;
 }
 
+static void createCounterKey() {
+    arraysCounterKeyMade = pthread_key_create(&arraysCounterKey, retireThreadCounters) == 0;
+}
+#endif
 
 /**
- * @brief Return the index of first occurrence of the element in the array.
- * @param arr Array.
- * @param n Size of the array.
- * @param element Element to be searched
- * @return index of the found element 
-*/
-inline int firstIndexOf(int *arr, int n, int element)
-{
-    for (int i = 0; i < n; i++)
-    {
-        if (arr[i]==element)
-            return i;
+ * @brief Reads the cycle counter used for call latencies.
+ */
+static inline uint64_t arraysTicks() {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    uint64_t ticks;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return (uint64_t)clock();
+#endif
+}
+
+/**
+ * @brief Adds to a counter of the calling thread. Only the owner writes it, so a relaxed
+ * load and store suffice; readers on other threads see a recent value.
+ */
+static inline void counterAdd(uint64_t* word, uint64_t value) {
+    ARRAYS_ATOMIC(uint64_t)* counter = (ARRAYS_ATOMIC(uint64_t)*)word;
+    ARRAYS_ATOMIC_STORE(counter, ARRAYS_ATOMIC_LOAD(counter, ARRAYS_RELAXED) + value, ARRAYS_RELAXED);
+}
+
+/**
+ * @brief Gives the calling thread its counters: a block retired by an exited thread if there
+ * is one, otherwise a new block published on arraysThreadCounters. Returns NULL without memory.
+ */
+static struct arrays_thread_counters* acquireThreadCounters() {
+#ifndef ARRAYS_NO_THREADS
+    pthread_once(&arraysCounterKeyOnce, createCounterKey);
+    pthread_mutex_lock(&arraysCounterLock);
+    struct arrays_thread_counters* local = arraysFreeCounters;
+    if (local != NULL) {
+        arraysFreeCounters = local->nextFree;
+    } else {
+        local = (struct arrays_thread_counters*)calloc(1, sizeof(struct arrays_thread_counters));
+        if (local != NULL) {
+            local->next = ARRAYS_ATOMIC_LOAD(&arraysThreadCounters, ARRAYS_RELAXED);
+            ARRAYS_ATOMIC_STORE(&arraysThreadCounters, local, ARRAYS_RELEASE);
+        }
     }
-    
-    return -1;
+    pthread_mutex_unlock(&arraysCounterLock);
+    if (local != NULL && arraysCounterKeyMade)
+        pthread_setspecific(arraysCounterKey, local);
+    return local;
+#else
+    struct arrays_thread_counters* local = (struct arrays_thread_counters*)calloc(1, sizeof(struct arrays_thread_counters));
+    if (local != NULL)
+        ARRAYS_ATOMIC_STORE(&arraysThreadCounters, local, ARRAYS_RELEASE);
+    return local;
+#endif
 }
 
+/**
+ * @brief Records one call of a slot on the counters of the calling thread, acquiring them on
+ * its first call.
+ */
+static void recordCall(size_t slot, long long elements, uint64_t start) {
+    uint64_t ticks = arraysTicks() - start;
+    struct arrays_thread_counters* local = arraysLocalCounters;
+    if (local == NULL) {
+        local = acquireThreadCounters();
+        if (local == NULL)
+            return;
+        arraysLocalCounters = local;
+    }
+    struct arrays_slot_counters* counters = &local->slots[slot];
+    int bucket = ticks == 0 ? 0 : 64 - ARRAYS_CLZLL(ticks);
+    if (bucket >= ARRAYS_INSTRUMENT_BUCKETS)
+        bucket = ARRAYS_INSTRUMENT_BUCKETS - 1;
+    counterAdd(&counters->calls, 1);
+    counterAdd(&counters->elements, elements > 0 ? (uint64_t)elements : 0);
+    counterAdd(&counters->ticks, ticks);
+    counterAdd(&counters->histogram[bucket], 1);
+}
 
 /**
- * @brief Calculates the hash code of an integer array.
+ * Every slot of Arrays, with the parameters of its wrapper and the element count recorded
+ * for a call (evaluated after the call; `result` is the return value).
+ * X(slot, return type, parameters, arguments, elements) for slots returning a value and
+ * V(slot, parameters, arguments, elements) for void slots.
+ */
+#define ARRAYS_INSTRUMENTED_SLOTS(X, V) \
+    X(copyOfRange, int*, (const int* arr, int start, int end), (arr, start, end), end - start) \
+    X(copyOfRangeInto, int, (const int* arr, int start, int end, int* dest, int capacity), (arr, start, end, dest, capacity), end - start) \
+    V(setAllocator, (const array_allocator* allocator), (allocator), 0) \
+    V(release, (void* ptr), (ptr), 0) \
+    X(rotate, int*, (int* arr, int n, int k), (arr, n, k), n) \
+    X(rotateLeft, int*, (int* arr, int n, int k), (arr, n, k), n) \
+    X(searchLIN, int, (const int* arr, int n, int sr), (arr, n, sr), n) \
+    X(search, int, (const int* arr, int n, int sr), (arr, n, sr), n) \
+    X(count, int, (const int* arr, int n, int sr), (arr, n, sr), n) \
+    X(searchAll, int, (const int* arr, int n, int sr, int* indices, int capacity), (arr, n, sr, indices, capacity), n) \
+    X(searchBIN, int, (const int* arr, int n, int sr), (arr, n, sr), n) \
+    V(searchBINBatch, (const int* arr, int n, const int* keys, int m, int* out), (arr, n, keys, m, out), m) \
+    X(buildIndex, search_index*, (const int* sorted, int n), (sorted, n), n) \
+    V(freeIndex, (search_index* index), (index), 0) \
+    X(lowerBound, int, (const search_index* index, int sr), (index, sr), 1) \
+    X(find, int, (const search_index* index, int sr), (index, sr), 1) \
+    X(reverse, int*, (int* arr, int n), (arr, n), n) \
+    X(maxValue, int, (const int* arr, int n), (arr, n), n) \
+    X(minValue, int, (const int* arr, int n), (arr, n), n) \
+    V(minMax, (const int* arr, int n, int* minimum, int* maximum), (arr, n, minimum, maximum), n) \
+    X(getMaxOccurrence, int, (const int* arr, int n), (arr, n), n) \
+    X(mode, int, (const int* arr, int n, int* count), (arr, n, count), n) \
+    X(countDistinct, int, (const int* arr, int n), (arr, n), n) \
+    X(histogram, int, (const int* arr, int n, int low, int high, int buckets, int* counts), (arr, n, low, high, buckets, counts), n) \
+    X(view, array_view, (const int* arr, int n), (arr, n), 0) \
+    X(stridedView, array_view, (const int* arr, int n, int stride), (arr, n, stride), 0) \
+    X(viewRange, status_code, (const array_view* v, int start, int end, array_view* out), (v, start, end, out), 0) \
+    X(viewReverse, array_view, (const array_view* v), (v), 0) \
+    X(viewRotate, status_code, (const array_view* v, int k, array_view* out), (v, k, out), 0) \
+    X(viewGet, int, (const array_view* v, int i), (v, i), 1) \
+    X(viewSum, long long, (const array_view* v), (v), v->length) \
+    X(viewCopy, int, (const array_view* v, int* dest), (v, dest), result) \
+    V(pipelineInit, (array_pipeline* p, const array_view* source), (p, source), 0) \
+    X(pipelineFilter, status_code, (array_pipeline* p, bool (*keep)(int value, void* context), void* context), (p, keep, context), 0) \
+    X(pipelineMap, status_code, (array_pipeline* p, int (*map)(int value, void* context), void* context), (p, map, context), 0) \
+    X(pipelineReduce, long long, (const array_pipeline* p, long long initial, long long (*reduce)(long long acc, int value, void* context), void* context), (p, initial, reduce, context), p->source.length) \
+    X(pipelineSum, long long, (const array_pipeline* p), (p), p->source.length) \
+    X(pipelineCount, int, (const array_pipeline* p), (p), p->source.length) \
+    X(pipelineCollect, int, (const array_pipeline* p, int* dest, int capacity), (p, dest, capacity), p->source.length) \
+    X(handleInit, status_code, (array_handle* h, const int* arr, int n), (h, arr, n), n) \
+    V(handleFree, (array_handle* h), (h), 0) \
+    X(handleAppend, status_code, (array_handle* h, int value), (h, value), 1) \
+    X(handleSet, status_code, (array_handle* h, int i, int value), (h, i, value), 1) \
+    X(handleWrite, status_code, (array_handle* h, int at, const int* src, int count), (h, at, src, count), count) \
+    V(handleInvalidate, (array_handle* h), (h), 0) \
+    X(handleIsSorted, bool, (array_handle* h), (h), 0) \
+    X(handleMin, int, (array_handle* h), (h), 0) \
+    X(handleMax, int, (array_handle* h), (h), 0) \
+    X(handleHashCode, unsigned long long, (array_handle* h), (h), 0) \
+    V(handleSort, (array_handle* h), (h), h->size) \
+    X(handleSearch, int, (array_handle* h, int value), (h, value), 1) \
+    V(vectorInit, (array_vector* v), (v), 0) \
+    V(smallVectorInit, (array_small_vector* small), (small), 0) \
+    X(vectorReserve, status_code, (array_vector* v, int capacity), (v, capacity), 0) \
+    X(vectorShrink, status_code, (array_vector* v), (v), v->size) \
+    X(vectorAppend, status_code, (array_vector* v, int value), (v, value), 1) \
+    X(vectorAppendN, status_code, (array_vector* v, const int* src, int n), (v, src, n), n) \
+    X(vectorResize, status_code, (array_vector* v, int n), (v, n), n) \
+    V(vectorClear, (array_vector* v), (v), 0) \
+    V(vectorFree, (array_vector* v), (v), 0) \
+    X(vectorView, array_view, (const array_vector* v), (v), 0) \
+    X(toString, char*, (const int* arr, int n), (arr, n), n) \
+    X(stringLength, size_t, (const int* arr, int n), (arr, n), n) \
+    X(toStringInto, size_t, (const int* arr, int n, char* buffer, size_t capacity), (arr, n, buffer, capacity), n) \
+    X(writeTo, status_code, (const int* arr, int n, FILE* stream), (arr, n, stream), n) \
+    V(sort, (int* arr, int low, int high), (arr, low, high), (long long)high - low + 1) \
+    X(radixSort, status_code, (int* arr, int low, int high, int* scratch), (arr, low, high, scratch), (long long)high - low + 1) \
+    X(select, int, (int* arr, int n, int k), (arr, n, k), n) \
+    V(partialSort, (int* arr, int n, int k), (arr, n, k), n) \
+    X(topKInit, status_code, (array_top_k* state, int* heap, int k, bool largest), (state, heap, k, largest), 0) \
+    V(topKUpdate, (array_top_k* state, const int* arr, size_t n), (state, arr, n), n) \
+    X(topKResult, int, (const array_top_k* state, int* dest), (state, dest), result) \
+    X(argsort, status_code, (const int* arr, int n, int* indices), (arr, n, indices), n) \
+    X(stableSort, status_code, (int* arr, int n, int* payload), (arr, n, payload), n) \
+    V(applyPermutation, (const int* src, const int* indices, int n, int* dest), (src, indices, n, dest), n) \
+    V(parallelSort, (int* arr, int low, int high, int threads), (arr, low, high, threads), (long long)high - low + 1) \
+    V(shutdownThreads, (), (), 0) \
+    V(setParallelGrain, (size_t grain), (grain), 0) \
+    X(parallelSum, long long, (const int* arr, size_t n, int threads), (arr, n, threads), n) \
+    X(parallelPrefixSum, long long, (const int* arr, size_t n, long long* dest, int threads), (arr, n, dest, threads), n) \
+    V(parallelMinMax, (const int* arr, size_t n, int* minimum, int* maximum, int threads), (arr, n, minimum, maximum, threads), n) \
+    X(parallelCount, size_t, (const int* arr, size_t n, int sr, int threads), (arr, n, sr, threads), n) \
+    X(parallelHistogram, size_t, (const int* arr, size_t n, int low, int high, int buckets, size_t* counts, int threads), (arr, n, low, high, buckets, counts, threads), n) \
+    X(parallelHash, uint64_t, (const int* arr, size_t n, uint64_t seed, int threads), (arr, n, seed, threads), n) \
+    X(parallelReverse, int*, (int* arr, size_t n, int threads), (arr, n, threads), n) \
+    X(parallelCopy, int*, (int* dest, const int* src, size_t n, int threads), (dest, src, n, threads), n) \
+    X(mapFile, status_code, (const char* path, array_file* file, int mode), (path, file, mode), result == SUCCESS ? file->count : 0) \
+    X(syncFile, status_code, (array_file* file), (file), file != NULL ? file->count : 0) \
+    V(unmapFile, (array_file* file), (file), 0) \
+    X(writeFile, status_code, (const char* path, const int* arr, size_t n), (path, arr, n), n) \
+    X(externalSort, status_code, (const char* input, const char* output, size_t memory), (input, output, memory), 0) \
+    X(compare, bool, (int* arr1, int size1, int* arr2, int size2), (arr1, size1, arr2, size2), size1) \
+    X(mismatch, int, (const int* arr1, int size1, const int* arr2, int size2), (arr1, size1, arr2, size2), size1) \
+    X(compareOrder, int, (const int* arr1, int size1, const int* arr2, int size2), (arr1, size1, arr2, size2), size1) \
+    X(mergeSorted, int, (const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity), (arr1, size1, arr2, size2, dest, capacity), (long long)size1 + size2) \
+    X(unionSorted, int, (const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity), (arr1, size1, arr2, size2, dest, capacity), (long long)size1 + size2) \
+    X(intersectSorted, int, (const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity), (arr1, size1, arr2, size2, dest, capacity), (long long)size1 + size2) \
+    X(differenceSorted, int, (const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity), (arr1, size1, arr2, size2, dest, capacity), (long long)size1 + size2) \
+    X(sum, long long, (int* arr, int n), (arr, n), n) \
+    X(prefixSum, long long, (const int* arr, int n, long long* dest), (arr, n, dest), n) \
+    X(exclusivePrefixSum, long long, (const int* arr, int n, long long* dest), (arr, n, dest), n) \
+    V(segmentedPrefixSum, (const int* arr, const bool* heads, int n, long long* dest), (arr, heads, n, dest), n) \
+    X(windowSum, int, (const int* arr, int n, int w, long long* dest), (arr, n, w, dest), n) \
+    X(windowMin, int, (const int* arr, int n, int w, int* dest), (arr, n, w, dest), n) \
+    X(windowMax, int, (const int* arr, int n, int w, int* dest), (arr, n, w, dest), n) \
+    X(isSorted, bool, (int* arr, int n), (arr, n), n) \
+    X(concat, int*, (int* arr1, int size1, int* arr2, int size2), (arr1, size1, arr2, size2), (long long)size1 + size2) \
+    X(concatInto, int, (const int* arr1, int size1, const int* arr2, int size2, int* dest, int capacity), (arr1, size1, arr2, size2, dest, capacity), (long long)size1 + size2) \
+    X(concatN, int, (const int* const* arrays, const int* sizes, int count, int* dest, int capacity), (arrays, sizes, count, dest, capacity), result) \
+    X(indexOf, int, (int* arr, int n, int element), (arr, n, element), n) \
+    X(hashCode, unsigned long long, (int* arr, int n), (arr, n), n) \
+    V(hashInit, (array_hash_state* state, uint64_t seed), (state, seed), 0) \
+    V(hashUpdate, (array_hash_state* state, const int* arr, size_t n), (state, arr, n), n) \
+    X(hashFinal, uint64_t, (const array_hash_state* state), (state), 0) \
+    X(fastHash, uint64_t, (const int* arr, size_t n, uint64_t seed), (arr, n, seed), n) \
+    X(detectISA, isa_level, (), (), 0) \
+    X(activeISA, isa_level, (), (), 0)
+
+#define ARRAYS_DEFINE_WRAPPER(slot, R, PARAMS, ARGS, ELEMENTS) \
+static R (*instrumentedTarget_##slot) PARAMS; \
+static R instrumented_##slot PARAMS { \
+    uint64_t callStart = arraysTicks(); \
+    R result = instrumentedTarget_##slot ARGS; \
+    recordCall(ARRAYS_SLOT(slot), (long long)(ELEMENTS), callStart); \
+    return result; \
+}
+
+#define ARRAYS_DEFINE_VOID_WRAPPER(slot, PARAMS, ARGS, ELEMENTS) \
+static void (*instrumentedTarget_##slot) PARAMS; \
+static void instrumented_##slot PARAMS { \
+    uint64_t callStart = arraysTicks(); \
+    instrumentedTarget_##slot ARGS; \
+    recordCall(ARRAYS_SLOT(slot), (long long)(ELEMENTS), callStart); \
+}
+
+#define ARRAYS_INSTALL_WRAPPER(slot, R, PARAMS, ARGS, ELEMENTS) ARRAYS_INSTALL_VOID_WRAPPER(slot, PARAMS, ARGS, ELEMENTS)
+#define ARRAYS_INSTALL_VOID_WRAPPER(slot, PARAMS, ARGS, ELEMENTS) \
+    instrumentedTarget_##slot = Arrays.slot; \
+    Arrays.slot = instrumented_##slot; \
+    arraysSlotNames[ARRAYS_SLOT(slot)] = #slot;
+
+ARRAYS_INSTRUMENTED_SLOTS(ARRAYS_DEFINE_WRAPPER, ARRAYS_DEFINE_VOID_WRAPPER)
+
+/**
+ * @brief Wraps every slot of Arrays around the kernel currently installed in it.
+ */
+static void installInstrumentation() {
+    ARRAYS_INSTRUMENTED_SLOTS(ARRAYS_INSTALL_WRAPPER, ARRAYS_INSTALL_VOID_WRAPPER)
+}
+
+/**
+ * @brief Sums the counters of every thread, live or exited, into `totals` (ARRAYS_SLOT_COUNT entries).
+ */
+static void sumCallCounters(struct arrays_slot_counters* totals) {
+#ifndef ARRAYS_NO_THREADS
+    pthread_mutex_lock(&arraysCounterLock);
+    memcpy(totals, arraysRetiredCounters, ARRAYS_SLOT_COUNT * sizeof(struct arrays_slot_counters));
+#else
+    memset(totals, 0, ARRAYS_SLOT_COUNT * sizeof(struct arrays_slot_counters));
+#endif
+    struct arrays_thread_counters* thread = ARRAYS_ATOMIC_LOAD(&arraysThreadCounters, ARRAYS_ACQUIRE);
+    for (; thread != NULL; thread = thread->next) {
+        for (size_t slot = 0; slot < ARRAYS_SLOT_COUNT; ++slot) {
+            ARRAYS_ATOMIC(uint64_t)* from = (ARRAYS_ATOMIC(uint64_t)*)&thread->slots[slot].calls;
+            uint64_t* to = &totals[slot].calls;
+            for (size_t i = 0; i < sizeof(struct arrays_slot_counters) / sizeof(uint64_t); ++i)
+                to[i] += ARRAYS_ATOMIC_LOAD(&from[i], ARRAYS_RELAXED);
+        }
+    }
+#ifndef ARRAYS_NO_THREADS
+    pthread_mutex_unlock(&arraysCounterLock);
+#endif
+}
+
+/**
+ * Function: useInstrumentedFunctions
+ * ----------------------------------
+ * Enables or disables the instrumented table. If Arrays is already initialized, its current
+ * instruction set level is installed again, with or without the wrappers; otherwise the
+ * setting applies to the next useArrayFunctions() or useArrayFunctionsFor().
  *
- * This function takes an integer array and calculates its hash code using a specific formula.
+ * Every thread that makes an instrumented call gets its own block of counters, about
+ * ARRAYS_SLOT_COUNT * (3 + ARRAYS_INSTRUMENT_BUCKETS) * 8 bytes (some 32 KB). When the thread
+ * exits its counts move to a shared total and the block is reused by the next new thread,
+ * so memory grows with the most threads counting at once, not with every thread ever created.
+ * Blocks are not freed while the process runs.
  *
- * @param arr Pointer to the integer array.
- * @param n Number of elements in the array.
+ * Parameters:
+ * - enabled: true to count calls, false to point the slots straight at the kernels.
  *
- * @return Unsigned long long representing the hash code.
+ * Returns:
+ * SUCCESS, or the result of reinstalling the current level.
  */
-inline unsigned long long getHashCodeOf(int *arr, int n)
-{
-    if (arr==NULL)
+status_code useInstrumentedFunctions(bool enabled) {
+    arraysInstrumented = enabled;
+    if (Arrays.activeISA == NULL)
+        return SUCCESS;
+    return useArrayFunctionsFor(arraysActiveISA);
+}
+
+/**
+ * Function: callStats
+ * -------------------
+ * Copies the counters of every slot called since the last reset, summed over all threads, in
+ * the order of the slots in Array_Functions. Counters of other threads may lag behind their
+ * latest calls.
+ *
+ * Parameters:
+ * - stats: Receives up to `capacity` entries. May be NULL when capacity is 0.
+ * - capacity: The number of entries `stats` can hold.
+ *
+ * Returns:
+ * The number of slots called since the last reset, which may exceed `capacity`.
+ */
+int callStats(array_call_stats* stats, int capacity) {
+    struct arrays_slot_counters* totals = (struct arrays_slot_counters*)malloc(ARRAYS_SLOT_COUNT * sizeof(struct arrays_slot_counters));
+    if (totals == NULL)
         return 0;
-    unsigned long long hash = 1;
-    for (int i = 0; i < n; i++)
-    {
-        int val = arr[i];
-        val = val ^ (val>>31);
-        hash = hash * 19 + val ;
+    sumCallCounters(totals);
+    int called = 0;
+    for (size_t slot = 0; slot < ARRAYS_SLOT_COUNT; ++slot) {
+        uint64_t calls = totals[slot].calls - arraysCounterBaseline[slot].calls;
+        if (calls == 0)
+            continue;
+        if (called < capacity) {
+            array_call_stats* entry = &stats[called];
+            entry->name = arraysSlotNames[slot];
+            entry->calls = calls;
+            entry->elements = totals[slot].elements - arraysCounterBaseline[slot].elements;
+            entry->ticks = totals[slot].ticks - arraysCounterBaseline[slot].ticks;
+            for (int b = 0; b < ARRAYS_INSTRUMENT_BUCKETS; ++b)
+                entry->histogram[b] = totals[slot].histogram[b] - arraysCounterBaseline[slot].histogram[b];
+        }
+        called++;
     }
-    
-    return hash;
+    free(totals);
+    return called;
+}
+
+/**
+ * @brief Returns the upper bound in ticks of the bucket holding the given fraction of calls.
+ */
+static uint64_t histogramPercentile(const array_call_stats* entry, double fraction) {
+    uint64_t target = (uint64_t)ceil((double)entry->calls * fraction);
+    uint64_t seen = 0;
+    for (int b = 0; b < ARRAYS_INSTRUMENT_BUCKETS; ++b) {
+        seen += entry->histogram[b];
+        if (seen >= target)
+            return (uint64_t)1 << b;
+    }
+    return (uint64_t)1 << (ARRAYS_INSTRUMENT_BUCKETS - 1);
+}
+
+/**
+ * Function: dumpCallStats
+ * -----------------------
+ * Prints one line per slot called since the last reset: calls, elements, mean ticks per call
+ * and per element, and the bucket bounds (powers of two) of the median and 99th percentile latency.
+ *
+ * Parameters:
+ * - out: The stream to write to.
+ *
+ * Returns:
+ * SUCCESS, or FAILURE if the counters could not be collected or the stream reported a write error.
+ */
+status_code dumpCallStats(FILE* out) {
+    array_call_stats* stats = (array_call_stats*)malloc(ARRAYS_SLOT_COUNT * sizeof(array_call_stats));
+    if (stats == NULL || out == NULL) {
+        free(stats);
+        return FAILURE;
+    }
+    int called = callStats(stats, (int)ARRAYS_SLOT_COUNT);
+    bool failed = fprintf(out, "%-18s %12s %16s %14s %12s %10s %10s\n", "function", "calls", "elements",
+                          "ticks/call", "ticks/elem", "p50 <", "p99 <") < 0;
+    for (int i = 0; i < called && !failed; ++i) {
+        const array_call_stats* entry = &stats[i];
+        failed = fprintf(out, "%-18s %12llu %16llu %14.1f %12.3f %10llu %10llu\n", entry->name,
+                         (unsigned long long)entry->calls, (unsigned long long)entry->elements,
+                         (double)entry->ticks / (double)entry->calls,
+                         entry->elements ? (double)entry->ticks / (double)entry->elements : 0.0,
+                         (unsigned long long)histogramPercentile(entry, 0.5),
+                         (unsigned long long)histogramPercentile(entry, 0.99)) < 0;
+    }
+    free(stats);
+    return failed ? FAILURE : SUCCESS;
+}
+
+/**
+ * Function: resetCallStats
+ * ------------------------
+ * Starts the counters of every slot again from zero. Threads keep counting without
+ * interruption; should not be called from two threads at once.
+ */
+void resetCallStats() {
+    sumCallCounters(arraysCounterBaseline);
 }
 
+/**
+ * @brief Initializes the Array_Functions structure with the kernels of a specific instruction set level.
+ *
+ * Intended for benchmarking and testing a particular code path. The ARRAYS_ISA environment variable is ignored.
+ *
+ * @param level The level to install.
+ * @return SUCCESS, or FAILURE (leaving Arrays unchanged) if the CPU does not support `level`.
+ */
+status_code useArrayFunctionsFor(isa_level level) {
+    if (!isaSupported(level))
+        return FAILURE;
+    installScalarFunctions();
+    installLargeFunctions();
+    useArrayFunctions_i64(level);
+    useArrayFunctions_u32(level);
+    useArrayFunctions_f32(level);
+    useArrayFunctions_f64(level);
+    if (level == ISA_NEON) {
+        installKernels(ISA_NEON);
+    } else {
+        for (int tier = ISA_SSE42; tier <= (int)level; ++tier) {
+            installKernels((isa_level)tier);
+        }
+    }
+    if (arraysInstrumented)
+        installInstrumentation();
+    arraysActiveISA = level;
+    return SUCCESS;
+}
 
+/**
+ * @brief Initializes the Array_Functions structure with appropriate function pointers.
+ *
+ * Picks the best instruction set level the CPU supports, capped by the ARRAYS_ISA environment
+ * variable when it names a supported level. ARRAYS_INSTRUMENT set to anything but "0" enables
+ * the instrumented table as useInstrumentedFunctions(true) would.
+ */
+status_code useArrayFunctions() {
+    isa_level level = detectISA();
+    isa_level requested;
+    if (isaFromEnvironment(&requested) && isaSupported(requested))
+        level = requested;
+    const char* instrument = getenv("ARRAYS_INSTRUMENT");
+    if (instrument != NULL)
+        arraysInstrumented = strcmp(instrument, "0") != 0;
+    return useArrayFunctionsFor(level);
+}
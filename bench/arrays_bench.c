@@ -0,0 +1,987 @@
+/**
+ * @file arrays_bench.c
+ * @brief Benchmarks the Arrays functions across sizes and input distributions.
+ *
+ * Build and run (from the repository root):
+ *   cc -O2 -pthread -I. bench/arrays_bench.c -o arrays_bench -lm
+ *   ./arrays_bench [--min-size N] [--max-size N] [--filter TEXT] [--distribution NAME]
+ *                  [--isa LEVEL] [--min-time MS] [--json FILE]
+ *
+ * Every case reports the best time per element over repeated runs (ns/element) and the
+ * bandwidth of the bytes it reads and writes (GB/s). Only configuration slots (setAllocator,
+ * setParallelGrain, detectISA), O(1) bookkeeping (handleInvalidate, vectorClear, vectorView) and
+ * the printing search are left out. Rows named "baseline:..." time the C
+ * library equivalent (qsort, bsearch, wmemchr, memcmp, memcpy, snprintf) on the same input.
+ * --json writes one record per row, for tracking regressions between commits.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "arrays_util.h"
+
+#include <limits.h>
+#include <time.h>
+#include <wchar.h>
+
+/**
+ * Copies of the input made per timed sample for small sizes, so that timer resolution and
+ * call overhead do not dominate.
+ */
+#define BENCH_BATCH_ELEMENTS 65536
+
+/**
+ * Number of keys looked up per run by the search-style cases.
+ */
+#define BENCH_LOOKUPS 4096
+
+/**
+ * Number of buckets of the histogram cases.
+ */
+#define BENCH_BUCKETS 256
+
+/**
+ * Window length of the sliding-window cases.
+ */
+#define BENCH_WINDOW 64
+
+enum {
+    BENCH_MUTATES = 1,       /* restores the working copy from the input before every run */
+    BENCH_SORTED = 2,        /* runs on a sorted copy of the input */
+    BENCH_PER_LOOKUP = 4,    /* reports time per lookup instead of per element */
+    BENCH_UNBATCHED = 8,     /* already long enough per call; never batched for small sizes */
+};
+
+struct bench_context {
+    const int* input;
+    const int* sorted;
+    int* work;
+    int* dest;
+    int* keys;
+    int* sortedKeys;
+    int* results;
+    int* permutation;
+    bool* heads;
+    char* text;
+    size_t textCapacity;
+    size_t n;
+    int64_t* wide;
+    int64_t* wideWork;
+    float* single;
+    double* real;
+    double* realWork;
+    search_index* index;
+    array_handle handle;
+    FILE* sink;
+    volatile unsigned long long value; /* sink; unsigned so that accumulating hashes wraps instead of overflowing */
+};
+
+struct bench_case {
+    const char* name;
+    int flags;
+    double bytesPerElement; /* 0 when the case's traffic does not scale with n; GB/s prints "-" */
+    void (*run)(struct bench_context* context, int* work);
+};
+
+static int bench_compare(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_copyOfRange(struct bench_context* c, int* work) {
+    (void)work;
+    Arrays.release(Arrays.copyOfRange(c->input, 0, (int)c->n));
+}
+
+static void bench_copyOfRangeInto(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.copyOfRangeInto(c->input, 0, (int)c->n, c->dest, (int)c->n);
+}
+
+static void bench_memcpy(struct bench_context* c, int* work) {
+    (void)work;
+    memcpy(c->dest, c->input, c->n * sizeof(int));
+}
+
+static void bench_rotate(struct bench_context* c, int* work) {
+    Arrays.rotate(work, (int)c->n, (int)(c->n / 3));
+}
+
+static void bench_rotateLeft(struct bench_context* c, int* work) {
+    Arrays.rotateLeft(work, (int)c->n, 7);
+}
+
+static void bench_searchLIN(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.searchLIN(c->input, (int)c->n, c->input[c->n - 1]);
+}
+
+static void bench_wmemchr(struct bench_context* c, int* work) {
+    (void)work;
+    const wchar_t* found = wmemchr((const wchar_t*)c->input, (wchar_t)c->input[c->n - 1], c->n);
+    c->value += found ? found - (const wchar_t*)c->input : -1;
+}
+
+static void bench_indexOf(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.indexOf((int*)c->input, (int)c->n, c->input[c->n - 1]);
+}
+
+static void bench_count(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.count(c->input, (int)c->n, c->input[0]);
+}
+
+static void bench_searchAll(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.searchAll(c->input, (int)c->n, c->input[0], c->results, BENCH_LOOKUPS);
+}
+
+static void bench_searchBIN(struct bench_context* c, int* work) {
+    (void)work;
+    for (int i = 0; i < BENCH_LOOKUPS; ++i)
+        c->value += Arrays.searchBIN(c->sorted, (int)c->n, c->keys[i]);
+}
+
+static void bench_bsearch(struct bench_context* c, int* work) {
+    (void)work;
+    for (int i = 0; i < BENCH_LOOKUPS; ++i)
+        c->value += bsearch(&c->keys[i], c->sorted, c->n, sizeof(int), bench_compare) != NULL;
+}
+
+static void bench_searchBINBatch(struct bench_context* c, int* work) {
+    (void)work;
+    Arrays.searchBINBatch(c->sorted, (int)c->n, c->keys, BENCH_LOOKUPS, c->results);
+}
+
+static void bench_handleSet(struct bench_context* c, int* work) {
+    (void)work;
+    array_handle* h = &c->handle;
+    for (int i = 0; i < BENCH_LOOKUPS; ++i) {
+        int at = (int)(((size_t)i * 2654435761u) % c->n);
+        Arrays.handleSet(h, at, c->keys[i]);
+        c->value += Arrays.handleIsSorted(h) + Arrays.handleMin(h) + Arrays.handleMax(h) + (long long)Arrays.handleHashCode(h);
+    }
+}
+
+static void bench_vectorAppend(struct bench_context* c, int* work) {
+    (void)work;
+    array_vector v;
+    Arrays.vectorInit(&v);
+    for (size_t i = 0; i < c->n; ++i)
+        Arrays.vectorAppend(&v, c->input[i]);
+    c->value += v.data[v.size - 1];
+    Arrays.vectorFree(&v);
+}
+
+static void bench_vectorAppendN(struct bench_context* c, int* work) {
+    (void)work;
+    array_vector v;
+    Arrays.vectorInit(&v);
+    for (size_t i = 0; i < c->n; i += BENCH_WINDOW)
+        Arrays.vectorAppendN(&v, c->input + i, (int)(c->n - i < BENCH_WINDOW ? c->n - i : BENCH_WINDOW));
+    c->value += v.data[v.size - 1];
+    Arrays.vectorFree(&v);
+}
+
+static void bench_vectorResize(struct bench_context* c, int* work) {
+    (void)work;
+    array_vector v;
+    Arrays.vectorInit(&v);
+    Arrays.vectorReserve(&v, (int)c->n);
+    Arrays.vectorResize(&v, (int)c->n);
+    Arrays.vectorResize(&v, (int)(c->n / 2));
+    Arrays.vectorShrink(&v);
+    c->value += v.capacity;
+    Arrays.vectorFree(&v);
+}
+
+static void bench_smallVectorAppend(struct bench_context* c, int* work) {
+    (void)work;
+    array_small_vector small;
+    for (size_t i = 0; i < c->n; i += ARRAYS_SMALL_VECTOR) {
+        Arrays.smallVectorInit(&small);
+        for (size_t j = i; j < c->n && j < i + ARRAYS_SMALL_VECTOR; ++j)
+            Arrays.vectorAppend(&small.vector, c->input[j]);
+        c->value += Arrays.sum(small.vector.data, small.vector.size);
+        Arrays.vectorFree(&small.vector);
+    }
+}
+
+static void bench_handleAppend(struct bench_context* c, int* work) {
+    (void)work;
+    array_handle h;
+    Arrays.handleInit(&h, NULL, 0);
+    for (size_t i = 0; i < c->n; i += BENCH_WINDOW) {
+        Arrays.handleAppend(&h, c->input[i]);
+        Arrays.handleWrite(&h, h.size - 1, c->input + i, (int)(c->n - i < BENCH_WINDOW ? c->n - i : BENCH_WINDOW));
+    }
+    c->value += Arrays.handleIsSorted(&h) + (long long)Arrays.handleHashCode(&h);
+    Arrays.handleFree(&h);
+}
+
+static void bench_handleSort(struct bench_context* c, int* work) {
+    array_handle h;
+    Arrays.handleInit(&h, work, (int)c->n);
+    Arrays.handleSort(&h);
+    for (int i = 0; i < BENCH_LOOKUPS && i < (int)c->n; ++i)
+        c->value += Arrays.handleSearch(&h, c->keys[i]);
+    Arrays.handleFree(&h);
+}
+
+static void bench_buildIndex(struct bench_context* c, int* work) {
+    (void)work;
+    Arrays.freeIndex(Arrays.buildIndex(c->sorted, (int)c->n));
+}
+
+static void bench_lowerBound(struct bench_context* c, int* work) {
+    (void)work;
+    for (int i = 0; i < BENCH_LOOKUPS; ++i)
+        c->value += Arrays.lowerBound(c->index, c->keys[i]);
+}
+
+static void bench_find(struct bench_context* c, int* work) {
+    (void)work;
+    for (int i = 0; i < BENCH_LOOKUPS; ++i)
+        c->value += Arrays.find(c->index, c->keys[i]);
+}
+
+static void bench_reverse(struct bench_context* c, int* work) {
+    Arrays.reverse(work, (int)c->n);
+}
+
+static void bench_maxValue(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.maxValue(c->input, (int)c->n);
+}
+
+static void bench_minValue(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.minValue(c->input, (int)c->n);
+}
+
+static void bench_minMax(struct bench_context* c, int* work) {
+    (void)work;
+    int minimum, maximum;
+    Arrays.minMax(c->input, (int)c->n, &minimum, &maximum);
+    c->value += minimum + maximum;
+}
+
+static void bench_getMaxOccurrence(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.getMaxOccurrence(c->input, (int)c->n);
+}
+
+static void bench_mode(struct bench_context* c, int* work) {
+    (void)work;
+    int count;
+    c->value += Arrays.mode(c->input, (int)c->n, &count) + count;
+}
+
+static void bench_countDistinct(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.countDistinct(c->input, (int)c->n);
+}
+
+static void bench_histogram(struct bench_context* c, int* work) {
+    (void)work;
+    static int counts[BENCH_BUCKETS];
+    c->value += Arrays.histogram(c->input, (int)c->n, INT_MIN, INT_MAX, BENCH_BUCKETS, counts) + counts[0];
+}
+
+static void bench_toString(struct bench_context* c, int* work) {
+    (void)work;
+    Arrays.release(Arrays.toString(c->input, (int)c->n));
+}
+
+static void bench_stringLength(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += (long long)Arrays.stringLength(c->input, (int)c->n);
+}
+
+static void bench_toStringInto(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += (long long)Arrays.toStringInto(c->input, (int)c->n, c->text, c->textCapacity);
+}
+
+static void bench_snprintf(struct bench_context* c, int* work) {
+    (void)work;
+    size_t used = 0;
+    for (size_t i = 0; i < c->n && used < c->textCapacity; ++i)
+        used += (size_t)snprintf(c->text + used, c->textCapacity - used, i ? ", %d" : "[%d", c->input[i]);
+    c->value += (long long)used;
+}
+
+static void bench_writeTo(struct bench_context* c, int* work) {
+    (void)work;
+    Arrays.writeTo(c->input, (int)c->n, c->sink);
+}
+
+static void bench_sort(struct bench_context* c, int* work) {
+    Arrays.sort(work, 0, (int)c->n - 1);
+}
+
+static void bench_qsort(struct bench_context* c, int* work) {
+    qsort(work, c->n, sizeof(int), bench_compare);
+}
+
+static void bench_radixSort(struct bench_context* c, int* work) {
+    Arrays.radixSort(work, 0, (int)c->n - 1, c->dest);
+}
+
+static void bench_select(struct bench_context* c, int* work) {
+    c->value += Arrays.select(work, (int)c->n, (int)((c->n - 1) * 99 / 100));
+}
+
+static void bench_partialSort(struct bench_context* c, int* work) {
+    Arrays.partialSort(work, (int)c->n, 100);
+}
+
+static void bench_topK(struct bench_context* c, int* work) {
+    (void)work;
+    int heap[100];
+    array_top_k state;
+    Arrays.topKInit(&state, heap, 100, true);
+    Arrays.topKUpdate(&state, c->input, c->n);
+    c->value += Arrays.topKResult(&state, c->results);
+}
+
+static void bench_argsort(struct bench_context* c, int* work) {
+    (void)work;
+    Arrays.argsort(c->input, (int)c->n, c->dest);
+}
+
+static void bench_stableSort(struct bench_context* c, int* work) {
+    Arrays.stableSort(work, (int)c->n, c->dest);
+}
+
+static void bench_applyPermutation(struct bench_context* c, int* work) {
+    Arrays.applyPermutation(c->input, c->permutation, (int)c->n, work);
+}
+
+static void bench_parallelSort(struct bench_context* c, int* work) {
+    Arrays.parallelSort(work, 0, (int)c->n - 1, 0);
+}
+
+static void bench_parallelSum(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.parallelSum(c->input, c->n, 0);
+}
+
+static void bench_parallelMinMax(struct bench_context* c, int* work) {
+    (void)work;
+    int minimum, maximum;
+    Arrays.parallelMinMax(c->input, c->n, &minimum, &maximum, 0);
+    c->value += minimum + maximum;
+}
+
+static void bench_parallelCount(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += (long long)Arrays.parallelCount(c->input, c->n, c->input[0], 0);
+}
+
+static void bench_parallelPrefixSum(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.parallelPrefixSum(c->input, c->n, (long long*)c->dest, 0);
+}
+
+static void bench_parallelHistogram(struct bench_context* c, int* work) {
+    (void)work;
+    static size_t counts[BENCH_BUCKETS];
+    c->value += (long long)Arrays.parallelHistogram(c->input, c->n, INT_MIN, INT_MAX, BENCH_BUCKETS, counts, 0);
+}
+
+static void bench_parallelHash(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += (long long)Arrays.parallelHash(c->input, c->n, 0, 0);
+}
+
+static void bench_parallelReverse(struct bench_context* c, int* work) {
+    Arrays.parallelReverse(work, c->n, 0);
+}
+
+static void bench_parallelCopy(struct bench_context* c, int* work) {
+    (void)work;
+    Arrays.parallelCopy(c->dest, c->input, c->n, 0);
+}
+
+static void bench_compare_equal(struct bench_context* c, int* work) {
+    c->value += Arrays.compare((int*)c->input, (int)c->n, work, (int)c->n);
+}
+
+static void bench_memcmp(struct bench_context* c, int* work) {
+    c->value += memcmp(c->input, work, c->n * sizeof(int));
+}
+
+static void bench_mismatch(struct bench_context* c, int* work) {
+    c->value += Arrays.mismatch(c->input, (int)c->n, work, (int)c->n);
+}
+
+static void bench_compareOrder(struct bench_context* c, int* work) {
+    c->value += Arrays.compareOrder(c->input, (int)c->n, work, (int)c->n);
+}
+
+static void bench_mergeSorted(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.mergeSorted(c->sorted, (int)c->n, c->sorted + 1, (int)c->n - 1, c->dest, (int)(2 * c->n));
+}
+
+static void bench_unionSorted(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.unionSorted(c->sorted, (int)c->n, c->sorted + 1, (int)c->n - 1, c->dest, (int)(2 * c->n));
+}
+
+static void bench_intersectSorted(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.intersectSorted(c->sorted, (int)c->n, c->sorted + 1, (int)c->n - 1, c->dest, (int)c->n);
+}
+
+static void bench_intersectSortedGalloping(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.intersectSorted(c->sortedKeys, BENCH_LOOKUPS, c->sorted, (int)c->n, c->dest, BENCH_LOOKUPS);
+}
+
+static void bench_differenceSorted(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.differenceSorted(c->sorted, (int)c->n, c->sorted + 1, (int)c->n - 1, c->dest, (int)c->n);
+}
+
+static void bench_sum(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.sum((int*)c->input, (int)c->n);
+}
+
+static void bench_prefixSum(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.prefixSum(c->input, (int)c->n, (long long*)c->dest);
+}
+
+static void bench_exclusivePrefixSum(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.exclusivePrefixSum(c->input, (int)c->n, (long long*)c->dest);
+}
+
+static void bench_segmentedPrefixSum(struct bench_context* c, int* work) {
+    (void)work;
+    Arrays.segmentedPrefixSum(c->input, c->heads, (int)c->n, (long long*)c->dest);
+}
+
+static void bench_windowSum(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.windowSum(c->input, (int)c->n, BENCH_WINDOW, (long long*)c->dest);
+}
+
+static void bench_windowMin(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.windowMin(c->input, (int)c->n, BENCH_WINDOW, c->dest);
+}
+
+static void bench_windowMax(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.windowMax(c->input, (int)c->n, BENCH_WINDOW, c->dest);
+}
+
+static void bench_viewSum(struct bench_context* c, int* work) {
+    (void)work;
+    array_view all = Arrays.view(c->input, (int)c->n);
+    array_view range, rotated;
+    Arrays.viewRange(&all, 1, (int)c->n, &range);
+    Arrays.viewRotate(&range, (int)c->n / 3, &rotated);
+    c->value += Arrays.viewSum(&rotated);
+}
+
+static bool benchIsEven(int value, void* context) {
+    (void)context;
+    return (value & 1) == 0;
+}
+
+static int benchHalve(int value, void* context) {
+    (void)context;
+    return value >> 1;
+}
+
+static void bench_pipelineSum(struct bench_context* c, int* work) {
+    (void)work;
+    array_view all = Arrays.view(c->input, (int)c->n);
+    array_view reversed = Arrays.viewReverse(&all);
+    array_pipeline pipeline;
+    Arrays.pipelineInit(&pipeline, &reversed);
+    Arrays.pipelineFilter(&pipeline, benchIsEven, NULL);
+    Arrays.pipelineMap(&pipeline, benchHalve, NULL);
+    c->value += Arrays.pipelineSum(&pipeline);
+}
+
+static void bench_pipelineCount(struct bench_context* c, int* work) {
+    (void)work;
+    array_view all = Arrays.view(c->input, (int)c->n);
+    array_pipeline pipeline;
+    Arrays.pipelineInit(&pipeline, &all);
+    Arrays.pipelineFilter(&pipeline, benchIsEven, NULL);
+    c->value += Arrays.pipelineCount(&pipeline);
+}
+
+static void bench_pipelineCollect(struct bench_context* c, int* work) {
+    (void)work;
+    array_view all = Arrays.view(c->input, (int)c->n);
+    array_pipeline pipeline;
+    Arrays.pipelineInit(&pipeline, &all);
+    Arrays.pipelineFilter(&pipeline, benchIsEven, NULL);
+    c->value += Arrays.pipelineCollect(&pipeline, c->dest, (int)c->n);
+}
+
+static long long benchXor(long long acc, int value, void* context) {
+    (void)context;
+    return acc ^ value;
+}
+
+static void bench_pipelineReduce(struct bench_context* c, int* work) {
+    (void)work;
+    array_view all = Arrays.view(c->input, (int)c->n);
+    array_pipeline pipeline;
+    Arrays.pipelineInit(&pipeline, &all);
+    c->value += Arrays.pipelineReduce(&pipeline, 0, benchXor, NULL);
+}
+
+static void bench_viewCopy(struct bench_context* c, int* work) {
+    (void)work;
+    array_view strided = Arrays.stridedView(c->input, (int)(c->n / 2), 2);
+    c->value += Arrays.viewCopy(&strided, c->dest) + Arrays.viewGet(&strided, strided.length - 1);
+}
+
+static void bench_isSorted(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.isSorted((int*)c->sorted, (int)c->n);
+}
+
+static void bench_concat(struct bench_context* c, int* work) {
+    (void)work;
+    Arrays.release(Arrays.concat((int*)c->input, (int)(c->n / 2), (int*)c->input + c->n / 2, (int)(c->n - c->n / 2)));
+}
+
+static void bench_concatInto(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays.concatInto(c->input, (int)(c->n / 2), c->input + c->n / 2, (int)(c->n - c->n / 2), c->dest, (int)c->n);
+}
+
+static void bench_concatN(struct bench_context* c, int* work) {
+    (void)work;
+    const int* arrays[4];
+    int sizes[4];
+    for (int i = 0; i < 4; ++i) {
+        arrays[i] = c->input + c->n / 4 * i;
+        sizes[i] = (int)(i == 3 ? c->n - c->n / 4 * 3 : c->n / 4);
+    }
+    c->value += Arrays.concatN(arrays, sizes, 4, c->dest, (int)c->n);
+}
+
+static void bench_hashCode(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += (long long)Arrays.hashCode((int*)c->input, (int)c->n);
+}
+
+static void bench_fastHash(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += (long long)Arrays.fastHash(c->input, c->n, 0);
+}
+
+static void bench_hashStream(struct bench_context* c, int* work) {
+    (void)work;
+    array_hash_state state;
+    Arrays.hashInit(&state, 0);
+    for (size_t low = 0; low < c->n; low += 1000)
+        Arrays.hashUpdate(&state, c->input + low, c->n - low < 1000 ? c->n - low : 1000);
+    c->value += (long long)Arrays.hashFinal(&state);
+}
+
+static void bench_writeFile(struct bench_context* c, int* work) {
+    (void)work;
+    Arrays.writeFile("arrays_bench.arr", c->input, c->n);
+}
+
+static void bench_mapFile(struct bench_context* c, int* work) {
+    (void)work;
+    array_file file;
+    if (Arrays.mapFile("arrays_bench.arr", &file, ARRAY_MAP_READ) == SUCCESS) {
+        c->value += Arrays.searchBIN(file.data, (int)file.count, c->keys[0]);
+        Arrays.unmapFile(&file);
+    }
+}
+
+static void bench_syncFile(struct bench_context* c, int* work) {
+    (void)work;
+    array_file file;
+    if (Arrays.mapFile("arrays_bench.arr", &file, ARRAY_MAP_SHARED) == SUCCESS) {
+        c->value += Arrays.syncFile(&file);
+        Arrays.unmapFile(&file);
+    }
+}
+
+static void bench_externalSort(struct bench_context* c, int* work) {
+    (void)work;
+    /* a budget of half the input: four runs once n / 4 exceeds ARRAYS_MERGE_BUFFER */
+    c->value += Arrays.externalSort("arrays_bench.in.arr", "arrays_bench.out.arr", c->n * sizeof(int) / 2);
+}
+
+static void bench_sum64(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays64.sum(c->input, c->n);
+}
+
+static void bench_sort64(struct bench_context* c, int* work) {
+    Arrays64.sort(work, 0, (ptrdiff_t)c->n - 1);
+}
+
+/* The typed sorts copy their input inside the timed call, so they include one extra pass. */
+static void bench_sortI64(struct bench_context* c, int* work) {
+    (void)work;
+    memcpy(c->wideWork, c->wide, c->n * sizeof(int64_t));
+    Arrays_i64.sort(c->wideWork, 0, (int)c->n - 1);
+}
+
+static void bench_sumI64(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays_i64.sum(c->wide, (int)c->n);
+}
+
+static void bench_countU32(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += Arrays_u32.count((const uint32_t*)c->input, (int)c->n, (uint32_t)c->keys[0]);
+}
+
+static void bench_sumF32(struct bench_context* c, int* work) {
+    (void)work;
+    c->value += (long long)Arrays_f32.sum(c->single, (int)c->n);
+}
+
+static void bench_sortF64(struct bench_context* c, int* work) {
+    (void)work;
+    memcpy(c->realWork, c->real, c->n * sizeof(double));
+    Arrays_f64.sort(c->realWork, 0, (int)c->n - 1);
+}
+
+static void bench_minMaxF64(struct bench_context* c, int* work) {
+    (void)work;
+    double low, high;
+    Arrays_f64.minMax(c->real, (int)c->n, &low, &high);
+    c->value += (long long)(high - low);
+}
+
+static const struct bench_case benchCases[] = {
+    {"copyOfRange", 0, 8, bench_copyOfRange},
+    {"copyOfRangeInto", 0, 8, bench_copyOfRangeInto},
+    {"baseline:memcpy", 0, 8, bench_memcpy},
+    {"rotate", BENCH_MUTATES, 8, bench_rotate},
+    {"rotateLeft", BENCH_MUTATES, 8, bench_rotateLeft},
+    {"searchLIN", 0, 4, bench_searchLIN},
+    {"baseline:wmemchr", 0, 4, bench_wmemchr},
+    {"indexOf", 0, 4, bench_indexOf},
+    {"count", 0, 4, bench_count},
+    {"searchAll", 0, 4, bench_searchAll},
+    {"searchBIN", BENCH_SORTED | BENCH_PER_LOOKUP | BENCH_UNBATCHED, 4, bench_searchBIN},
+    {"baseline:bsearch", BENCH_SORTED | BENCH_PER_LOOKUP | BENCH_UNBATCHED, 4, bench_bsearch},
+    {"searchBINBatch", BENCH_SORTED | BENCH_PER_LOOKUP | BENCH_UNBATCHED, 4, bench_searchBINBatch},
+    {"handleSet/handleHashCode", BENCH_PER_LOOKUP | BENCH_UNBATCHED, 4, bench_handleSet},
+    {"handleAppend/handleWrite", 0, 8, bench_handleAppend},
+    {"handleSort/handleSearch", BENCH_MUTATES, 12, bench_handleSort},
+    {"vectorAppend", 0, 4, bench_vectorAppend},
+    {"vectorAppendN", 0, 4, bench_vectorAppendN},
+    {"vectorReserve/Resize/Shrink", 0, 8, bench_vectorResize},
+    {"smallVectorAppend/sum", 0, 4, bench_smallVectorAppend},
+    {"buildIndex", BENCH_SORTED, 12, bench_buildIndex},
+    {"lowerBound", BENCH_SORTED | BENCH_PER_LOOKUP | BENCH_UNBATCHED, 4, bench_lowerBound},
+    {"find", BENCH_SORTED | BENCH_PER_LOOKUP | BENCH_UNBATCHED, 4, bench_find},
+    {"reverse", BENCH_MUTATES, 8, bench_reverse},
+    {"maxValue", 0, 4, bench_maxValue},
+    {"minValue", 0, 4, bench_minValue},
+    {"minMax", 0, 4, bench_minMax},
+    {"getMaxOccurrence", 0, 4, bench_getMaxOccurrence},
+    {"mode", 0, 4, bench_mode},
+    {"countDistinct", 0, 4, bench_countDistinct},
+    {"histogram", 0, 4, bench_histogram},
+    {"toString", 0, 4, bench_toString},
+    {"stringLength", 0, 4, bench_stringLength},
+    {"toStringInto", 0, 4, bench_toStringInto},
+    {"baseline:snprintf", 0, 4, bench_snprintf},
+    {"writeTo", 0, 4, bench_writeTo},
+    {"sort", BENCH_MUTATES, 8, bench_sort},
+    {"baseline:qsort", BENCH_MUTATES, 8, bench_qsort},
+    {"radixSort", BENCH_MUTATES, 8, bench_radixSort},
+    {"select", BENCH_MUTATES, 8, bench_select},
+    {"partialSort", BENCH_MUTATES, 8, bench_partialSort},
+    {"topKInit/topKUpdate/topKResult", 0, 4, bench_topK},
+    {"argsort", 0, 8, bench_argsort},
+    {"stableSort", BENCH_MUTATES, 16, bench_stableSort},
+    {"applyPermutation", 0, 12, bench_applyPermutation},
+    {"parallelSort", BENCH_MUTATES, 8, bench_parallelSort},
+    {"parallelSum", 0, 4, bench_parallelSum},
+    {"parallelPrefixSum", 0, 12, bench_parallelPrefixSum},
+    {"parallelMinMax", 0, 4, bench_parallelMinMax},
+    {"parallelCount", 0, 4, bench_parallelCount},
+    {"parallelHistogram", 0, 4, bench_parallelHistogram},
+    {"parallelHash", 0, 4, bench_parallelHash},
+    {"parallelReverse", BENCH_MUTATES, 8, bench_parallelReverse},
+    {"parallelCopy", 0, 8, bench_parallelCopy},
+    {"compare", BENCH_MUTATES, 8, bench_compare_equal},
+    {"baseline:memcmp", BENCH_MUTATES, 8, bench_memcmp},
+    {"mismatch", BENCH_MUTATES, 8, bench_mismatch},
+    {"compareOrder", BENCH_MUTATES, 8, bench_compareOrder},
+    {"mergeSorted", BENCH_SORTED, 16, bench_mergeSorted},
+    {"unionSorted", BENCH_SORTED, 12, bench_unionSorted},
+    {"intersectSorted", BENCH_SORTED, 12, bench_intersectSorted},
+    {"intersectSorted:galloping", BENCH_SORTED | BENCH_PER_LOOKUP | BENCH_UNBATCHED, 4, bench_intersectSortedGalloping},
+    {"differenceSorted", BENCH_SORTED, 12, bench_differenceSorted},
+    {"sum", 0, 4, bench_sum},
+    {"prefixSum", 0, 12, bench_prefixSum},
+    {"exclusivePrefixSum", 0, 12, bench_exclusivePrefixSum},
+    {"segmentedPrefixSum", 0, 13, bench_segmentedPrefixSum},
+    {"windowSum", 0, 12, bench_windowSum},
+    {"windowMin", 0, 8, bench_windowMin},
+    {"windowMax", 0, 8, bench_windowMax},
+    {"viewRange/viewRotate/viewSum", 0, 4, bench_viewSum},
+    {"pipelineMap/pipelineSum", 0, 4, bench_pipelineSum},
+    {"pipelineFilter/pipelineCount", 0, 4, bench_pipelineCount},
+    {"pipelineCollect", 0, 6, bench_pipelineCollect},
+    {"pipelineReduce", 0, 4, bench_pipelineReduce},
+    {"stridedView/viewCopy/viewGet", 0, 6, bench_viewCopy},
+    {"isSorted", BENCH_SORTED, 4, bench_isSorted},
+    {"concat", 0, 8, bench_concat},
+    {"concatInto", 0, 8, bench_concatInto},
+    {"concatN", 0, 8, bench_concatN},
+    {"hashCode", 0, 4, bench_hashCode},
+    {"fastHash", 0, 4, bench_fastHash},
+    {"hashInit/hashUpdate/hashFinal", 0, 4, bench_hashStream},
+    {"writeFile", BENCH_UNBATCHED, 4, bench_writeFile},
+    {"mapFile", BENCH_UNBATCHED, 0, bench_mapFile},
+    {"syncFile", BENCH_UNBATCHED, 16, bench_syncFile},
+    {"externalSort", BENCH_UNBATCHED, 16, bench_externalSort},
+    {"Arrays64.sum", 0, 4, bench_sum64},
+    {"Arrays64.sort", BENCH_MUTATES, 8, bench_sort64},
+    {"Arrays_i64.sort", BENCH_UNBATCHED, 32, bench_sortI64},
+    {"Arrays_i64.sum", 0, 8, bench_sumI64},
+    {"Arrays_u32.count", 0, 4, bench_countU32},
+    {"Arrays_f32.sum", 0, 4, bench_sumF32},
+    {"Arrays_f64.sort", BENCH_UNBATCHED, 32, bench_sortF64},
+    {"Arrays_f64.minMax", 0, 8, bench_minMaxF64},
+};
+
+static const char* const benchDistributions[] = {
+    "random", "sorted", "reversed", "few-unique", "organ-pipe", "sawtooth",
+};
+
+static void fillDistribution(int* arr, size_t n, int distribution) {
+    unsigned long long state = 0x9E3779B97F4A7C15ull ^ n;
+    for (size_t i = 0; i < n; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        switch (distribution) {
+        case 0: arr[i] = (int)(unsigned int)state; break;
+        case 1: arr[i] = (int)i; break;
+        case 2: arr[i] = (int)(n - i); break;
+        case 3: arr[i] = (int)(state % 16); break;
+        case 4: arr[i] = (int)(i < n / 2 ? i : n - i); break;
+        default: arr[i] = (int)(i % 1024); break;
+        }
+    }
+}
+
+static double nowNanoseconds() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+/**
+ * @brief Runs one case until min-time has elapsed (at least three samples) and returns the
+ * best time of a single call in nanoseconds.
+ */
+static double timeCase(const struct bench_case* test, struct bench_context* c, size_t batch, double minTime, size_t* calls) {
+    double best = 1e300, elapsed = 0;
+    size_t samples = 0;
+    while (samples < 3 || elapsed < minTime) {
+        if (test->flags & BENCH_MUTATES) {
+            for (size_t k = 0; k < batch; ++k)
+                memcpy(c->work + k * c->n, (test->flags & BENCH_SORTED) ? c->sorted : c->input, c->n * sizeof(int));
+        }
+        double start = nowNanoseconds();
+        for (size_t k = 0; k < batch; ++k)
+            test->run(c, c->work + k * c->n);
+        double sample = nowNanoseconds() - start;
+        best = sample < best ? sample : best;
+        elapsed += sample;
+        samples++;
+    }
+    *calls = samples * batch;
+    return best / (double)batch;
+}
+
+static void usage(const char* program) {
+    fprintf(stderr, "usage: %s [--min-size N] [--max-size N] [--filter TEXT] [--distribution NAME]\n"
+                    "          [--isa scalar|sse4.2|avx2|avx512|neon] [--min-time MS] [--json FILE]\n", program);
+}
+
+int main(int argc, char** argv) {
+    size_t minSize = 16, maxSize = (size_t)1 << 22;
+    const char* filter = NULL;
+    const char* distributionFilter = NULL;
+    const char* isa = NULL;
+    const char* jsonPath = NULL;
+    double minTime = 20e6;
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "--min-size") == 0) {
+            minSize = (size_t)strtoull(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--max-size") == 0) {
+            maxSize = (size_t)strtoull(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "--filter") == 0) {
+            filter = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--distribution") == 0) {
+            distributionFilter = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--isa") == 0) {
+            isa = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--min-time") == 0) {
+            minTime = atof(argv[++i]) * 1e6;
+        } else if (i + 1 < argc && strcmp(argv[i], "--json") == 0) {
+            jsonPath = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (minSize < 16)
+        minSize = 16;
+    if (maxSize > (size_t)ARRAYS_LARGE_CHUNK)
+        maxSize = (size_t)ARRAYS_LARGE_CHUNK;
+
+    if (isa != NULL) {
+        isa_level level = ISA_SCALAR;
+        while (level <= ISA_NEON && strcmp(isaName(level), isa) != 0)
+            level = (isa_level)(level + 1);
+        if (level > ISA_NEON || useArrayFunctionsFor(level) != SUCCESS) {
+            fprintf(stderr, "ISA level %s is not available\n", isa);
+            return 2;
+        }
+    } else {
+        useArrayFunctions();
+    }
+
+    FILE* json = NULL;
+    if (jsonPath != NULL) {
+        json = fopen(jsonPath, "w");
+        if (json == NULL) {
+            fprintf(stderr, "cannot write %s\n", jsonPath);
+            return 1;
+        }
+        fprintf(json, "{\n  \"isa\": \"%s\",\n  \"results\": [", isaName(Arrays.activeISA()));
+    }
+
+    size_t workCapacity = maxSize > BENCH_BATCH_ELEMENTS ? maxSize : BENCH_BATCH_ELEMENTS;
+    struct bench_context c;
+    memset(&c, 0, sizeof(c));
+    int* input = (int*)malloc(maxSize * sizeof(int));
+    int* sorted = (int*)malloc(maxSize * sizeof(int));
+    c.work = (int*)malloc(workCapacity * sizeof(int));
+    c.dest = (int*)malloc(2 * maxSize * sizeof(int));
+    c.keys = (int*)malloc(BENCH_LOOKUPS * sizeof(int));
+    c.sortedKeys = (int*)malloc(BENCH_LOOKUPS * sizeof(int));
+    c.results = (int*)malloc(BENCH_LOOKUPS * sizeof(int));
+    c.permutation = (int*)malloc(maxSize * sizeof(int));
+    c.heads = (bool*)malloc(maxSize * sizeof(bool));
+    c.wide = (int64_t*)malloc(maxSize * sizeof(int64_t));
+    c.wideWork = (int64_t*)malloc(maxSize * sizeof(int64_t));
+    c.single = (float*)malloc(maxSize * sizeof(float));
+    c.real = (double*)malloc(maxSize * sizeof(double));
+    c.realWork = (double*)malloc(maxSize * sizeof(double));
+    c.textCapacity = maxSize * 13 + 3;
+    c.text = (char*)malloc(c.textCapacity);
+    c.sink = fopen("/dev/null", "w");
+    if (!input || !sorted || !c.work || !c.dest || !c.keys || !c.sortedKeys || !c.results || !c.permutation || !c.heads || !c.text || !c.sink
+        || !c.wide || !c.wideWork || !c.single || !c.real || !c.realWork) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    c.input = input;
+    c.sorted = sorted;
+    for (size_t i = 0; i < maxSize; ++i)
+        c.heads[i] = ((uint32_t)i * 2654435761u) >> 28 == 0;
+
+    printf("ISA: %s\n%-30s %-11s %10s %12s %9s\n", isaName(Arrays.activeISA()), "function", "input", "size", "ns/element", "GB/s");
+    bool first = true;
+    for (size_t n = minSize; n <= maxSize; n = n * 16 > maxSize && n < maxSize ? maxSize : n * 16) {
+        size_t batch = n < BENCH_BATCH_ELEMENTS ? BENCH_BATCH_ELEMENTS / n : 1;
+        c.n = n;
+        for (int d = 0; d < (int)(sizeof(benchDistributions) / sizeof(benchDistributions[0])); ++d) {
+            if (distributionFilter != NULL && strcmp(distributionFilter, benchDistributions[d]) != 0)
+                continue;
+            fillDistribution(input, n, d);
+            memcpy(sorted, input, n * sizeof(int));
+            Arrays.sort(sorted, 0, (int)n - 1);
+            for (int i = 0; i < BENCH_LOOKUPS; ++i)
+                c.keys[i] = input[((size_t)i * 2654435761u) % n] + (i & 1);
+            memcpy(c.sortedKeys, c.keys, BENCH_LOOKUPS * sizeof(int));
+            Arrays.sort(c.sortedKeys, 0, BENCH_LOOKUPS - 1);
+            c.index = Arrays.buildIndex(sorted, (int)n);
+            Arrays.argsort(input, (int)n, c.permutation);
+            Arrays.writeFile("arrays_bench.arr", sorted, n);
+            Arrays.writeFile("arrays_bench.in.arr", input, n);
+            for (size_t i = 0; i < n; ++i) {
+                c.wide[i] = (int64_t)input[i] * 65537;
+                c.single[i] = (float)input[i] * 0.25f;
+                c.real[i] = (double)input[i] * 0.25;
+            }
+            Arrays.handleInit(&c.handle, input, (int)n);
+
+            for (size_t t = 0; t < sizeof(benchCases) / sizeof(benchCases[0]); ++t) {
+                const struct bench_case* test = &benchCases[t];
+                if (filter != NULL && strstr(test->name, filter) == NULL)
+                    continue;
+                if (test->run == bench_wmemchr && sizeof(wchar_t) != sizeof(int))
+                    continue;
+                size_t calls;
+                double ns = timeCase(test, &c, (test->flags & BENCH_UNBATCHED) ? 1 : batch, minTime, &calls);
+                double elements = (test->flags & BENCH_PER_LOOKUP) ? BENCH_LOOKUPS : (double)n;
+                double nsPerElement = ns / elements;
+                double gbPerSecond = test->bytesPerElement * elements / ns;
+                char bandwidth[32] = "-", bandwidthJson[32] = "null";
+                if (test->bytesPerElement > 0) {
+                    snprintf(bandwidth, sizeof(bandwidth), "%.2f", gbPerSecond);
+                    snprintf(bandwidthJson, sizeof(bandwidthJson), "%.4f", gbPerSecond);
+                }
+                printf("%-30s %-11s %10zu %12.3f %9s\n", test->name, benchDistributions[d], n, nsPerElement, bandwidth);
+                if (json != NULL) {
+                    fprintf(json, "%s\n    {\"function\": \"%s\", \"distribution\": \"%s\", \"size\": %zu, \"ns_per_element\": %.4f, \"gb_per_s\": %s, \"calls\": %zu}",
+                            first ? "" : ",", test->name, benchDistributions[d], n, nsPerElement, bandwidthJson, calls);
+                    first = false;
+                }
+            }
+            Arrays.freeIndex(c.index);
+            c.index = NULL;
+            Arrays.handleFree(&c.handle);
+        }
+        if (n == maxSize)
+            break;
+    }
+
+    if (json != NULL) {
+        fprintf(json, "\n  ]\n}\n");
+        fclose(json);
+    }
+    remove("arrays_bench.arr");
+    remove("arrays_bench.in.arr");
+    remove("arrays_bench.out.arr");
+    fclose(c.sink);
+    Arrays.shutdownThreads();
+    free(input);
+    free(sorted);
+    free(c.work);
+    free(c.dest);
+    free(c.keys);
+    free(c.sortedKeys);
+    free(c.results);
+    free(c.permutation);
+    free(c.heads);
+    free(c.text);
+    free(c.wide);
+    free(c.wideWork);
+    free(c.single);
+    free(c.real);
+    free(c.realWork);
+    return 0;
+}